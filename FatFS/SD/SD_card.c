@@ -3,13 +3,22 @@
  * @brief Драйвер microSD карты по SPI для STM32F103
  * 
  * Поддерживает:
+ * - SD 1.x и SD 2.0 SDSC (до 2 ГБ, байтовая адресация)
  * - SDHC / SDXC (≥4 ГБ)
+ * - Ёмкость и блок стирания читаются из CSD и SD Status (ACMD13)
  * - Только SPI-режим
- * - Блочная адресация (sector = 512 байт)
+ * - Снаружи всегда номер сектора (512 байт), в байты он переводится здесь
  * 
  * Совместим с FatFS через функции:
- * - SD_ReadBlock()
- * - SD_WriteBlock()
+ * - SD_ReadBlock() / SD_ReadBlocks()
+ * - SD_WriteBlock() / SD_WriteBlocks()
+ *
+ * Фаза данных (512 байт) идёт через DMA1: канал 2 — SPI1_RX, канал 3 — SPI1_TX.
+ * Команды и ответы по-прежнему опрашиваются побайтно.
+ *
+ * Все ожидания карты ограничены временем по get_ms() (SD_*_TIMEOUT_MS),
+ * а не числом итераций. Очередь SD_QueueSubmit()/SD_QueuePoll() ведёт
+ * чтение и запись блоков по шагам, не задерживая главный цикл.
  */
 
 #include "SD_card.h"
@@ -19,29 +28,81 @@
 #include "TIMER.h"
 
 
+// -----------------------------------------------------------------------------
+// Внутренние переменные
+// -----------------------------------------------------------------------------
+static uint8_t sd_high_speed = 0;
+static uint8_t sd_retry_low = 0;         // идёт повтор на низкой скорости, потом — обратно
+
+static volatile uint8_t sd_dma_busy = 0;
+static void (*sd_dma_callback)(void) = 0;
+static const uint8_t sd_dma_ff = 0xFF;   // источник для чтения: карта ждёт 0xFF
+static uint8_t sd_dma_sink;              // приёмник для записи: ответ не нужен
+
+// Какая асинхронная операция начата (для SD_*BlockFinish)
+#define SD_ASYNC_NONE   0
+#define SD_ASYNC_READ   1
+#define SD_ASYNC_WRITE  2
+static uint8_t sd_async_op = SD_ASYNC_NONE;
+// Кто держит SD_*BlockStart между вызовами (diskcache) — отдаёт шину очереди
+static void (*sd_async_release)(void) = 0;
+
+static SD_CardInfo sd_info;
+
+// Очередь запросов и состояние текущего (голова очереди)
+typedef enum {
+    SDQ_IDLE = 0,   // команда ещё не отправлена
+    SDQ_R1,         // команда отправлена, ждём R1
+    SDQ_TOKEN,      // чтение: ждём токен данных
+    SDQ_RX,         // чтение: 512 байт идут по DMA
+    SDQ_TX,         // запись: 512 байт идут по DMA
+    SDQ_BUSY        // запись: карта программирует блок
+} sdq_state_t;
+
+// Сколько байт опрашивать за шаг, пока карта не готова
+#define SDQ_POLL_BYTES  16
+
+// BASEPRI на время шага: закрыты прерывания с FatFS и ниже
+#define SDQ_BASEPRI     (SD_FATFS_IRQ_PRIORITY << (8 - __NVIC_PRIO_BITS))
+
+static SD_Request *sdq_ring[SD_QUEUE_LEN];
+static uint8_t     sdq_head  = 0;
+static uint8_t     sdq_count = 0;
+static sdq_state_t sdq_state = SDQ_IDLE;
+static uint32_t    sdq_start;   // начало текущего ожидания, мс
+
+// Больше f_mkfs не принимает (выравнивание до 32768 секторов = 16 МБ)
+#define SD_ERASE_BLOCK_MAX  32768u
+
 // -----------------------------------------------------------------------------
 // Внутренние функции
 // -----------------------------------------------------------------------------
 
 /**
  * @brief Ждёт R1-ответ от карты (не 0xFF)
+ * CS не трогает: его держит вызывающий, он же отпускает при ошибке
  */
 uint8_t sd_wait_for_r1(uint32_t timeout_ms) {
-    volatile uint32_t timeout = timeout_ms * 1000; // ~1 мкс на итерацию при 72 МГц
+    uint32_t start = get_ms();
     uint8_t response;
-    SPI_devices[0].activate();
     do {
         response = SPI_transfer(SPI1, 0xFF);
         if (response != 0xFF) return response;
-    } while (timeout--);
-    SPI_devices[0].deactivate();
+    } while (get_ms() - start <= timeout_ms);
     return 0xFF;
 }
 
 /**
- * @brief Отправляет команду SD-карте
+ * @brief Адрес для команд чтения/записи: SDSC адресуется байтами
  */
-static uint8_t sd_send_command(uint8_t cmd, uint32_t arg, uint8_t crc) {
+static inline uint32_t sd_address(uint32_t sector) {
+    return (sd_info.type & SD_TYPE_BLOCK) ? sector : sector << 9;
+}
+
+/**
+ * @brief Кадр команды (6 байт) после паузы с CS вверху, без ожидания R1
+ */
+static void sd_command_frame(uint8_t cmd, uint32_t arg, uint8_t crc) {
     SPI_devices[0].deactivate();
     SPI_transfer(SPI1, 0xFF); // Пауза
 
@@ -53,8 +114,14 @@ static uint8_t sd_send_command(uint8_t cmd, uint32_t arg, uint8_t crc) {
     SPI_transfer(SPI1, (uint8_t)(arg >> 8));
     SPI_transfer(SPI1, (uint8_t)arg);
     SPI_transfer(SPI1, crc);
+}
 
-    return sd_wait_for_r1(100); // 100 мс таймаут
+/**
+ * @brief Отправляет команду SD-карте
+ */
+static uint8_t sd_send_command(uint8_t cmd, uint32_t arg, uint8_t crc) {
+    sd_command_frame(cmd, arg, crc);
+    return sd_wait_for_r1(SD_CMD_TIMEOUT_MS);
 }
 
 /**
@@ -67,59 +134,339 @@ static void sd_read_data(uint8_t *buf, uint8_t len) {
 }
 
 /**
- * @brief Чтение одного сектора (внутренняя реализация)
+ * @brief Запуск обмена 512 байтами через DMA (без ожидания окончания)
+ * @param rx куда принимать или NULL — принятое выбрасывается
+ * @param tx откуда передавать или NULL — передаётся 0xFF
  */
-static SD_Status sd_read_sector(uint32_t sector, uint8_t *buffer) {
-    uint8_t r1 = sd_send_command(SD_CMD17_READ_SINGLE_BLOCK, sector, 0xFF);
-    if (r1 != SD_R1_READY_STATE) {
-        SPI_devices[0].deactivate();
-        return SD_ERROR;
-    }
+static void sd_dma_start(uint8_t *rx, const uint8_t *tx) {
+    SD_DMA_wait();
+    sd_dma_busy = 1;
+
+    // Хвост от побайтного опроса не должен попасть в буфер
+    (void)SPI1->DR;
+
+    // Приём: периферия -> память, окончание обмена — по нему
+    DMA1_Channel2->CCR   = 0;
+    DMA1_Channel2->CMAR  = (uint32_t)(rx ? rx : &sd_dma_sink);
+    DMA1_Channel2->CNDTR = 512;
+    DMA1_Channel2->CCR   = DMA_CCR_PL_1 |
+                           DMA_CCR_TCIE |
+                           (rx ? DMA_CCR_MINC : 0) |
+                           DMA_CCR_EN;
+
+    // Передача: память -> периферия
+    DMA1_Channel3->CCR   = 0;
+    DMA1_Channel3->CMAR  = (uint32_t)(tx ? tx : &sd_dma_ff);
+    DMA1_Channel3->CNDTR = 512;
+    DMA1_Channel3->CCR   = DMA_CCR_DIR |
+                           DMA_CCR_PL_1 |
+                           (tx ? DMA_CCR_MINC : 0) |
+                           DMA_CCR_EN;
+
+    // RX включается раньше TX, иначе первый байт можно потерять
+    SPI1->CR2 |= SPI_CR2_RXDMAEN;
+    SPI1->CR2 |= SPI_CR2_TXDMAEN;
+}
 
-    // Ждём токен данных 0xFE
-    uint32_t timeout = 0xFFFF;
+/**
+ * @brief Ожидание токена данных 0xFE
+ * CS должен быть уже активен
+ */
+static SD_Status sd_wait_data_token(void) {
+    uint32_t start = get_ms();
     uint8_t token;
     do {
         token = SPI_transfer(SPI1, 0xFF);
         if (token != 0xFF) break;
-    } while (timeout--);
+    } while (get_ms() - start <= SD_READ_TIMEOUT_MS);
+
+    return (token == SD_TOKEN_SINGLE_READ) ? SD_OK : SD_ERROR;
+}
 
-    if (token != SD_TOKEN_SINGLE_READ) {
+/**
+ * @brief Ожидание токена данных и запуск приёма блока через DMA
+ * CS должен быть уже активен
+ */
+static SD_Status sd_receive_start(uint8_t *buffer) {
+    if (sd_wait_data_token() != SD_OK) {
+        return SD_ERROR;
+    }
+
+    // 512 байт уходят в DMA
+    sd_dma_start(buffer, NULL);
+    return SD_OK;
+}
+
+/**
+ * @brief Окончание приёма блока: ждём DMA, пропускаем CRC (2 байта)
+ */
+static SD_Status sd_receive_finish(void) {
+    SD_DMA_wait();
+    SPI_transfer(SPI1, 0xFF);
+    SPI_transfer(SPI1, 0xFF);
+    return SD_OK;
+}
+
+/**
+ * @brief Приём одного блока данных: токен, 512 байт, CRC
+ * CS должен быть уже активен
+ */
+static SD_Status sd_receive_block(uint8_t *buffer) {
+    SD_Status status = sd_receive_start(buffer);
+    if (status != SD_OK) return status;
+    return sd_receive_finish();
+}
+
+/**
+ * @brief Приём короткого блока данных побайтно (CSD, CID, SD Status)
+ * CS должен быть уже активен, после приёма отпускается
+ * @param buf куда положить первые len байт
+ * @param size длина блока, остаток после len выбрасывается
+ */
+static SD_Status sd_receive_register(uint8_t *buf, uint8_t len, uint8_t size) {
+    SD_Status status = sd_wait_data_token();
+    if (status == SD_OK) {
+        for (uint8_t i = 0; i < size; i++) {
+            uint8_t data = SPI_transfer(SPI1, 0xFF);
+            if (i < len) buf[i] = data;
+        }
+        // CRC
+        SPI_transfer(SPI1, 0xFF);
+        SPI_transfer(SPI1, 0xFF);
+    }
+    SPI_devices[0].deactivate();
+    return status;
+}
+
+/**
+ * @brief Чтение 16-байтного регистра: CMD9 (CSD) или CMD10 (CID)
+ */
+static SD_Status sd_read_register(uint8_t cmd, uint8_t *buf) {
+    uint8_t r1 = sd_send_command(cmd, 0, 0xFF);
+    if (r1 != SD_R1_READY_STATE) {
         SPI_devices[0].deactivate();
         return SD_ERROR;
     }
+    return sd_receive_register(buf, 16, 16);
+}
 
-    // Читаем 512 байт
-    for (int i = 0; i < 512; i++) {
-        buffer[i] = SPI_transfer(SPI1, 0xFF);
+/**
+ * @brief Ёмкость карты по CSD
+ * @return число секторов по 512 байт, 0 — структура CSD неизвестна
+ */
+static uint32_t sd_csd_sectors(const uint8_t *csd) {
+    switch (csd[0] >> 6) {
+        case 0: {
+            // CSD 1.0 (SDSC): (C_SIZE + 1) * 2^(C_SIZE_MULT + 2) блоков по 2^READ_BL_LEN
+            uint8_t  read_bl_len = csd[5] & 0x0F;
+            uint32_t c_size      = ((uint32_t)(csd[6] & 0x03) << 10) | ((uint32_t)csd[7] << 2) | (csd[8] >> 6);
+            uint8_t  c_size_mult = ((csd[9] & 0x03) << 1) | (csd[10] >> 7);
+            if (read_bl_len < 9) return 0;
+            return (c_size + 1) << (c_size_mult + 2 + read_bl_len - 9);
+        }
+        case 1: {
+            // CSD 2.0 (SDHC/SDXC): (C_SIZE + 1) * 512 КБ
+            uint32_t c_size = ((uint32_t)(csd[7] & 0x3F) << 16) | ((uint32_t)csd[8] << 8) | csd[9];
+            return (c_size + 1) << 10;
+        }
     }
+    return 0;
+}
 
-    // Пропускаем CRC (2 байта)
-    SPI_transfer(SPI1, 0xFF);
+/**
+ * @brief Наибольший делитель-степень двойки, не больше SD_ERASE_BLOCK_MAX
+ * (f_mkfs выравнивает только по степени двойки)
+ */
+static uint32_t sd_erase_align(uint32_t sectors) {
+    sectors &= 0u - sectors;
+    return (sectors > SD_ERASE_BLOCK_MAX) ? SD_ERASE_BLOCK_MAX : sectors;
+}
+
+/**
+ * @brief Блок стирания по CSD: (SECTOR_SIZE + 1) блоков записи
+ * Для SDHC/SDXC поле фиксировано (64 КБ) и реальный блок не отражает
+ */
+static uint32_t sd_csd_erase_block(const uint8_t *csd) {
+    uint8_t  write_bl_len = ((csd[12] & 0x03) << 2) | (csd[13] >> 6);
+    uint32_t sector_size  = ((uint32_t)(csd[10] & 0x3F) << 1) | (csd[11] >> 7);
+    if (write_bl_len < 9) return 1;
+    return sd_erase_align((sector_size + 1) << (write_bl_len - 9));
+}
+
+/**
+ * @brief Размер AU из SD Status (ACMD13) — по нему карта стирает и пишет
+ * @return AU в секторах, 0 — карта его не сообщила
+ */
+static uint32_t sd_status_au(void) {
+    // AU_SIZE 0xB..0xF: 12, 16, 24, 32, 64 МБ
+    static const uint8_t au_mb[] = {12, 16, 24, 32, 64};
+    uint8_t status[16];
+
+    uint8_t r1 = sd_send_command(SD_CMD55_APP_CMD, 0, 0xFF);
+    if (r1 <= SD_R1_IDLE_STATE) r1 = sd_send_command(SD_ACMD13_SD_STATUS, 0, 0xFF);
+    if (r1 != SD_R1_READY_STATE) {
+        SPI_devices[0].deactivate();
+        return 0;
+    }
+
+    // Ответ R2: за R1 идёт второй байт состояния, потом блок 64 байта
     SPI_transfer(SPI1, 0xFF);
+    if (sd_receive_register(status, sizeof(status), 64) != SD_OK) return 0;
+
+    uint8_t au = status[10] >> 4;
+    if (au == 0) return 0;
+    if (au <= 0x0A) return 32u << (au - 1);          // 16 КБ .. 8 МБ
+    return (uint32_t)au_mb[au - 0x0B] * 2048u;
+}
+
+/**
+ * @brief Чтение OCR, CSD, CID и расчёт геометрии карты
+ */
+static SD_Status sd_read_card_info(void) {
+    uint8_t ocr[4];
 
+    // CMD58: R3 — R1 и 4 байта OCR
+    uint8_t r1 = sd_send_command(SD_CMD58_READ_OCR, 0, 0xFF);
+    if (r1 != SD_R1_READY_STATE) {
+        SPI_devices[0].deactivate();
+        return SD_ERROR;
+    }
+    sd_read_data(ocr, 4);
     SPI_devices[0].deactivate();
+
+    sd_info.ocr = ((uint32_t)ocr[0] << 24) | ((uint32_t)ocr[1] << 16) | ((uint32_t)ocr[2] << 8) | ocr[3];
+    // CCS действителен только у SD 2.0 после ACMD41 с HCS
+    if ((sd_info.type & SD_TYPE_SD2) && (sd_info.ocr & SD_OCR_CCS)) sd_info.type |= SD_TYPE_BLOCK;
+
+    if (sd_read_register(SD_CMD9_SEND_CSD, sd_info.csd) != SD_OK) return SD_ERROR;
+    if (sd_read_register(SD_CMD10_SEND_CID, sd_info.cid) != SD_OK) return SD_ERROR;
+
+    sd_info.sectors = sd_csd_sectors(sd_info.csd);
+    if (sd_info.sectors == 0) return SD_ERROR;
+
+    uint32_t au = sd_status_au();
+    sd_info.erase_block = au ? sd_erase_align(au) : sd_csd_erase_block(sd_info.csd);
     return SD_OK;
 }
 
 /**
- * @brief Запись одного сектора (внутренняя реализация)
+ * @brief Остановка многоблочного чтения (CMD12)
+ * В отличие от sd_send_command() CS не отпускается: карта ещё шлёт данные
  */
-static SD_Status sd_write_sector(uint32_t sector, const uint8_t *buffer) {
-    uint8_t r1 = sd_send_command(SD_CMD24_WRITE_SINGLE_BLOCK, sector, 0xFF);
+static SD_Status sd_stop_transmission(void) {
+    SPI_transfer(SPI1, 0x40 | SD_CMD12_STOP_TRANSMISSION);
+    SPI_transfer(SPI1, 0x00);
+    SPI_transfer(SPI1, 0x00);
+    SPI_transfer(SPI1, 0x00);
+    SPI_transfer(SPI1, 0x00);
+    SPI_transfer(SPI1, 0xFF);
+
+    // Байт-заглушка после CMD12, затем R1 (старший бит 0).
+    // До R1 на линии ещё могут быть хвосты данных, поэтому не ждём просто "не 0xFF"
+    SPI_transfer(SPI1, 0xFF);
+    uint8_t r1;
+    uint8_t tries = 10;
+    do {
+        r1 = SPI_transfer(SPI1, 0xFF);
+    } while ((r1 & 0x80) && --tries);
+
+    // Карта может держать линию в 0, пока занята
+    uint32_t start = get_ms();
+    while (SPI_transfer(SPI1, 0xFF) == 0x00) {
+        if (get_ms() - start > SD_READ_TIMEOUT_MS) return SD_TIMEOUT_ERROR;
+    }
+
+    return (r1 == SD_R1_READY_STATE) ? SD_OK : SD_ERROR;
+}
+
+/**
+ * @brief Начало чтения одного сектора: CMD17, токен, запуск DMA
+ * При ошибке CS уже отпущен
+ */
+static SD_Status sd_read_sector_start(uint32_t sector, uint8_t *buffer) {
+    uint8_t r1 = sd_send_command(SD_CMD17_READ_SINGLE_BLOCK, sd_address(sector), 0xFF);
     if (r1 != SD_R1_READY_STATE) {
         SPI_devices[0].deactivate();
         return SD_ERROR;
     }
 
-    // Токен записи
-    SPI_transfer(SPI1, SD_TOKEN_SINGLE_WRITE);
+    SD_Status status = sd_receive_start(buffer);
+    if (status != SD_OK) SPI_devices[0].deactivate();
+    return status;
+}
+
+/**
+ * @brief Окончание чтения одного сектора
+ */
+static SD_Status sd_read_sector_finish(void) {
+    SD_Status status = sd_receive_finish();
+    SPI_devices[0].deactivate();
+    return status;
+}
+
+/**
+ * @brief Чтение одного сектора (внутренняя реализация)
+ */
+static SD_Status sd_read_sector(uint32_t sector, uint8_t *buffer) {
+    SD_Status status = sd_read_sector_start(sector, buffer);
+    if (status != SD_OK) return status;
+    return sd_read_sector_finish();
+}
+
+/**
+ * @brief Чтение нескольких секторов подряд одной командой CMD18
+ */
+static SD_Status sd_read_sectors(uint32_t sector, uint8_t *buffer, uint32_t count) {
+    uint8_t r1 = sd_send_command(SD_CMD18_READ_MULTIPLE_BLOCK, sd_address(sector), 0xFF);
+    if (r1 != SD_R1_READY_STATE) {
+        SPI_devices[0].deactivate();
+        return SD_ERROR;
+    }
 
-    // Данные
-    for (int i = 0; i < 512; i++) {
-        SPI_transfer(SPI1, buffer[i]);
+    SD_Status status = SD_OK;
+    while (count--) {
+        status = sd_receive_block(buffer);
+        if (status != SD_OK) break;
+        buffer += 512;
     }
 
+    // CMD12 нужен и после ошибки, иначе карта продолжит слать блоки
+    SD_Status stop = sd_stop_transmission();
+    if (status == SD_OK) status = stop;
+
+    SPI_devices[0].deactivate();
+    return status;
+}
+
+/**
+ * @brief Ожидание окончания внутренней записи (карта держит линию в 0)
+ */
+static SD_Status sd_wait_not_busy(void) {
+    uint32_t start = get_ms();
+    while (SPI_transfer(SPI1, 0xFF) == 0x00) {
+        if (get_ms() - start > SD_WRITE_TIMEOUT_MS) {
+            return SD_TIMEOUT_ERROR;
+        }
+    }
+    return SD_OK;
+}
+
+/**
+ * @brief Начало передачи блока: токен и запуск DMA
+ * CS должен быть уже активен
+ */
+static void sd_transmit_start(uint8_t token, const uint8_t *buffer) {
+    // Токен записи
+    SPI_transfer(SPI1, token);
+
+    // 512 байт уходят в DMA
+    sd_dma_start(NULL, buffer);
+}
+
+/**
+ * @brief После фазы данных записи: CRC и ответ карты
+ */
+static SD_Status sd_transmit_response(void) {
     // Фиктивный CRC
     SPI_transfer(SPI1, 0xFF);
     SPI_transfer(SPI1, 0xFF);
@@ -127,31 +474,219 @@ static SD_Status sd_write_sector(uint32_t sector, const uint8_t *buffer) {
     // Проверка ответа
     uint8_t response = SPI_transfer(SPI1, 0xFF);
     if ((response & 0x1F) != SD_TOKEN_DATA_ACCEPTED) {
-        SPI_devices[0].deactivate();
         return SD_ERROR;
     }
+    return SD_OK;
+}
+
+/**
+ * @brief Окончание передачи блока: CRC, ответ, занятость
+ */
+static SD_Status sd_transmit_finish(void) {
+    SD_DMA_wait();
+
+    SD_Status status = sd_transmit_response();
+    if (status != SD_OK) return status;
 
     // Ждём завершения записи
-    volatile uint32_t timeout = 0xFFFF;
-    while (SPI_transfer(SPI1, 0xFF) == 0x00) {
-        if (timeout-- == 0) {
-            SPI_devices[0].deactivate();
-            return SD_TIMEOUT_ERROR;
-        }
+    return sd_wait_not_busy();
+}
+
+/**
+ * @brief Передача одного блока данных: токен, 512 байт, CRC, ответ, занятость
+ * CS должен быть уже активен
+ */
+static SD_Status sd_transmit_block(uint8_t token, const uint8_t *buffer) {
+    sd_transmit_start(token, buffer);
+    return sd_transmit_finish();
+}
+
+/**
+ * @brief Начало записи одного сектора: CMD24, токен, запуск DMA
+ * При ошибке CS уже отпущен
+ */
+static SD_Status sd_write_sector_start(uint32_t sector, const uint8_t *buffer) {
+    uint8_t r1 = sd_send_command(SD_CMD24_WRITE_SINGLE_BLOCK, sd_address(sector), 0xFF);
+    if (r1 != SD_R1_READY_STATE) {
+        SPI_devices[0].deactivate();
+        return SD_ERROR;
     }
 
-    SPI_devices[0].deactivate();
+    sd_transmit_start(SD_TOKEN_SINGLE_WRITE, buffer);
     return SD_OK;
 }
 
+/**
+ * @brief Окончание записи одного сектора
+ */
+static SD_Status sd_write_sector_finish(void) {
+    SD_Status status = sd_transmit_finish();
+    SPI_devices[0].deactivate();
+    return status;
+}
+
+/**
+ * @brief Запись одного сектора (внутренняя реализация)
+ */
+static SD_Status sd_write_sector(uint32_t sector, const uint8_t *buffer) {
+    SD_Status status = sd_write_sector_start(sector, buffer);
+    if (status != SD_OK) return status;
+    return sd_write_sector_finish();
+}
+
+/**
+ * @brief Запись нескольких секторов подряд одной командой CMD25
+ * Перед ней ACMD23 сообщает карте число блоков, чтобы она стёрла их заранее
+ */
+static SD_Status sd_write_sectors(uint32_t sector, const uint8_t *buffer, uint32_t count) {
+    // ACMD23 — только подсказка, её ошибка не мешает записи
+    if (sd_send_command(SD_CMD55_APP_CMD, 0, 0xFF) <= SD_R1_IDLE_STATE) {
+        sd_send_command(SD_ACMD23_SET_WR_BLK_ERASE_COUNT, count, 0xFF);
+    }
+
+    uint8_t r1 = sd_send_command(SD_CMD25_WRITE_MULTIPLE_BLOCK, sd_address(sector), 0xFF);
+    if (r1 != SD_R1_READY_STATE) {
+        SPI_devices[0].deactivate();
+        return SD_ERROR;
+    }
+
+    SD_Status status = SD_OK;
+    while (count--) {
+        status = sd_transmit_block(SD_TOKEN_MULTI_WRITE, buffer);
+        if (status != SD_OK) break;
+        buffer += 512;
+    }
+
+    // Stop Tran нужен и после ошибки, иначе карта останется в режиме записи
+    SPI_transfer(SPI1, SD_TOKEN_STOP_TRAN);
+    SPI_transfer(SPI1, 0xFF);
+    SD_Status stop = sd_wait_not_busy();
+    if (status == SD_OK) status = stop;
+
+    SPI_devices[0].deactivate();
+    return status;
+}
+
+/**
+ * @brief Сброс на низкую скорость для одного повтора после сбоя
+ * @return 1 — скорость была высокой и операцию стоит повторить
+ */
+static uint8_t sd_spi_fallback(void) {
+    if (!sd_high_speed) return 0;
+    uart_puts("\r\nSD error, retry at low speed\r\n");
+    sd_spi_set_low_speed();
+    sd_retry_low = 1;
+    return 1;
+}
+
+/**
+ * @brief После повтора — обратно на высокую скорость, чем бы он ни кончился
+ * Разовый сбой (помеха, вынутая карта) не должен замедлять SPI1 навсегда
+ */
+static void sd_spi_restore(void) {
+    if (sd_retry_low) sd_spi_set_high_speed();
+}
+
+/**
+ * @brief Конец текущего запроса очереди: CS отпускается, запрос уходит
+ * При сбое на высокой скорости запрос остаётся и начнётся заново на низкой
+ */
+static void sdq_complete(SD_Status status) {
+    SD_Request *req = sdq_ring[sdq_head];
+
+    SPI_devices[0].deactivate();
+    sdq_state = SDQ_IDLE;
+    if (status != SD_OK && sd_spi_fallback()) return;
+    sd_spi_restore();
+
+    sdq_head = (uint8_t)((sdq_head + 1) % SD_QUEUE_LEN);
+    sdq_count--;
+    req->status = status;
+    req->done = 1;
+    if (req->callback) req->callback(req);
+}
+
+/**
+ * @brief Начало запроса: только кадр команды, R1 опрашивается по шагам
+ */
+static void sdq_issue(SD_Request *req) {
+    uint8_t cmd = (req->type == SD_REQ_WRITE) ? SD_CMD24_WRITE_SINGLE_BLOCK
+                                              : SD_CMD17_READ_SINGLE_BLOCK;
+    sd_command_frame(cmd, sd_address(req->sector), 0xFF);
+    sdq_start = get_ms();
+    sdq_state = SDQ_R1;
+}
+
+/**
+ * @brief R1 пришёл: для записи — запуск DMA, для чтения — ожидание токена
+ */
+static void sdq_command_done(SD_Request *req, uint8_t r1) {
+    if (r1 != SD_R1_READY_STATE) {
+        sdq_complete(SD_ERROR);
+        return;
+    }
+
+    if (req->type == SD_REQ_WRITE) {
+        sd_transmit_start(SD_TOKEN_SINGLE_WRITE, req->buffer);
+        sdq_state = SDQ_TX;
+    } else {
+        sdq_start = get_ms();
+        sdq_state = SDQ_TOKEN;
+    }
+}
+
 // -----------------------------------------------------------------------------
 // Публичные функции
 // -----------------------------------------------------------------------------
 
+/**
+ * @brief Высокая скорость SPI1 (после успешного sd_init)
+ */
+void sd_spi_set_high_speed(void) {
+    SPI_set_profile(0, SD_SPI_HIGH_SPEED);
+    SPI_apply_profile(0);
+    sd_high_speed = 1;
+    sd_retry_low = 0;
+}
+
+/**
+ * @brief Низкая скорость SPI1 (инициализация и повтор после ошибок)
+ */
+void sd_spi_set_low_speed(void) {
+    SPI_set_profile(0, SD_SPI_LOW_SPEED);
+    SPI_apply_profile(0);
+    sd_high_speed = 0;
+    sd_retry_low = 0;
+}
+
+/**
+ * @brief Текущая скорость SPI1: 1 — высокая
+ */
+uint8_t sd_spi_is_high_speed(void) {
+    return sd_high_speed;
+}
+
+/**
+ * @brief Ошибка инициализации: CS вверх, 8 тактов, сообщение в UART
+ * @return status — чтобы выйти одной строкой
+ */
+static SD_Status sd_init_fail(const char *msg, SD_Status status) {
+    SPI_devices[0].deactivate();
+    SPI_transfer(SPI1, 0xFF);
+    uart_puts(msg);
+    return status;
+}
+
 /**
  * @brief Инициализация SD-карты
  */
 SD_Status sd_init(void) {
+    // Начатый запрос надо довести, иначе карта не в том состоянии
+    SD_QueueFlush();
+    SD_DMA_init();
+    sd_info = (SD_CardInfo){0};
+    // Идентификация всегда на низкой скорости (в том числе при повторной)
+    sd_spi_set_low_speed();
     SPI_devices[0].deactivate();
     // Задержка после подачи питания
     for (volatile int i = 0; i < 100000; i++);
@@ -160,46 +695,390 @@ SD_Status sd_init(void) {
     Delay_ms(50);
     // CMD0
     uint8_t r1 = sd_send_command(SD_CMD0_GO_IDLE_STATE, 0, 0x95);
-    if (r1 != SD_R1_IDLE_STATE) {uart_puts("\r\nSD init SD_CMD0_GO_IDLE_STATE error\r\n");return SD_ERROR;}
+    if (r1 != SD_R1_IDLE_STATE) return sd_init_fail("\r\nSD init SD_CMD0_GO_IDLE_STATE error\r\n", SD_ERROR);
 
-    // CMD8
+    // CMD8: SD 2.0 отвечает эхом 0x1AA, SD 1.x его не знает
     r1 = sd_send_command(SD_CMD8_SEND_IF_COND, 0x000001AA, 0x87);
-    if (r1 != SD_R1_IDLE_STATE) {uart_puts("\r\nSD init SD_R1_IDLE_STATE error\r\n");return SD_ERROR;}
-
-    uint8_t cmd8_resp[4];
-    sd_read_data(cmd8_resp, 4);
-    if (cmd8_resp[2] != 0x01 || cmd8_resp[3] != 0xAA) {uart_puts("\r\nSD init cmd8_resp error\r\n");return SD_ERROR;}
+    if (r1 == SD_R1_IDLE_STATE) {
+        uint8_t cmd8_resp[4];
+        sd_read_data(cmd8_resp, 4);
+        if (cmd8_resp[2] != 0x01 || cmd8_resp[3] != 0xAA) return sd_init_fail("\r\nSD init cmd8_resp error\r\n", SD_ERROR);
+        sd_info.type = SD_TYPE_SD2;
+    } else if (r1 == (SD_R1_IDLE_STATE | SD_R1_ILLEGAL_COMMAND)) {
+        sd_info.type = SD_TYPE_SD1;
+    } else {
+        return sd_init_fail("\r\nSD init SD_CMD8_SEND_IF_COND error\r\n", SD_ERROR);
+    }
 
-    // ACMD41 (выход из IDLE)
-    uint32_t timeout = 1000;
+    // ACMD41 (выход из IDLE); HCS — только для SD 2.0, SD 1.x его не понимает
+    uint32_t hcs = (sd_info.type & SD_TYPE_SD2) ? SD_OCR_CCS : 0;
+    uint32_t start = get_ms();
     do {
         r1 = sd_send_command(SD_CMD55_APP_CMD, 0, 0xFF);
-        if (r1 != SD_R1_IDLE_STATE)  {uart_puts("\r\nSD init SD_R1_IDLE_STATE error\r\n");return SD_ERROR;}
+        if (r1 != SD_R1_IDLE_STATE)  return sd_init_fail("\r\nSD init SD_R1_IDLE_STATE error\r\n", SD_ERROR);
 
-        r1 = sd_send_command(SD_CMD41_SD_SEND_OP_COND, 0x40000000, 0xFF);
+        r1 = sd_send_command(SD_CMD41_SD_SEND_OP_COND, hcs, 0xFF);
         if (r1 == SD_R1_READY_STATE) break;
+        if (r1 & SD_R1_ILLEGAL_COMMAND) return sd_init_fail("\r\nSD init ACMD41 error: not an SD card\r\n", SD_ERROR);
 
-        for (volatile int i = 0; i < 20000; i++);
-    } while (timeout--);
-
-    if (r1 != SD_R1_READY_STATE) return SD_TIMEOUT_ERROR;
+        Delay_ms(1);
+    } while (get_ms() - start <= SD_INIT_TIMEOUT_MS);
 
+    if (r1 != SD_R1_READY_STATE) return sd_init_fail("\r\nSD init ACMD41 timeout\r\n", SD_TIMEOUT_ERROR);
     SPI_devices[0].deactivate();
+
+    // Геометрия — для disk_ioctl (f_mkfs выравнивает по блоку стирания),
+    // тут же из OCR становится ясно, как адресуется карта
+    if (sd_read_card_info() != SD_OK) {
+        sd_info.sectors = 0;
+        uart_puts("\r\nSD init card info error\r\n");
+        return SD_ERROR;
+    }
+
+    // SDSC: блок 512 байт (у SDHC/SDXC он и так фиксирован)
+    if (!(sd_info.type & SD_TYPE_BLOCK)) {
+        r1 = sd_send_command(SD_CMD16_SET_BLOCKLEN, 512, 0xFF);
+        SPI_devices[0].deactivate();
+        if (r1 != SD_R1_READY_STATE) {
+            sd_info.sectors = 0;
+            uart_puts("\r\nSD init SD_CMD16_SET_BLOCKLEN error\r\n");
+            return SD_ERROR;
+        }
+    }
+
+    sd_spi_set_high_speed();
     return SD_OK;
 }
 
+/**
+ * @brief Регистры и геометрия карты после sd_init()
+ * @return указатель на данные; sectors = 0, если карта не опознана
+ */
+const SD_CardInfo *sd_card_info(void) {
+    return &sd_info;
+}
+
 /**
  * @brief Чтение блока — для FatFS (diskio.c)
  */
 SD_Status SD_ReadBlock(uint32_t sector, uint8_t *buffer) {
-    return sd_read_sector(sector, buffer);
+    SD_QueueFlush();
+    SD_Status status = sd_read_sector(sector, buffer);
+    if (status != SD_OK && sd_spi_fallback()) status = sd_read_sector(sector, buffer);
+    sd_spi_restore();
+    return status;
+}
+
+/**
+ * @brief Чтение нескольких блоков подряд (CMD18) — для FatFS (diskio.c)
+ */
+SD_Status SD_ReadBlocks(uint32_t sector, uint8_t *buffer, uint32_t count) {
+    if (count == 0) return SD_OK;
+    if (count == 1) return SD_ReadBlock(sector, buffer);
+    SD_QueueFlush();
+    SD_Status status = sd_read_sectors(sector, buffer, count);
+    if (status != SD_OK && sd_spi_fallback()) status = sd_read_sectors(sector, buffer, count);
+    sd_spi_restore();
+    return status;
 }
 
 /**
  * @brief Запись блока — для FatFS (diskio.c)
  */
 SD_Status SD_WriteBlock(uint32_t sector, const uint8_t *buffer) {
-    return sd_write_sector(sector, buffer);
+    SD_QueueFlush();
+    SD_Status status = sd_write_sector(sector, buffer);
+    if (status != SD_OK && sd_spi_fallback()) status = sd_write_sector(sector, buffer);
+    sd_spi_restore();
+    return status;
+}
+
+/**
+ * @brief Запись нескольких блоков подряд (ACMD23 + CMD25) — для FatFS (diskio.c)
+ */
+SD_Status SD_WriteBlocks(uint32_t sector, const uint8_t *buffer, uint32_t count) {
+    if (count == 0) return SD_OK;
+    if (count == 1) return SD_WriteBlock(sector, buffer);
+    SD_QueueFlush();
+    SD_Status status = sd_write_sectors(sector, buffer, count);
+    if (status != SD_OK && sd_spi_fallback()) status = sd_write_sectors(sector, buffer, count);
+    sd_spi_restore();
+    return status;
+}
+/**
+ * @brief Начало асинхронного чтения блока
+ * После SD_OK буфер заполняет DMA, результат — в SD_ReadBlockFinish()
+ */
+SD_Status SD_ReadBlockStart(uint32_t sector, uint8_t *buffer) {
+    SD_QueueFlush();
+    SD_Status status = sd_read_sector_start(sector, buffer);
+    if (status != SD_OK && sd_spi_fallback()) status = sd_read_sector_start(sector, buffer);
+    // Удачный повтор ещё идёт по DMA: скорость вернёт Finish
+    if (status != SD_OK) sd_spi_restore();
+    sd_async_op = (status == SD_OK) ? SD_ASYNC_READ : SD_ASYNC_NONE;
+    return status;
+}
+
+/**
+ * @brief Начало упреждающего чтения блока, завершается SD_ReadBlockFinish()
+ * Сектор может оказаться ненужным: сбой не повторяется и не сбрасывает
+ * скорость SPI1, решать об этом будет настоящее чтение
+ */
+SD_Status SD_ReadAheadStart(uint32_t sector, uint8_t *buffer) {
+    SD_QueueFlush();
+    SD_Status status = sd_read_sector_start(sector, buffer);
+    sd_async_op = (status == SD_OK) ? SD_ASYNC_READ : SD_ASYNC_NONE;
+    return status;
+}
+
+/**
+ * @brief Окончание асинхронного чтения блока
+ */
+SD_Status SD_ReadBlockFinish(void) {
+    if (sd_async_op != SD_ASYNC_READ) return SD_ERROR;
+    sd_async_op = SD_ASYNC_NONE;
+    SD_Status status = sd_read_sector_finish();
+    sd_spi_restore();
+    return status;
+}
+
+/**
+ * @brief Начало асинхронной записи блока
+ * Буфер должен жить до SD_WriteBlockFinish()
+ */
+SD_Status SD_WriteBlockStart(uint32_t sector, const uint8_t *buffer) {
+    SD_QueueFlush();
+    SD_Status status = sd_write_sector_start(sector, buffer);
+    if (status != SD_OK && sd_spi_fallback()) status = sd_write_sector_start(sector, buffer);
+    // Удачный повтор ещё идёт по DMA: скорость вернёт Finish
+    if (status != SD_OK) sd_spi_restore();
+    sd_async_op = (status == SD_OK) ? SD_ASYNC_WRITE : SD_ASYNC_NONE;
+    return status;
+}
+
+/**
+ * @brief Окончание асинхронной записи блока: ответ карты и ожидание занятости
+ */
+SD_Status SD_WriteBlockFinish(void) {
+    if (sd_async_op != SD_ASYNC_WRITE) return SD_ERROR;
+    sd_async_op = SD_ASYNC_NONE;
+    SD_Status status = sd_write_sector_finish();
+    sd_spi_restore();
+    return status;
+}
+
+/**
+ * @brief Функция, которая завершает начатый SD_*BlockStart по просьбе очереди
+ * Нужна тому, кто оставляет обмен открытым после своего возврата
+ * (упреждающее чтение diskcache), иначе очередь будет стоять
+ * @param release указатель на функцию или NULL
+ */
+void SD_setAsyncRelease(void (*release)(void)) {
+    sd_async_release = release;
+}
+
+/**
+ * @brief Освобождение SPI1 от SD_*BlockStart ради очереди
+ * @param wait 0 — не ждать DMA, если фаза данных ещё идёт
+ * @return 1 — шина свободна
+ */
+static uint8_t sdq_take_bus(uint8_t wait) {
+    if (sd_async_op == SD_ASYNC_NONE) return 1;
+    if (!sd_async_release || (!wait && sd_dma_busy)) return 0;
+    sd_async_release();
+    return sd_async_op == SD_ASYNC_NONE;
+}
+
+/**
+ * @brief Закрыть прерывания с FatFS (BASEPRI не ослабляется)
+ * @return прежний BASEPRI для sdq_unlock()
+ */
+static uint32_t sdq_lock(void) {
+    uint32_t basepri = __get_BASEPRI();
+    if (basepri == 0 || basepri > SDQ_BASEPRI) __set_BASEPRI(SDQ_BASEPRI);
+    return basepri;
+}
+
+static inline void sdq_unlock(uint32_t basepri) {
+    __set_BASEPRI(basepri);
+}
+
+/**
+ * @brief Постановка запроса в очередь
+ * Структура и буфер должны жить, пока req->done не станет 1
+ * @return SD_OK, SD_ERROR если очередь полна или тип неизвестен
+ */
+SD_Status SD_QueueSubmit(SD_Request *req) {
+    if (req->type != SD_REQ_READ && req->type != SD_REQ_WRITE) return SD_ERROR;
+
+    uint32_t basepri = sdq_lock();
+    SD_Status status = SD_ERROR;
+    if (sdq_count < SD_QUEUE_LEN) {
+        req->done = 0;
+        req->status = SD_OK;
+        sdq_ring[(sdq_head + sdq_count) % SD_QUEUE_LEN] = req;
+        sdq_count++;
+        status = SD_OK;
+    }
+    sdq_unlock(basepri);
+    return status;
+}
+
+/**
+ * @brief Шаг текущего запроса по его состоянию
+ */
+static void sdq_step(SD_Request *req) {
+    uint8_t data = 0xFF;
+
+    switch (sdq_state) {
+        case SDQ_IDLE:
+            sdq_issue(req);
+            break;
+
+        case SDQ_R1:
+            for (uint8_t i = 0; i < SDQ_POLL_BYTES && data == 0xFF; i++) {
+                data = SPI_transfer(SPI1, 0xFF);
+            }
+            if (data != 0xFF) {
+                sdq_command_done(req, data);
+            } else if (get_ms() - sdq_start > SD_CMD_TIMEOUT_MS) {
+                sdq_complete(SD_TIMEOUT_ERROR);
+            }
+            break;
+
+        case SDQ_TOKEN:
+            for (uint8_t i = 0; i < SDQ_POLL_BYTES && data == 0xFF; i++) {
+                data = SPI_transfer(SPI1, 0xFF);
+            }
+            if (data == SD_TOKEN_SINGLE_READ) {
+                sd_dma_start(req->buffer, NULL);
+                sdq_state = SDQ_RX;
+            } else if (data != 0xFF) {
+                sdq_complete(SD_ERROR);
+            } else if (get_ms() - sdq_start > SD_READ_TIMEOUT_MS) {
+                sdq_complete(SD_TIMEOUT_ERROR);
+            }
+            break;
+
+        case SDQ_RX:
+            if (SD_DMA_busy()) break;
+            sdq_complete(sd_receive_finish());
+            break;
+
+        case SDQ_TX:
+            if (SD_DMA_busy()) break;
+            if (sd_transmit_response() != SD_OK) {
+                sdq_complete(SD_ERROR);
+                break;
+            }
+            sdq_start = get_ms();
+            sdq_state = SDQ_BUSY;
+            break;
+
+        case SDQ_BUSY:
+            // Карта держит линию в 0, пока программирует блок
+            data = 0x00;
+            for (uint8_t i = 0; i < SDQ_POLL_BYTES && data == 0x00; i++) {
+                data = SPI_transfer(SPI1, 0xFF);
+            }
+            if (data != 0x00) {
+                sdq_complete(SD_OK);
+            } else if (get_ms() - sdq_start > SD_WRITE_TIMEOUT_MS) {
+                sdq_complete(SD_TIMEOUT_ERROR);
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Один шаг очереди, не ждёт карту
+ * Долгие ожидания (R1, токен чтения, занятость после записи) разбиты на
+ * опросы по SDQ_POLL_BYTES байт, предел — SD_*_TIMEOUT_MS по get_ms().
+ * Шаг идёт под BASEPRI: обработчик EXTI с FatFS не вклинится посреди
+ * обмена, а между шагами он сначала доработает очередь сам
+ * @return 1 — в очереди ещё есть работа
+ */
+uint8_t SD_QueuePoll(void) {
+    if (sdq_count == 0) return 0;
+
+    uint32_t basepri = sdq_lock();
+    // SPI1 занят SD_*BlockStart: законченное упреждающее чтение забирается,
+    // идущее — в следующий раз
+    if (sdq_count && sdq_take_bus(0)) sdq_step(sdq_ring[sdq_head]);
+    sdq_unlock(basepri);
+    return sdq_count != 0;
+}
+
+/**
+ * @brief Есть ли в очереди необработанные запросы
+ */
+uint8_t SD_QueueBusy(void) {
+    return sdq_count != 0;
+}
+
+/**
+ * @brief Доработка очереди до конца (с ожиданием)
+ * Открытый SD_*BlockStart сначала завершается через SD_setAsyncRelease();
+ * если завершить его некому, очередь стоит — тогда возвращается сразу
+ */
+void SD_QueueFlush(void) {
+    while (sdq_count && sdq_take_bus(1)) SD_QueuePoll();
+}
+
+/**
+ * @brief Настройка DMA1 каналов 2/3 на обмен с SPI1->DR
+ */
+void SD_DMA_init(void) {
+    RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+
+    DMA1_Channel2->CCR  = 0;
+    DMA1_Channel2->CPAR = (uint32_t)&SPI1->DR;
+    DMA1_Channel3->CCR  = 0;
+    DMA1_Channel3->CPAR = (uint32_t)&SPI1->DR;
+    DMA1->IFCR = DMA_IFCR_CGIF2 | DMA_IFCR_CGIF3;
+
+    // Как и у дисплея — выше кнопок (EXTI = 2)
+    NVIC_SetPriority(DMA1_Channel2_IRQn, 1);
+    NVIC_EnableIRQ(DMA1_Channel2_IRQn);
+}
+
+/**
+ * @brief Идет ли сейчас обмен через DMA
+ * @return 1 если обмен не закончен, 0 если каналы свободны
+ */
+uint8_t SD_DMA_busy(void) {
+    return sd_dma_busy;
+}
+
+/**
+ * @brief Ожидание окончания обмена через DMA
+ */
+void SD_DMA_wait(void) {
+    while (sd_dma_busy) {};
+}
+
+/**
+ * @brief Функция которая вызовется из прерывания по окончанию фазы данных
+ * @param callback указатель на функцию или NULL
+ */
+void SD_DMA_setCallback(void (*callback)(void)) {
+    sd_dma_callback = callback;
+}
+
+/**
+ * @brief Обработчик прерывания DMA1 канал 2 (SPI1_RX)
+ * Последний принятый байт означает, что и передача закончилась
+ */
+void DMA1_Channel2_IRQHandler(void) {
+    if (!(DMA1->ISR & DMA_ISR_TCIF2)) return;
+    DMA1->IFCR = DMA_IFCR_CGIF2 | DMA_IFCR_CGIF3;
+
+    DMA1_Channel2->CCR = 0;
+    DMA1_Channel3->CCR = 0;
+    SPI1->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+
+    sd_dma_busy = 0;
+    if (sd_dma_callback) sd_dma_callback();
 }
 
 
@@ -213,4 +1092,4 @@ void log_message(const char* msg) {
     f_write(&file, "\r\n", 2, NULL);
 
     f_close(&file);
-}
\ No newline at end of file
+}
@@ -10,18 +10,50 @@
 // -----------------------------------------------------------------------------
 #define SD_CMD0_GO_IDLE_STATE       (0)
 #define SD_CMD8_SEND_IF_COND        (8)
+#define SD_CMD9_SEND_CSD            (9)
+#define SD_CMD10_SEND_CID           (10)
+#define SD_CMD12_STOP_TRANSMISSION  (12)
+#define SD_ACMD13_SD_STATUS         (13)
+#define SD_CMD16_SET_BLOCKLEN       (16)
 #define SD_CMD17_READ_SINGLE_BLOCK  (17)
+#define SD_CMD18_READ_MULTIPLE_BLOCK (18)
 #define SD_CMD24_WRITE_SINGLE_BLOCK (24)
+#define SD_CMD25_WRITE_MULTIPLE_BLOCK (25)
+#define SD_ACMD23_SET_WR_BLK_ERASE_COUNT (23)
 #define SD_CMD55_APP_CMD            (55)
 #define SD_CMD58_READ_OCR           (58)
 #define SD_CMD41_SD_SEND_OP_COND    (41)
 
 #define SD_TOKEN_SINGLE_READ        (0xFE)
 #define SD_TOKEN_SINGLE_WRITE       (0xFE)
+#define SD_TOKEN_MULTI_WRITE        (0xFC)
+#define SD_TOKEN_STOP_TRAN          (0xFD)
 #define SD_TOKEN_DATA_ACCEPTED      (0x05)
 
 #define SD_R1_IDLE_STATE            (0x01)
 #define SD_R1_READY_STATE           (0x00)
+#define SD_R1_ILLEGAL_COMMAND       (0x04)
+
+// OCR: бит CCS — карта адресуется блоками (SDHC/SDXC)
+#define SD_OCR_CCS                  (1UL << 30)
+
+// Скорость SPI1: до ACMD41 — как раньше, после — максимум для карты
+// (PCLK2 72 МГц / 4 = 18 МГц, /2 уже больше 25 МГц допустимых)
+#define SD_SPI_LOW_SPEED            SPI_BaudRatePrescaler_64
+#define SD_SPI_HIGH_SPEED           SPI_BaudRatePrescaler_4
+
+// Предельные времена ожидания карты по get_ms(), мс
+#define SD_CMD_TIMEOUT_MS           100     // ответ R1
+#define SD_READ_TIMEOUT_MS          100     // токен данных при чтении
+#define SD_WRITE_TIMEOUT_MS         500     // занятость после записи блока (SDXC — до 500)
+#define SD_INIT_TIMEOUT_MS          1000    // выход из IDLE по ACMD41
+
+// Сколько запросов держит очередь SD_QueueSubmit()
+#define SD_QUEUE_LEN                4
+
+// Приоритет прерываний, из которых работает FatFS (EXTI кнопок меню):
+// шаг SD_QueuePoll() закрывает их через BASEPRI, DMA и SysTick выше
+#define SD_FATFS_IRQ_PRIORITY       2
 
 
 typedef enum {
@@ -30,17 +62,81 @@ typedef enum {
     SD_TIMEOUT_ERROR
 } SD_Status;
 
+// Тип карты (SD_CardInfo.type, MMC_GET_TYPE) — биты как в примерах FatFS
+#define SD_TYPE_SD1                 (0x02)   // SD 1.x: не знает CMD8
+#define SD_TYPE_SD2                 (0x04)   // SD 2.0 и новее
+#define SD_TYPE_BLOCK               (0x08)   // адресация блоками (SDHC/SDXC), иначе байтами
+
+// Регистры и геометрия карты, заполняются в sd_init()
+typedef struct {
+    uint8_t  csd[16];
+    uint8_t  cid[16];
+    uint32_t ocr;
+    uint8_t  type;           // SD_TYPE_*, 0 — карта не опознана
+    uint32_t sectors;        // ёмкость в секторах по 512 байт, 0 — карта не опознана
+    uint32_t erase_block;    // блок стирания (AU) в секторах, степень двойки
+} SD_CardInfo;
+
+// Запрос в очередь: один блок. Структуру и буфер держит вызывающий,
+// пока не станет done = 1
+#define SD_REQ_READ                 (0)
+#define SD_REQ_WRITE                (1)
+
+typedef struct SD_Request {
+    uint8_t  type;                  // SD_REQ_READ / SD_REQ_WRITE
+    uint32_t sector;
+    uint8_t *buffer;                // 512 байт
+    void (*callback)(struct SD_Request *req);   // по завершении или NULL
+    volatile uint8_t   done;        // 1 — запрос обработан
+    volatile SD_Status status;      // результат, когда done = 1
+} SD_Request;
+
 /**
- * @brief Ждёт R1-ответ от карты (не 0xFF)
+ * @brief Ждёт R1-ответ от карты (не 0xFF), CS держит вызывающий
  */
 uint8_t sd_wait_for_r1(uint32_t timeout_ms) ;
 // === Обязательные для FatFS функции ===
 SD_Status SD_ReadBlock(uint32_t sector, uint8_t *buffer);
+SD_Status SD_ReadBlocks(uint32_t sector, uint8_t *buffer, uint32_t count);
 SD_Status SD_WriteBlock(uint32_t sector, const uint8_t *buffer);
+SD_Status SD_WriteBlocks(uint32_t sector, const uint8_t *buffer, uint32_t count);
+
+// === Асинхронный обмен одним блоком ===
+// Start отдаёт фазу данных DMA и сразу возвращается (CS остаётся активным),
+// Finish дожидается DMA, дочитывает CRC/ответ и отпускает CS.
+// Между ними SPI1 и буфер трогать нельзя. SD_ReadAheadStart — то же для
+// упреждающего чтения: при сбое не повторяет и скорость SPI1 не сбрасывает.
+SD_Status SD_ReadBlockStart(uint32_t sector, uint8_t *buffer);
+SD_Status SD_ReadAheadStart(uint32_t sector, uint8_t *buffer);
+SD_Status SD_ReadBlockFinish(void);
+SD_Status SD_WriteBlockStart(uint32_t sector, const uint8_t *buffer);
+SD_Status SD_WriteBlockFinish(void);
+void SD_setAsyncRelease(void (*release)(void));
+
+// === Очередь запросов без блокировки ===
+// SD_QueuePoll() делает один короткий шаг (команда, несколько байт ожидания
+// R1, токена или занятости) и возвращается; его крутит главный цикл. FatFS
+// работает из EXTI: шаг закрыт от них BASEPRI, а SD_* из обработчиков
+// сначала дорабатывают очередь. Открытый Start очередь завершает через
+// SD_setAsyncRelease().
+SD_Status SD_QueueSubmit(SD_Request *req);
+uint8_t SD_QueuePoll(void);
+uint8_t SD_QueueBusy(void);
+void SD_QueueFlush(void);
+
+// === DMA1 канал 2 (SPI1_RX) и канал 3 (SPI1_TX) ===
+void SD_DMA_init(void);
+uint8_t SD_DMA_busy(void);
+void SD_DMA_wait(void);
+void SD_DMA_setCallback(void (*callback)(void));
+void DMA1_Channel2_IRQHandler(void);
 
 // === Вспомогательные функции ===
 SD_Status sd_init(void);
+const SD_CardInfo *sd_card_info(void);
 void sd_spi_set_high_speed(void);
+void sd_spi_set_low_speed(void);
+uint8_t sd_spi_is_high_speed(void);
 void log_message(const char* msg);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,503 @@
+/**
+ * @file bmp.c
+ * @brief Потоковый вывод BMP на LCD
+ *
+ * Поддерживает:
+ * - 24 бита (BI_RGB)
+ * - 16 бит: 555 (BI_RGB) и 565/555 (BI_BITFIELDS)
+ * - 8 бит с палитрой (BI_RGB)
+ * - строки снизу вверх и сверху вниз, выравнивание строк до 4 байт
+ * - любой размер и положение, с отсечением по краям экрана
+ * - уменьшение на лету: ближайший сосед или усреднение блоков k x k
+ *
+ * ОЗУ: палитра (512 байт) + сырой кусок строки + две строки RGB565
+ * (+ сумматоры по столбцам для усреднения), вместе с FIL и таблицей
+ * кластеров — в общей work_area (work_area.h).
+ */
+
+#include "bmp.h"
+#include "ILI9225.h"
+#include "work_area.h"
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+// Константы формата
+// -----------------------------------------------------------------------------
+
+#define BMP_BI_RGB        0
+#define BMP_BI_BITFIELDS  3
+
+// -----------------------------------------------------------------------------
+// Внутренние переменные
+// -----------------------------------------------------------------------------
+
+static int16_t  bmp_box_x, bmp_box_y;       // прямоугольник bmp_draw_scaled()
+static uint16_t bmp_box_w, bmp_box_h;
+
+// -----------------------------------------------------------------------------
+// Внутренние функции
+// -----------------------------------------------------------------------------
+
+static inline uint16_t bmp_le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t bmp_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Чтение палитры и перевод её в RGB565
+ */
+static FRESULT bmp_load_palette(FIL *fp, const bmp_info_t *info) {
+    uint16_t *palette = work_area.bmp.palette;
+    uint8_t *raw = work_area.bmp.raw;
+    memset(palette, 0, sizeof(work_area.bmp.palette));
+
+    FRESULT res = f_lseek(fp, info->palette_offset);
+    uint16_t done = 0;
+
+    // Палитра идёт через сырой буфер кусками по BMP_LINE_MAX цветов (B, G, R, 0)
+    while (res == FR_OK && done < info->palette_size) {
+        uint16_t n = info->palette_size - done;
+        if (n > sizeof(work_area.bmp.raw) / 4) n = sizeof(work_area.bmp.raw) / 4;
+
+        UINT bytes_read;
+        res = f_read(fp, raw, n * 4u, &bytes_read);
+        if (res == FR_OK && bytes_read != n * 4u) res = FR_INT_ERR;
+
+        for (uint16_t i = 0; res == FR_OK && i < n; i++) {
+            const uint8_t *c = &raw[i * 4];
+            palette[done + i] = (uint16_t)(((c[2] >> 3) << 11) | ((c[1] >> 2) << 5) | (c[0] >> 3));
+        }
+        done += n;
+    }
+    return res;
+}
+
+static inline uint16_t bmp_rgb888(const uint8_t *p) {
+    return (uint16_t)(((p[2] >> 3) << 11) | ((p[1] >> 2) << 5) | (p[0] >> 3));
+}
+
+/**
+ * @brief 555 -> 565: старший бит зелёного повторяется в младшем
+ */
+static inline uint16_t bmp_rgb555(uint16_t v) {
+    return (uint16_t)(((v & 0x7FE0) << 1) | ((v >> 4) & 0x0020) | (v & 0x001F));
+}
+
+/**
+ * @brief Один пиксель из формата файла в RGB565
+ */
+static inline uint16_t bmp_pixel(const bmp_info_t *info, const uint8_t *src) {
+    switch (info->format) {
+    case BMP_FMT_RGB888: return bmp_rgb888(src);
+    case BMP_FMT_RGB565: return bmp_le16(src);
+    case BMP_FMT_RGB555: return bmp_rgb555(bmp_le16(src));
+    default:             return work_area.bmp.palette[src[0]];
+    }
+}
+
+/**
+ * @brief Перевод куска строки из формата файла в RGB565
+ */
+static void bmp_convert(const bmp_info_t *info, const uint8_t *src, uint16_t *dst, uint16_t count) {
+    switch (info->format) {
+    case BMP_FMT_RGB888:
+        for (uint16_t i = 0; i < count; i++, src += 3) dst[i] = bmp_rgb888(src);
+        break;
+
+    case BMP_FMT_RGB565:
+        for (uint16_t i = 0; i < count; i++, src += 2) dst[i] = bmp_le16(src);
+        break;
+
+    case BMP_FMT_RGB555:
+        for (uint16_t i = 0; i < count; i++, src += 2) dst[i] = bmp_rgb555(bmp_le16(src));
+        break;
+
+    default: // BMP_FMT_PAL8
+        for (uint16_t i = 0; i < count; i++) dst[i] = work_area.bmp.palette[src[i]];
+        break;
+    }
+}
+
+/**
+ * @brief Открытие файла, разбор заголовка и загрузка палитры
+ * При ошибке файл уже закрыт
+ */
+static FRESULT bmp_open(FIL *fp, const char *name, bmp_info_t *info) {
+    uint8_t header[BMP_HEADER_READ];
+    UINT bytes_read;
+
+    FRESULT res = f_open(fp, name, FA_READ);
+    if (res != FR_OK) return res;
+
+    memset(header, 0, sizeof(header));
+    res = f_read(fp, header, sizeof(header), &bytes_read);
+    if (res == FR_OK && (bytes_read < 54 || !bmp_parse(header, info))) res = FR_INVALID_OBJECT;
+    if (res == FR_OK && info->format == BMP_FMT_PAL8) res = bmp_load_palette(fp, info);
+    if (res != FR_OK) f_close(fp);
+    return res;
+}
+
+/**
+ * @brief Чтение куска строки файла в сырой буфер
+ * @param row номер строки в файле (в порядке хранения)
+ * @param col первый пиксель
+ * @param count сколько пикселей, не больше bmp_raw_capacity()
+ */
+static FRESULT bmp_read_span(FIL *fp, const bmp_info_t *info, uint32_t row, uint32_t col, uint16_t count) {
+    FSIZE_t ofs = info->data_offset + (FSIZE_t)row * info->stride + (FSIZE_t)col * info->bytes_pp;
+    UINT len = (UINT)count * info->bytes_pp;
+    UINT bytes_read;
+
+    FRESULT res = f_lseek(fp, ofs);
+    if (res == FR_OK) res = f_read(fp, work_area.bmp.raw, len, &bytes_read);
+    if (res == FR_OK && bytes_read != len) res = FR_INT_ERR;
+    return res;
+}
+
+/**
+ * @brief Сколько пикселей помещается в сырой буфер
+ */
+static inline uint16_t bmp_raw_capacity(const bmp_info_t *info) {
+    return (uint16_t)(sizeof(work_area.bmp.raw) / info->bytes_pp);
+}
+
+/**
+ * @brief Строка файла для строки картинки (сверху вниз)
+ */
+static inline uint32_t bmp_file_row(const bmp_info_t *info, uint32_t image_row) {
+    return info->top_down ? image_row : info->height - 1 - image_row;
+}
+
+/**
+ * @brief Открытие окна: строки по порядку файла, чтобы читать его только вперёд
+ */
+static void bmp_open_window(const bmp_info_t *info, int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+    ILI9225_setScanOrder(info->top_down ? ILI9225_SCAN_ROWS : ILI9225_SCAN_ROWS_UP);
+    ILI9225_setWindow(x0, y0, x1, y1);
+    if (!info->top_down) ILI9225_setCursor(x0, y1);
+    ILI9225_writeIndex(GRAM_DATA_REG);
+}
+
+/**
+ * @brief Приёмник bmp_draw_scaled(): окно по центру прямоугольника, строки — DMA
+ */
+static FRESULT bmp_lcd_sink(const bmp_scaled_t *img, uint32_t row, const uint16_t *line) {
+    if (row == 0) {
+        int32_t x0 = bmp_box_x + (bmp_box_w - img->width) / 2;
+        int32_t y0 = bmp_box_y + (bmp_box_h - img->height) / 2;
+        ILI9225_setScanOrder(img->bottom_up ? ILI9225_SCAN_ROWS_UP : ILI9225_SCAN_ROWS);
+        ILI9225_setWindow(x0, y0, x0 + img->width - 1, y0 + img->height - 1);
+        if (img->bottom_up) ILI9225_setCursor(x0, y0 + img->height - 1);
+        ILI9225_writeIndex(GRAM_DATA_REG);
+    }
+    // Ждёт только строку row-1, следующая читается параллельно
+    ILI9225_DMA_sendPixels(line, img->width);
+    return FR_OK;
+}
+
+/**
+ * @brief Источник для выходного пикселя при шаге step (16.16), по центру шага
+ */
+static inline uint32_t bmp_scale_src(uint32_t out, uint32_t step) {
+    return (uint32_t)(((uint64_t)(2 * out + 1) * step) >> 17);
+}
+
+/**
+ * @brief Строка ближайшим соседом: читаются только куски с нужными пикселями
+ * Кусок кончается на последнем нужном столбце; разрыв до следующего
+ * не короче сектора не читается, а перескакивается через f_lseek
+ */
+static FRESULT bmp_row_nearest(FIL *fp, const bmp_info_t *info, uint32_t row,
+                               uint32_t step, uint16_t out_w, uint16_t *dst) {
+    const uint8_t *raw = work_area.bmp.raw;
+    uint16_t cap = bmp_raw_capacity(info);
+    uint32_t gap = 512u / info->bytes_pp;
+    uint16_t ox = 0;
+
+    while (ox < out_w) {
+        uint32_t c0 = bmp_scale_src(ox, step);
+        uint32_t last = c0;
+        uint16_t ox_end = (uint16_t)(ox + 1);
+
+        while (ox_end < out_w) {
+            uint32_t sx = bmp_scale_src(ox_end, step);
+            if (sx - c0 >= cap || sx - last >= gap) break;
+            last = sx;
+            ox_end++;
+        }
+
+        uint16_t n = (uint16_t)(last - c0 + 1);
+        FRESULT res = bmp_read_span(fp, info, row, c0, n);
+        if (res != FR_OK) return res;
+
+        for (; ox < ox_end; ox++) {
+            dst[ox] = bmp_pixel(info, raw + (bmp_scale_src(ox, step) - c0) * info->bytes_pp);
+        }
+    }
+    return FR_OK;
+}
+
+/**
+ * @brief Добавление строки файла в суммы по блокам шириной k
+ */
+static FRESULT bmp_row_box_add(FIL *fp, const bmp_info_t *info, uint32_t row,
+                               uint16_t k, uint16_t out_w) {
+    const uint8_t *raw = work_area.bmp.raw;
+    uint16_t (*acc)[WORK_LINE_MAX] = work_area.bmp.acc;
+    uint16_t cap = bmp_raw_capacity(info);
+    uint32_t total = (uint32_t)out_w * k;
+
+    for (uint32_t c0 = 0; c0 < total; c0 += cap) {
+        uint16_t n = (total - c0 > cap) ? cap : (uint16_t)(total - c0);
+
+        FRESULT res = bmp_read_span(fp, info, row, c0, n);
+        if (res != FR_OK) return res;
+
+        for (uint16_t i = 0; i < n; i++) {
+            uint16_t c = bmp_pixel(info, raw + i * info->bytes_pp);
+            uint16_t ox = (uint16_t)((c0 + i) / k);
+            acc[0][ox] += c >> 11;
+            acc[1][ox] += (c >> 5) & 0x3F;
+            acc[2][ox] += c & 0x1F;
+        }
+    }
+    return FR_OK;
+}
+
+// -----------------------------------------------------------------------------
+// Публичные функции
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Разбор заголовков BMP
+ * @param header первые BMP_HEADER_READ байт файла
+ * @param info куда положить параметры картинки
+ * @return 1 если формат поддерживается, 0 если нет
+ */
+uint8_t bmp_parse(const uint8_t *header, bmp_info_t *info) {
+    if (header[0] != 'B' || header[1] != 'M') return 0;
+
+    uint32_t info_size   = bmp_le32(header + 14);
+    int32_t  width       = (int32_t)bmp_le32(header + 18);
+    int32_t  height      = (int32_t)bmp_le32(header + 22);
+    uint16_t bpp         = bmp_le16(header + 28);
+    uint32_t compression = bmp_le32(header + 30);
+    uint32_t colors_used = bmp_le32(header + 46);
+
+    // BITMAPCOREHEADER (OS/2) не поддерживается
+    if (info_size < 40 || width <= 0 || height == 0) return 0;
+
+    memset(info, 0, sizeof(*info));
+    info->width    = (uint32_t)width;
+    info->top_down = (height < 0);
+    info->height   = (uint32_t)(height < 0 ? -height : height);
+
+    switch (bpp) {
+    case 24:
+        if (compression != BMP_BI_RGB) return 0;
+        info->format = BMP_FMT_RGB888;
+        break;
+
+    case 16:
+        if (compression == BMP_BI_RGB) {
+            info->format = BMP_FMT_RGB555;
+        } else if (compression == BMP_BI_BITFIELDS) {
+            // Маски лежат сразу за 40 байтами BITMAPINFOHEADER (в V4/V5 — там же)
+            uint32_t r = bmp_le32(header + 54);
+            uint32_t g = bmp_le32(header + 58);
+            uint32_t b = bmp_le32(header + 62);
+            if (r == 0xF800 && g == 0x07E0 && b == 0x001F) {
+                info->format = BMP_FMT_RGB565;
+            } else if (r == 0x7C00 && g == 0x03E0 && b == 0x001F) {
+                info->format = BMP_FMT_RGB555;
+            } else {
+                return 0;
+            }
+        } else {
+            return 0;
+        }
+        break;
+
+    case 8:
+        if (compression != BMP_BI_RGB || colors_used > 256) return 0;
+        info->format = BMP_FMT_PAL8;
+        info->palette_offset = 14 + info_size;
+        info->palette_size = colors_used ? (uint16_t)colors_used : 256;
+        break;
+
+    default:
+        return 0;
+    }
+
+    info->bytes_pp    = (uint8_t)(bpp / 8);
+    info->data_offset = bmp_le32(header + 10);
+    info->stride      = ((info->width * bpp + 31) / 32) * 4;
+    return 1;
+}
+
+/**
+ * @brief Вывод BMP на экран с отсечением по краям
+ * @param name имя файла
+ * @param x левый край на экране, может быть отрицательным
+ * @param y верхний край на экране, может быть отрицательным
+ * @return FR_OK при успехе (и если ничего не видно), FR_INVALID_OBJECT если
+ * формат не поддерживается
+ */
+FRESULT bmp_draw(const char *name, int16_t x, int16_t y) {
+    FIL *file = &work_area.bmp.file;
+    bmp_info_t info;
+
+    FRESULT res = bmp_open(file, name, &info);
+    if (res != FR_OK) return res;
+
+    // Видимая часть на экране
+    int32_t sx0 = (x < 0) ? 0 : x;
+    int32_t sy0 = (y < 0) ? 0 : y;
+    int32_t sx1 = x + (int32_t)info.width  - 1;
+    int32_t sy1 = y + (int32_t)info.height - 1;
+    if (sx1 >= ILI9225_maxX) sx1 = ILI9225_maxX - 1;
+    if (sy1 >= ILI9225_maxY) sy1 = ILI9225_maxY - 1;
+    if (sx0 > sx1 || sy0 > sy1) {
+        f_close(file);
+        return FR_OK;
+    }
+
+    uint16_t visible_w = (uint16_t)(sx1 - sx0 + 1);
+    uint32_t rows      = (uint32_t)(sy1 - sy0 + 1);
+    uint32_t col_skip  = (uint32_t)(sx0 - x);
+
+    // Файл всегда читается вперёд: снизу вверх — от нижней видимой строки
+    uint32_t first_row = bmp_file_row(&info, (uint32_t)((info.top_down ? sy0 : sy1) - y));
+    bmp_open_window(&info, sx0, sy0, sx1, sy1);
+
+    for (uint32_t r = 0; r < rows; r++) {
+        res = bmp_read_span(file, &info, first_row + r, col_skip, visible_w);
+        if (res != FR_OK) break;
+
+        // Строка r-2 из этого буфера уже ушла: её ждала передача r-1
+        uint16_t *line = work_area.bmp.line[r & 1];
+        bmp_convert(&info, work_area.bmp.raw, line, visible_w);
+        ILI9225_DMA_sendPixels(line, visible_w);
+    }
+
+    ILI9225_DMA_wait();
+    ILI9225_setScanOrder(ILI9225_SCAN_COLUMNS);
+    f_close(file);
+    return res;
+}
+
+/**
+ * @brief Уменьшение BMP на лету с выдачей строк в приёмник
+ * @param name имя файла
+ * @param w ширина рамки, в которую вписывается картинка
+ * @param h высота рамки
+ * @param mode BMP_SCALE_NEAREST или BMP_SCALE_BOX
+ * @param sink приёмник строк
+ * @return FR_OK при успехе, FR_INVALID_OBJECT если формат не поддерживается,
+ * FR_INVALID_PARAMETER если рамка пустая, либо ошибка приёмника
+ */
+FRESULT bmp_scale(const char *name, uint16_t w, uint16_t h, uint8_t mode, bmp_sink_t sink) {
+    FIL *file = &work_area.bmp.file;
+    uint16_t (*acc)[WORK_LINE_MAX] = work_area.bmp.acc;
+    bmp_info_t info;
+
+    if (w == 0 || h == 0) return FR_INVALID_PARAMETER;
+
+    FRESULT res = bmp_open(file, name, &info);
+    if (res != FR_OK) return res;
+
+    // Без таблицы (сильная фрагментация) перескоки идут по цепочке FAT — медленнее, но верно
+    file->cltbl = work_area.bmp.clmt;
+    work_area.bmp.clmt[0] = BMP_CLMT_LEN;
+    if (f_lseek(file, CREATE_LINKMAP) != FR_OK) file->cltbl = 0;
+
+    // Целый коэффициент для усреднения, иначе шаг 16.16; увеличения нет
+    uint32_t k = 1;
+    while (info.width > (uint32_t)w * k || info.height > (uint32_t)h * k) k++;
+    if (mode == BMP_SCALE_BOX && k > BMP_BOX_MAX) mode = BMP_SCALE_NEAREST;
+
+    uint32_t step, out_w, out_h;
+    if (mode == BMP_SCALE_BOX) {
+        step  = k << 16;
+        out_w = info.width / k;
+        out_h = info.height / k;
+    } else {
+        uint32_t sw = (uint32_t)(((uint64_t)info.width  << 16) / w);
+        uint32_t sh = (uint32_t)(((uint64_t)info.height << 16) / h);
+        step = (sw > sh) ? sw : sh;
+        if (step < 0x10000) step = 0x10000;
+        out_w = (uint32_t)(((uint64_t)info.width  << 16) / step);
+        out_h = (uint32_t)(((uint64_t)info.height << 16) / step);
+    }
+    if (out_w == 0) out_w = 1;
+    if (out_h == 0) out_h = 1;
+
+    bmp_scaled_t img = { (uint16_t)out_w, (uint16_t)out_h, (uint8_t)!info.top_down };
+
+    for (uint32_t i = 0; i < out_h && res == FR_OK; i++) {
+        // Строки картинки по порядку файла: снизу вверх — с нижней
+        uint32_t oy = info.top_down ? i : out_h - 1 - i;
+        uint16_t *line = work_area.bmp.line[i & 1];
+
+        if (mode == BMP_SCALE_BOX) {
+            memset(acc, 0, sizeof(work_area.bmp.acc));
+            for (uint32_t j = 0; j < k && res == FR_OK; j++) {
+                uint32_t row = bmp_file_row(&info, oy * k + (info.top_down ? j : k - 1 - j));
+                res = bmp_row_box_add(file, &info, row, (uint16_t)k, (uint16_t)out_w);
+            }
+
+            uint32_t area = k * k;
+            for (uint32_t ox = 0; ox < out_w; ox++) {
+                line[ox] = (uint16_t)(((acc[0][ox] / area) << 11) |
+                                      ((acc[1][ox] / area) << 5) |
+                                       (acc[2][ox] / area));
+            }
+        } else {
+            // Пропущенные строки не читаются: f_lseek по таблице кластеров
+            uint32_t sy = bmp_scale_src(oy, step);
+            if (sy >= info.height) sy = info.height - 1;
+            res = bmp_row_nearest(file, &info, bmp_file_row(&info, sy), step, (uint16_t)out_w, line);
+        }
+
+        if (res == FR_OK) res = sink(&img, i, line);
+    }
+
+    f_close(file);
+    return res;
+}
+
+/**
+ * @brief Вывод BMP, уменьшенного на лету до размеров прямоугольника
+ * @param name имя файла
+ * @param x левый край прямоугольника
+ * @param y верхний край прямоугольника
+ * @param w ширина прямоугольника
+ * @param h высота прямоугольника
+ * @param mode BMP_SCALE_NEAREST или BMP_SCALE_BOX
+ * @return FR_OK при успехе, FR_INVALID_OBJECT если формат не поддерживается,
+ * FR_INVALID_PARAMETER если прямоугольник пустой
+ */
+FRESULT bmp_draw_scaled(const char *name, int16_t x, int16_t y, uint16_t w, uint16_t h, uint8_t mode) {
+    // Прямоугольник обрезается по экрану заранее: уменьшенная картинка в него вписывается
+    int32_t rx0 = (x < 0) ? 0 : x;
+    int32_t ry0 = (y < 0) ? 0 : y;
+    int32_t rx1 = (int32_t)x + w - 1;
+    int32_t ry1 = (int32_t)y + h - 1;
+    if (rx1 >= ILI9225_maxX) rx1 = ILI9225_maxX - 1;
+    if (ry1 >= ILI9225_maxY) ry1 = ILI9225_maxY - 1;
+    if (rx0 > rx1 || ry0 > ry1) return FR_INVALID_PARAMETER;
+
+    bmp_box_x = (int16_t)rx0;
+    bmp_box_y = (int16_t)ry0;
+    bmp_box_w = (uint16_t)(rx1 - rx0 + 1);
+    bmp_box_h = (uint16_t)(ry1 - ry0 + 1);
+
+    FRESULT res = bmp_scale(name, bmp_box_w, bmp_box_h, mode, bmp_lcd_sink);
+
+    ILI9225_DMA_wait();
+    ILI9225_setScanOrder(ILI9225_SCAN_COLUMNS);
+    return res;
+}
@@ -0,0 +1,124 @@
+#ifndef BMP_H
+#define BMP_H
+
+#include <stdint.h>
+#include "ff.h"
+
+// -----------------------------------------------------------------------------
+// Конфигурация
+// -----------------------------------------------------------------------------
+
+// Сколько байт начала файла нужно bmp_parse(): заголовки + маски BI_BITFIELDS
+#define BMP_HEADER_READ  66
+
+// Форматы пикселей, которые умеет движок
+#define BMP_FMT_RGB888   0   // 24 бита, B G R
+#define BMP_FMT_RGB565   1   // 16 бит, BI_BITFIELDS 0xF800/0x07E0/0x001F
+#define BMP_FMT_RGB555   2   // 16 бит, BI_RGB или BI_BITFIELDS 0x7C00/0x03E0/0x001F
+#define BMP_FMT_PAL8     3   // 8 бит, палитра до 256 цветов
+
+// Способ уменьшения в bmp_draw_scaled()
+#define BMP_SCALE_NEAREST 0  // ближайший сосед, любой коэффициент
+#define BMP_SCALE_BOX     1  // среднее по блоку k x k, целый коэффициент
+
+// Больше — суммы по блоку не помещаются в 16 бит, тогда берётся ближайший сосед
+#define BMP_BOX_MAX       16
+
+// Таблица кластеров для быстрых перескоков через строки при уменьшении
+#define BMP_CLMT_LEN      32
+
+// -----------------------------------------------------------------------------
+// Типы данных
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    uint32_t width;
+    uint32_t height;
+    uint8_t  top_down;       // 1 — строки в файле сверху вниз (biHeight < 0)
+    uint8_t  format;         // BMP_FMT_*
+    uint8_t  bytes_pp;       // байт на пиксель в файле
+    uint32_t data_offset;    // bfOffBits
+    uint32_t stride;         // длина строки в файле с выравниванием до 4 байт
+    uint32_t palette_offset; // где в файле палитра (BMP_FMT_PAL8)
+    uint16_t palette_size;   // сколько в ней цветов
+} bmp_info_t;
+
+// Уменьшенная картинка, как её видит приёмник строк
+typedef struct {
+    uint16_t width;
+    uint16_t height;
+    uint8_t  bottom_up;      // 1 — строки выдаются снизу вверх (порядок файла)
+} bmp_scaled_t;
+
+/**
+ * @brief Приёмник строк уменьшенной картинки
+ * @param img размеры картинки и порядок строк
+ * @param row номер строки по порядку выдачи, 0 — первая
+ * @param line img->width пикселей RGB565; буфер не меняется до выдачи
+ * следующей строки после этой, так что его можно отдать DMA
+ * @return FR_OK, иначе уменьшение прерывается с этим кодом
+ */
+typedef FRESULT (*bmp_sink_t)(const bmp_scaled_t *img, uint32_t row, const uint16_t *line);
+
+// -----------------------------------------------------------------------------
+// Публичные функции
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Разбор заголовков BMP
+ * @param header первые BMP_HEADER_READ байт файла
+ * @param info куда положить параметры картинки
+ * @return 1 если формат поддерживается, 0 если нет
+ */
+uint8_t bmp_parse(const uint8_t *header, bmp_info_t *info);
+
+/**
+ * @brief Вывод BMP на экран с отсечением по краям
+ *
+ * Строки читаются по одной и только видимой частью; порядок строк в файле
+ * (снизу вверх или сверху вниз) задаётся направлением заполнения GRAM,
+ * без буферизации картинки. Пока строка уходит на дисплей DMA,
+ * следующая читается и переводится в RGB565.
+ * @param name имя файла
+ * @param x левый край на экране, может быть отрицательным
+ * @param y верхний край на экране, может быть отрицательным
+ * @return FR_OK при успехе (и если ничего не видно), FR_INVALID_OBJECT если
+ * формат не поддерживается
+ */
+FRESULT bmp_draw(const char *name, int16_t x, int16_t y);
+
+/**
+ * @brief Уменьшение BMP на лету с выдачей строк в приёмник
+ *
+ * Картинка вписывается в рамку w x h с сохранением пропорций, увеличения
+ * нет. Строки выдаются в порядке файла, чтобы файл читался только вперёд.
+ * @param name имя файла
+ * @param w ширина рамки
+ * @param h высота рамки
+ * @param mode BMP_SCALE_NEAREST или BMP_SCALE_BOX
+ * @param sink приёмник строк
+ * @return FR_OK при успехе, FR_INVALID_OBJECT если формат не поддерживается,
+ * FR_INVALID_PARAMETER если рамка пустая, либо ошибка приёмника
+ */
+FRESULT bmp_scale(const char *name, uint16_t w, uint16_t h, uint8_t mode, bmp_sink_t sink);
+
+/**
+ * @brief Вывод BMP, уменьшенного на лету до размеров прямоугольника
+ *
+ * Картинка вписывается в прямоугольник с сохранением пропорций и
+ * ставится по центру; увеличения нет. Ближайший сосед читает только
+ * нужные строки (перескок через f_lseek по таблице кластеров) и только
+ * куски строк с нужными пикселями. Усреднение читает блоки k строк
+ * и копит суммы по столбцам, целиком картинка в памяти не держится.
+ * @param name имя файла
+ * @param x левый край прямоугольника
+ * @param y верхний край прямоугольника
+ * @param w ширина прямоугольника
+ * @param h высота прямоугольника
+ * @param mode BMP_SCALE_NEAREST или BMP_SCALE_BOX
+ * @return FR_OK при успехе, FR_INVALID_OBJECT если формат не поддерживается,
+ * FR_INVALID_PARAMETER если прямоугольник пустой
+ */
+FRESULT bmp_draw_scaled(const char *name, int16_t x, int16_t y, uint16_t w, uint16_t h, uint8_t mode);
+
+#endif /* BMP_H */
@@ -9,8 +9,14 @@
  */
 
 #include "file_work.h"
+#include "img565.h"
+#include "qoi.h"
+#include "bmp.h"
 #include "ff.h"
 #include "USART.h"
+#include "TIMER.h"
+#include "diskcache.h"
+#include "work_area.h"
 #include <string.h>
 
 // -----------------------------------------------------------------------------
@@ -21,6 +27,13 @@ char file_list[MAX_FILES][FILENAME_LEN];
 uint8_t file_count = 0;
 FATFS fs;
 
+// Буферы картинок, конвейеров и f_mkfs (см. work_area.h)
+work_area_t work_area;
+
+// Конвейер SD -> LCD: буферы секторов и пикселей — в work_area.stream
+static uint8_t  stream_tail[3];      // пиксель, разрезанный границей сектора
+static uint8_t  stream_tail_len = 0;
+
 // -----------------------------------------------------------------------------
 // Внутренние функции
 // -----------------------------------------------------------------------------
@@ -39,6 +52,135 @@ static int ends_with(const char *str, const char *suffix) {
     return strncmp(str + len_str - len_suffix, suffix, len_suffix) == 0;
 }
 
+/**
+ * @brief Вывод числа в десятичном виде
+ */
+static void print_uint(uint32_t value) {
+    char buf[11];
+    uint8_t i = sizeof(buf) - 1;
+    buf[i] = '\0';
+    do {
+        buf[--i] = '0' + (value % 10);
+        value /= 10;
+    } while (value);
+    uart_puts(&buf[i]);
+}
+
+/**
+ * @brief Вывод счётчиков кэша секторов и упреждающего чтения
+ */
+static void print_disk_stats(void) {
+    disk_cache_stats_t st;
+    disk_cache_get_stats(&st);
+    uart_puts("Cache: hits ");
+    print_uint(st.hits);
+    uart_puts(", misses ");
+    print_uint(st.misses);
+    uart_puts("; prefetch: hits ");
+    print_uint(st.pf_hits);
+    uart_puts("/");
+    print_uint(st.pf_issued);
+    uart_puts(", stall us ");
+    print_uint(st.pf_stall_us);
+    uart_puts("\r\n");
+}
+
+/**
+ * @brief Вывод ёмкости карты и блока стирания
+ */
+static void print_card_info(void) {
+    const SD_CardInfo *card = sd_card_info();
+    uart_puts("Card: ");
+    print_uint(card->sectors / 2048);
+    if (card->type & SD_TYPE_BLOCK)     uart_puts(" MB SDHC/SDXC");
+    else if (card->type & SD_TYPE_SD2)  uart_puts(" MB SDv2 SDSC");
+    else                                uart_puts(" MB SDv1");
+    uart_puts(", erase block ");
+    print_uint(card->erase_block / 2);
+    uart_puts(" KB\r\n");
+}
+
+/**
+ * @brief Один пиксель BMP (B, G, R) в RGB565
+ */
+static inline uint16_t stream_bgr(const uint8_t *p) {
+    uint32_t color = ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | p[0];
+    return (uint16_t)(RGB888_RGB565(color));
+}
+
+/**
+ * @brief Перевод куска сектора в RGB565 с переносом хвоста между секторами
+ * @return количество готовых пикселей в dst
+ */
+static uint16_t stream_convert(const uint8_t *src, uint16_t len, uint16_t *dst) {
+    uint16_t n = 0;
+
+    // Дописываем пиксель, начатый в прошлом секторе
+    while (stream_tail_len && len) {
+        stream_tail[stream_tail_len++] = *src++;
+        len--;
+        if (stream_tail_len == 3) {
+            dst[n++] = stream_bgr(stream_tail);
+            stream_tail_len = 0;
+        }
+    }
+
+    for (; len >= 3; len -= 3, src += 3) {
+        dst[n++] = stream_bgr(src);
+    }
+
+    while (len--) stream_tail[stream_tail_len++] = *src++;
+    return n;
+}
+
+/**
+ * @brief Открытие файла и построение таблицы кластеров для чтения секторов напрямую
+ * @param header куда прочитать начало файла
+ * @param header_len сколько байт заголовка нужно
+ */
+static FRESULT stream_open(FIL *fp, DWORD *clmt, const char *name, uint8_t *header, UINT header_len) {
+    UINT bytes_read;
+    FRESULT res = f_open(fp, name, FA_READ);
+    if (res != FR_OK) return res;
+
+    res = f_read(fp, header, header_len, &bytes_read);
+    if (res == FR_OK && bytes_read != header_len) res = FR_INT_ERR;
+
+    // Таблица кластеров: дальше FatFS не нужна, сектора читаются напрямую
+    if (res == FR_OK) {
+        fp->cltbl = clmt;
+        clmt[0] = STREAM_CLMT_LEN;
+        res = f_lseek(fp, CREATE_LINKMAP);
+    }
+    if (res != FR_OK) f_close(fp);
+
+    // SPI1 переходит к конвейеру: упреждающее чтение diskio должно отпустить шину
+    disk_prefetch_stop();
+    return res;
+}
+
+/**
+ * @brief Номер сектора на карте для смещения в файле по таблице кластеров
+ * @return номер сектора или 0 если смещение за пределами таблицы
+ */
+static LBA_t stream_sector(FIL *fp, FSIZE_t ofs) {
+    FATFS *f = fp->obj.fs;
+    DWORD sect = (DWORD)(ofs / STREAM_SECTOR);
+    DWORD cl = sect / f->csize;
+    DWORD *tbl = fp->cltbl + 1;
+
+    // Пары (длина фрагмента, первый кластер), в конце 0
+    for (;;) {
+        DWORD ncl = *tbl++;
+        if (ncl == 0) return 0;
+        if (cl < ncl) break;
+        cl -= ncl;
+        tbl++;
+    }
+
+    return f->database + (LBA_t)f->csize * (*tbl + cl - 2) + sect % f->csize;
+}
+
 // -----------------------------------------------------------------------------
 // Публичные функции
 // -----------------------------------------------------------------------------
@@ -52,20 +194,23 @@ static int ends_with(const char *str, const char *suffix) {
  */
 FRESULT filesystem_init(void) {
     FRESULT res = f_mount(&fs, "", 1);
+    if (sd_card_info()->sectors) print_card_info();
 
     if (res == FR_NOT_READY || res == FR_NO_FILESYSTEM || res == FR_INVALID_PARAMETER) {
         uart_puts("Formatting card...\r\n");
 
+        // Тип FAT и кластер f_mkfs подбирает по ёмкости карты,
+        // align = 0 — выравнивание по блоку стирания из disk_ioctl
         static MKFS_PARM mkfs_opt = {
-            .fmt = FM_FAT32,
+            .fmt = FM_FAT | FM_FAT32,
             .n_fat = 1,
             .align = 0,
             .n_root = 512,
             .au_size = 0
         };
-        static uint8_t work[4096];
-
-        res = f_mkfs("", &mkfs_opt, work, sizeof(work));
+        // Рабочий буфер — общая work_area: до монтирования картинки не рисуются.
+        // 4 КБ — f_mkfs пишет таблицы FAT пачками по 8 секторов (CMD25)
+        res = f_mkfs("", &mkfs_opt, work_area.mkfs, sizeof(work_area.mkfs));
         if (res != FR_OK) {
             return res;
             uart_puts("Formatting failed...\r\n");
@@ -77,6 +222,9 @@ FRESULT filesystem_init(void) {
         res = f_mount(&fs, "", 1);
     }
 
+    // FAT читается при каждом переходе по цепочке кластеров — держим её в кэше
+    if (res == FR_OK) disk_cache_pin(fs.fatbase, (LBA_t)fs.fsize * fs.n_fats);
+
     return res;
 }
 
@@ -173,6 +321,7 @@ void list_files(const char *suffix) {
     uart_puts(":\r\n");
 
     // Читаем записи по одной
+    disk_cache_clear_stats();
     while (1) {
         res = f_readdir(&dir, &fno);
         if (res != FR_OK || fno.fname[0] == 0) {break; uart_puts("not files\r\n");}
@@ -185,6 +334,9 @@ void list_files(const char *suffix) {
         }
     }
     f_closedir(&dir);
+
+    // Сколько секторов каталога и FAT нашлось в кэше
+    print_disk_stats();
 }
 
 /**
@@ -235,45 +387,198 @@ void print_file_list(void) {
 /**
  * @brief Чтение из файла картинки и вывод ее на экран LCD
  * @param suffix название файла для открытия
- * @param buffer буфер для хранения части открытого файла 
- * для последующей передаче его на экран
  */
-void file_read(const char *suffix, uint8_t *buffer, uint16_t len_b) {
-    FIL file;
-    FRESULT res = f_open(&file, suffix, FA_READ);
-    if (res != FR_OK) {
-        uart_puts("f_open read failed: ");
-        print_hex(res);
+void file_read(const char *suffix) {
+    // Сжатые картинки декодируются потоком, буфер не нужен
+    if (ends_with(suffix, ".qoi") || ends_with(suffix, ".QOI")) {
+        uint32_t t_start = get_ms();
+        FRESULT res = qoi_draw(suffix, 0, 0);
+        uart_puts("QOI ");
+        uart_puts(suffix);
+        uart_puts(res == FR_OK ? ": ok" : ": error");
+        uart_puts(", мс = ");
+        print_uint(get_ms() - t_start);
         uart_puts("\r\n");
         return;
     }
-    UINT bytes_read;
 
-  
-    //uart_puts("Читаем заголовок файла длиною 54 байта\r\n");
-    uint8_t header[54];
-    res = f_read(&file, header, 54, &bytes_read);
-    uint32_t width =  header[18] | (header[19] << 8) | (header[20] << 16) | (header[21] << 24);
-    uint32_t height = header[22] | (header[23] << 8) | (header[24] << 16) | (header[25] << 24);
-    uart_puts("BMP:");
-    uart_puts("\r\nширина = ");
-    print_hex(width);
-    uart_puts("\r\nВысота = ");
-    print_hex(height);
+    // Быстрый путь: 24-битный BMP ровно во весь экран
+    if (file_stream_image(suffix) == FR_OK) return;
+
+    // Остальные BMP: любая глубина цвета и порядок строк. Больше экрана —
+    // уменьшаются на лету и ставятся по центру. Строки читаются движком
+    // bmp.c в свои буферы
+    disk_cache_clear_stats();
+    uint32_t t_start = get_ms();
+    FRESULT res = bmp_draw_scaled(suffix, 0, 0, ILI9225_maxX, ILI9225_maxY, BMP_SCALE_BOX);
+    uart_puts("BMP ");
+    uart_puts(suffix);
+    if (res == FR_OK) {
+        uart_puts(": ok");
+    } else {
+        uart_puts(": error ");
+        print_hex(res);
+    }
+    uart_puts(", мс = ");
+    print_uint(get_ms() - t_start);
     uart_puts("\r\n");
-    ILI9225_setWindow(0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1);
+    print_disk_stats();
+}
+
+/**
+ * @brief Вывод BMP (BGR888) на весь экран конвейером без промежуточных копий
+ * @param name имя файла
+ * @return FR_OK при успехе, FR_INVALID_OBJECT если это не 24-битный BMP
+ * размером с экран, FR_NOT_ENOUGH_CORE если файл слишком фрагментирован
+ */
+FRESULT file_stream_image(const char *name) {
+    uint32_t t_start = get_ms();
+    uint8_t header[BMP_HEADER_READ];
+    bmp_info_t info;
+    FIL *file = &work_area.stream.file;
+    uint16_t (*sd)[STREAM_SECTOR / 2] = work_area.stream.sd;
+    uint16_t (*px)[STREAM_PIXELS] = work_area.stream.px;
+
+    FRESULT res = stream_open(file, work_area.stream.clmt, name, header, sizeof(header));
+    if (res != FR_OK) return res;
+
+    // Сектора идут на экран подряд, поэтому строки без выравнивания
+    // и ровно по размеру экрана; остальное рисует bmp_draw()
+    if (!bmp_parse(header, &info) || info.format != BMP_FMT_RGB888 ||
+        info.width != ILI9225_maxX || info.height != ILI9225_maxY ||
+        info.stride != info.width * 3) {
+        f_close(file);
+        return FR_INVALID_OBJECT;
+    }
+
+    uint32_t data_ofs = info.data_offset;
+    uint32_t data_end = data_ofs + info.stride * info.height;
+    if (f_size(file) < data_end) {
+        f_close(file);
+        return FR_INT_ERR;
+    }
+
+    uint32_t first = data_ofs / STREAM_SECTOR;
+    uint32_t last  = (data_end - 1) / STREAM_SECTOR;
+    stream_tail_len = 0;
+
+    // Порядок строк в файле задаётся направлением заполнения GRAM
+    ILI9225_setScanOrder(info.top_down ? ILI9225_SCAN_ROWS : ILI9225_SCAN_ROWS_UP);
+    ILI9225_setWindow(0, 0, ILI9225_maxX - 1, ILI9225_maxY - 1);
+    if (!info.top_down) ILI9225_setCursor(0, ILI9225_maxY - 1);
     ILI9225_writeIndex(GRAM_DATA_REG);
-	LCD_CS.activate();
-    
-    //uart_puts("Читаем файл кусками по 3300 байтов\r\n");
-    //uart_puts("3300 байтов это 5 строчек по 220 пикселей (3 байта на пиксель)\r\n");
-    while (1) {
-        res = f_read(&file, buffer, len_b, &bytes_read);
-        if (res != FR_OK || bytes_read == 0) break;
-        ILI9225_Draw_File(buffer, len_b);
+
+    LBA_t sector = stream_sector(file, (FSIZE_t)first * STREAM_SECTOR);
+    SD_Status st = sector ? SD_ReadBlockStart(sector, (uint8_t *)sd[0]) : SD_ERROR;
+
+    for (uint32_t k = first; st == SD_OK && k <= last; k++) {
+        uint8_t cur = (k - first) & 1;
+
+        st = SD_ReadBlockFinish();
+        if (st != SD_OK) break;
+
+        // Стадия 1: следующий сектор читается DMA по SPI1, пока CPU занят этим
+        if (k < last) {
+            sector = stream_sector(file, (FSIZE_t)(k + 1) * STREAM_SECTOR);
+            st = sector ? SD_ReadBlockStart(sector, (uint8_t *)sd[cur ^ 1]) : SD_ERROR;
+        }
+
+        // Стадия 2: перевод в RGB565. px[cur] свободен: его передача
+        // (k-2) закончилась до запуска передачи k-1
+        uint32_t base = k * STREAM_SECTOR;
+        uint16_t from = (base < data_ofs) ? (uint16_t)(data_ofs - base) : 0;
+        uint16_t to   = (data_end - base < STREAM_SECTOR) ? (uint16_t)(data_end - base) : STREAM_SECTOR;
+        uint16_t n = stream_convert((uint8_t *)sd[cur] + from, to - from, px[cur]);
+
+        // Стадия 3: передача на дисплей по SPI2 (ждёт только предыдущую)
+        ILI9225_DMA_sendPixels(px[cur], n);
     }
 
-    f_close(&file);
+    ILI9225_DMA_wait();
+    ILI9225_setScanOrder(ILI9225_SCAN_COLUMNS);
+    f_close(file);
 
-    uart_puts("\r\n--- End of file ---\r\n");
-}
\ No newline at end of file
+    uart_puts("Stream ");
+    uart_puts(name);
+    uart_puts(st == SD_OK ? ": ok" : ": SD error");
+    uart_puts(", мс = ");
+    print_uint(get_ms() - t_start);
+    uart_puts("\r\n");
+
+    return (st == SD_OK) ? FR_OK : FR_DISK_ERR;
+}
+/**
+ * @brief Вывод картинки .565 (см. img565.h) сектор за сектором без обработки пикселей
+ * @param name имя файла
+ * @param x левый край на экране
+ * @param y верхний край на экране
+ * @return FR_OK при успехе, FR_INVALID_OBJECT если файл не .565 или
+ * записан для другой ориентации, FR_INVALID_PARAMETER если не влезает в экран
+ */
+FRESULT file_blit_565(const char *name, uint16_t x, uint16_t y) {
+    uint32_t t_start = get_ms();
+    uint8_t header[IMG565_HEADER_SIZE];
+    img565_header_t img = {0};
+    FIL *file = &work_area.stream.file;
+    uint16_t (*sd)[STREAM_SECTOR / 2] = work_area.stream.sd;
+
+    FRESULT res = stream_open(file, work_area.stream.clmt, name, header, sizeof(header));
+    if (res != FR_OK) return res;
+
+    if (!img565_parse(header, &img) ||
+        (img.orientation != IMG565_ANY_ORIENTATION && img.orientation != ILI9225_orientation)) {
+        res = FR_INVALID_OBJECT;
+    } else if ((uint32_t)x + img.width > ILI9225_maxX || (uint32_t)y + img.height > ILI9225_maxY) {
+        res = FR_INVALID_PARAMETER;
+    }
+
+    uint32_t data_ofs = img.data_offset;
+    uint32_t data_end = data_ofs + (uint32_t)img.width * img.height * 2;
+    if (res == FR_OK && f_size(file) < data_end) res = FR_INT_ERR;
+    if (res != FR_OK) {
+        f_close(file);
+        return res;
+    }
+
+    uint32_t first = data_ofs / STREAM_SECTOR;
+    uint32_t last  = (data_end - 1) / STREAM_SECTOR;
+
+    ILI9225_setWindow(x, y, x + img.width - 1, y + img.height - 1);
+    ILI9225_writeIndex(GRAM_DATA_REG);
+
+    LBA_t sector = stream_sector(file, (FSIZE_t)first * STREAM_SECTOR);
+    SD_Status st = sector ? SD_ReadBlockStart(sector, (uint8_t *)sd[0]) : SD_ERROR;
+
+    for (uint32_t k = first; st == SD_OK && k <= last; k++) {
+        uint8_t cur = (k - first) & 1;
+
+        st = SD_ReadBlockFinish();
+        if (st != SD_OK) break;
+
+        // Второй буфер ещё может уходить на дисплей (сектор k-1) — дождаться,
+        // и только потом отдавать его под чтение сектора k+1
+        if (k < last) {
+            ILI9225_DMA_wait();
+            sector = stream_sector(file, (FSIZE_t)(k + 1) * STREAM_SECTOR);
+            st = sector ? SD_ReadBlockStart(sector, (uint8_t *)sd[cur ^ 1]) : SD_ERROR;
+        }
+
+        // Сектор уже в формате GRAM: только отрезать заголовок и хвост файла
+        uint32_t base = k * STREAM_SECTOR;
+        uint16_t from = (base < data_ofs) ? (uint16_t)(data_ofs - base) : 0;
+        uint16_t to   = (data_end - base < STREAM_SECTOR) ? (uint16_t)(data_end - base) : STREAM_SECTOR;
+        ILI9225_DMA_sendPixels(sd[cur] + from / 2, (to - from) / 2);
+    }
+
+    ILI9225_DMA_wait();
+    f_close(file);
+
+    uart_puts("Blit ");
+    uart_puts(name);
+    uart_puts(st == SD_OK ? ": ok" : ": SD error");
+    uart_puts(", мс = ");
+    print_uint(get_ms() - t_start);
+    uart_puts("\r\n");
+
+    return (st == SD_OK) ? FR_OK : FR_DISK_ERR;
+}
@@ -16,6 +16,13 @@
 #define MAX_FILES     10
 #define FILENAME_LEN  23  // 8.3 формат: "FILENAME.TXT" = 12 + 1
 
+// Таблица связей кластеров для конвейера SD -> LCD (2 слова на фрагмент + 2)
+#define STREAM_CLMT_LEN  32
+
+// Конвейер SD -> LCD работает посекторно
+#define STREAM_SECTOR    512
+#define STREAM_PIXELS    (STREAM_SECTOR / 3 + 1)   // с учётом хвоста прошлого сектора
+
 // -----------------------------------------------------------------------------
 // Глобальные переменные
 // -----------------------------------------------------------------------------
@@ -65,10 +72,35 @@ void print_file_list(void);
 
 /**
  * @brief Чтение из файла картинки и вывод ее на экран LCD
+ * Файлы .qoi декодируются потоком (qoi_draw), BMP размером с экран идут
+ * конвейером file_stream_image(), остальные — через bmp_draw()
  * @param suffix название файла для открытия
- * @param buffer буфер для хранения части открытого файла 
- * для последующей передаче его на экран
  */
-void file_read(const char *suffix, uint8_t *buffer, uint16_t len_b);
+void file_read(const char *suffix);
+
+/**
+ * @brief Вывод BMP (BGR888) на весь экран конвейером без промежуточных копий
+ *
+ * Одновременно: сектор N+1 читается с SD (DMA, SPI1), сектор N
+ * переводится в RGB565, сектор N-1 уходит на дисплей (DMA, SPI2).
+ * Сектора берутся напрямую с карты по таблице кластеров (fast seek).
+ * @param name имя файла
+ * @return FR_OK при успехе, FR_INVALID_OBJECT если это не 24-битный BMP
+ * размером с экран, FR_NOT_ENOUGH_CORE если файл слишком фрагментирован
+ */
+FRESULT file_stream_image(const char *name);
+
+/**
+ * @brief Вывод картинки .565 (см. img565.h) сектор за сектором без обработки пикселей
+ *
+ * Пиксели в файле уже лежат в порядке и формате GRAM, поэтому сектор
+ * уходит на дисплей DMA прямо из буфера чтения, пока следующий читается с SD.
+ * @param name имя файла
+ * @param x левый край на экране
+ * @param y верхний край на экране
+ * @return FR_OK при успехе, FR_INVALID_OBJECT если файл не .565 или
+ * записан для другой ориентации, FR_INVALID_PARAMETER если не влезает в экран
+ */
+FRESULT file_blit_565(const char *name, uint16_t x, uint16_t y);
 
 #endif
\ No newline at end of file
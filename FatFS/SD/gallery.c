@@ -0,0 +1,270 @@
+/**
+ * @file gallery.c
+ * @brief Галерея: сетка миниатюр с кэшем на SD-карте
+ *
+ * Кэш — массив записей по GALLERY_RECORD байт, запись N — миниатюра
+ * N-й картинки BMP в каталоге. Запись: заголовок gallery_record_t,
+ * сразу за ним пиксели RGB565 в порядке строк исходного файла.
+ * Заголовок пишется последним, так что недописанная запись не пройдёт
+ * проверку и будет построена заново.
+ */
+
+#include "gallery.h"
+#include "bmp.h"
+#include "ILI9225.h"
+#include "work_area.h"
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+// Формат кэша
+// -----------------------------------------------------------------------------
+
+#define GALLERY_MAGIC     "THM1"
+
+typedef struct {
+    char     magic[4];
+    uint32_t fsize;        // ключ: размер исходника
+    uint16_t fdate;        // ключ: дата и время изменения исходника
+    uint16_t ftime;
+    uint16_t width;        // 0 — миниатюры нет (формат не поддерживается)
+    uint16_t height;
+    uint8_t  bottom_up;    // строки записаны снизу вверх
+    uint8_t  reserved[3];
+    char     name[GALLERY_NAME_LEN];
+} gallery_record_t;        // 48 байт, пиксели идут с выравниванием на 2
+
+#define GALLERY_RECORD  (((sizeof(gallery_record_t) + GALLERY_THUMB * GALLERY_THUMB * 2) \
+                          + GALLERY_SECTOR - 1) / GALLERY_SECTOR * GALLERY_SECTOR)
+
+// -----------------------------------------------------------------------------
+// Внутренние переменные
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    char     name[GALLERY_NAME_LEN];
+    uint32_t fsize;
+    uint16_t fdate;
+    uint16_t ftime;
+} gallery_entry_t;
+
+static gallery_entry_t gallery_page[GALLERY_PAGE];
+static uint8_t         gallery_count = 0;
+
+static FIL              gallery_cache;
+static gallery_record_t gallery_rec;        // запись, которую строит gallery_build()
+static FSIZE_t          gallery_pixels;     // куда пишет gallery_sink()
+
+// -----------------------------------------------------------------------------
+// Внутренние функции
+// -----------------------------------------------------------------------------
+
+static int gallery_is_bmp(const char *name) {
+    size_t len = strlen(name);
+    return len > 4 && (strcmp(name + len - 4, ".bmp") == 0 || strcmp(name + len - 4, ".BMP") == 0);
+}
+
+/**
+ * @brief Картинки страницы page в порядке каталога
+ * @return FR_OK, gallery_page и gallery_count заполнены
+ */
+static FRESULT gallery_scan(uint16_t page) {
+    uint32_t first = (uint32_t)page * GALLERY_PAGE;
+    uint32_t index = 0;
+    DIR *dir = &work_area.gallery_scan.dir;
+    FILINFO *fno = &work_area.gallery_scan.fno;
+
+    gallery_count = 0;
+    FRESULT res = f_opendir(dir, "/");
+    if (res != FR_OK) return res;
+
+    while (gallery_count < GALLERY_PAGE) {
+        res = f_readdir(dir, fno);
+        if (res != FR_OK || fno->fname[0] == 0) break;
+        if (fno->fattrib & (AM_DIR | AM_HID | AM_SYS)) continue;
+        if (!gallery_is_bmp(fno->fname) || strlen(fno->fname) >= GALLERY_NAME_LEN) continue;
+
+        if (index++ < first) continue;
+
+        gallery_entry_t *e = &gallery_page[gallery_count++];
+        strcpy(e->name, fno->fname);
+        e->fsize = (uint32_t)fno->fsize;
+        e->fdate = fno->fdate;
+        e->ftime = fno->ftime;
+    }
+    f_closedir(dir);
+    return res;
+}
+
+static int gallery_key_match(const gallery_record_t *rec, const gallery_entry_t *e) {
+    return memcmp(rec->magic, GALLERY_MAGIC, 4) == 0 &&
+           rec->fsize == e->fsize && rec->fdate == e->fdate && rec->ftime == e->ftime &&
+           strncmp(rec->name, e->name, GALLERY_NAME_LEN) == 0;
+}
+
+/**
+ * @brief Приёмник bmp_scale(): строки подряд в запись кэша
+ */
+static FRESULT gallery_sink(const bmp_scaled_t *img, uint32_t row, const uint16_t *line) {
+    UINT written;
+    FRESULT res = FR_OK;
+
+    if (row == 0) res = f_lseek(&gallery_cache, gallery_pixels);
+    if (res == FR_OK) res = f_write(&gallery_cache, line, img->width * 2u, &written);
+    if (res == FR_OK && written != img->width * 2u) res = FR_DENIED;   // карта заполнена
+    if (res == FR_OK && row == 0) {
+        // Размеры нужны заголовку, а он пишется после пикселей
+        gallery_rec.width     = img->width;
+        gallery_rec.height    = img->height;
+        gallery_rec.bottom_up = img->bottom_up;
+    }
+    return res;
+}
+
+/**
+ * @brief Построение миниатюры в запись slot кэша
+ */
+static FRESULT gallery_build(uint32_t slot, const gallery_entry_t *e) {
+    FSIZE_t base = (FSIZE_t)slot * GALLERY_RECORD;
+    gallery_record_t *rec = &gallery_rec;
+    UINT written;
+
+    memset(rec, 0, sizeof(*rec));
+    gallery_pixels = base + sizeof(gallery_record_t);
+
+    // Неподдерживаемый BMP тоже запоминается — как запись без миниатюры
+    FRESULT res = bmp_scale(e->name, GALLERY_THUMB, GALLERY_THUMB, BMP_SCALE_BOX, gallery_sink);
+    if (res == FR_INVALID_OBJECT) {
+        rec->width = rec->height = 0;
+        res = FR_OK;
+    }
+    if (res != FR_OK) return res;
+
+    memcpy(rec->magic, GALLERY_MAGIC, 4);
+    rec->fsize = e->fsize;
+    rec->fdate = e->fdate;
+    rec->ftime = e->ftime;
+    strncpy(rec->name, e->name, GALLERY_NAME_LEN);
+
+    res = f_lseek(&gallery_cache, base);
+    if (res == FR_OK) res = f_write(&gallery_cache, rec, sizeof(*rec), &written);
+    if (res == FR_OK && written != sizeof(*rec)) res = FR_DENIED;
+    return res;
+}
+
+/**
+ * @brief Вывод записи кэша в ячейку; запись читается посекторно,
+ * пока один сектор уходит на дисплей, следующий читается с карты
+ */
+static FRESULT gallery_show(uint32_t slot, uint16_t cx, uint16_t cy, uint16_t cw, uint16_t ch) {
+    FSIZE_t base = (FSIZE_t)slot * GALLERY_RECORD;
+    gallery_record_t rec;
+    UINT bytes_read;
+
+    // Прошлая ячейка может ещё уходить из любого буфера
+    ILI9225_DMA_wait();
+
+    FRESULT res = f_lseek(&gallery_cache, base);
+    if (res == FR_OK) res = f_read(&gallery_cache, work_area.gallery_sd[0], GALLERY_SECTOR, &bytes_read);
+    if (res == FR_OK && bytes_read < sizeof(rec)) res = FR_INT_ERR;
+    if (res != FR_OK) return res;
+    memcpy(&rec, work_area.gallery_sd[0], sizeof(rec));
+
+    if (rec.width == 0 || rec.width > cw || rec.height > ch) {
+        ILI9225_fillRect(cx + (cw - GALLERY_THUMB) / 2, cy + (ch - GALLERY_THUMB) / 2,
+                         GALLERY_THUMB, GALLERY_THUMB, COLOR_GRAY);
+        return FR_OK;
+    }
+
+    uint16_t x0 = cx + (cw - rec.width) / 2;
+    uint16_t y0 = cy + (ch - rec.height) / 2;
+    ILI9225_setScanOrder(rec.bottom_up ? ILI9225_SCAN_ROWS_UP : ILI9225_SCAN_ROWS);
+    ILI9225_setWindow(x0, y0, x0 + rec.width - 1, y0 + rec.height - 1);
+    if (rec.bottom_up) ILI9225_setCursor(x0, y0 + rec.height - 1);
+    ILI9225_writeIndex(GRAM_DATA_REG);
+
+    uint32_t left = (uint32_t)rec.width * rec.height * 2;
+    uint32_t from = sizeof(gallery_record_t);
+    uint8_t  cur  = 0;
+
+    while (left) {
+        uint32_t n = GALLERY_SECTOR - from;
+        if (n > left) n = left;
+        ILI9225_DMA_sendPixels(work_area.gallery_sd[cur] + from / 2, n / 2);
+        left -= n;
+        from = 0;
+        cur ^= 1;
+
+        // Буфер cur ушёл на дисплей ещё до передачи, запущенной выше
+        if (left) {
+            res = f_read(&gallery_cache, work_area.gallery_sd[cur], GALLERY_SECTOR, &bytes_read);
+            if (res == FR_OK && bytes_read < GALLERY_SECTOR && bytes_read < left) res = FR_INT_ERR;
+            if (res != FR_OK) break;
+        }
+    }
+    return res;
+}
+
+// -----------------------------------------------------------------------------
+// Публичные функции
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Вывод страницы галереи: сетка миниатюр BMP из корня карты
+ * @param page номер страницы, с 0
+ * @param count куда положить число картинок на странице (может быть NULL)
+ * @return FR_OK при успехе, иначе код ошибки FatFS
+ */
+FRESULT gallery_draw(uint16_t page, uint8_t *count) {
+    gallery_record_t rec;
+    UINT bytes_read;
+
+    FRESULT res = gallery_scan(page);
+    if (count) *count = gallery_count;
+    if (res != FR_OK) return res;
+
+    res = f_open(&gallery_cache, GALLERY_CACHE_NAME, FA_READ | FA_WRITE | FA_OPEN_ALWAYS);
+    if (res != FR_OK) return res;
+    uint8_t created = (f_size(&gallery_cache) == 0);
+
+    // Сначала проверка ключей: устаревшие и новые записи строятся заново
+    uint32_t first = (uint32_t)page * GALLERY_PAGE;
+    uint8_t built = 0;
+    for (uint8_t i = 0; i < gallery_count && res == FR_OK; i++) {
+        FSIZE_t base = (FSIZE_t)(first + i) * GALLERY_RECORD;
+
+        memset(&rec, 0, sizeof(rec));
+        if (base + sizeof(rec) <= f_size(&gallery_cache)) {
+            res = f_lseek(&gallery_cache, base);
+            if (res == FR_OK) res = f_read(&gallery_cache, &rec, sizeof(rec), &bytes_read);
+        }
+        if (res == FR_OK && !gallery_key_match(&rec, &gallery_page[i])) {
+            res = gallery_build(first + i, &gallery_page[i]);
+            built = 1;
+        }
+    }
+    if (res == FR_OK && built) res = f_sync(&gallery_cache);
+
+    // Затем вся страница одним проходом по кэшу
+    uint16_t cw = ILI9225_maxX / GALLERY_COLS;
+    uint16_t ch = ILI9225_maxY / GALLERY_ROWS;
+    if (res == FR_OK) ILI9225_clear();
+    for (uint8_t i = 0; i < gallery_count && res == FR_OK; i++) {
+        res = gallery_show(first + i, (i % GALLERY_COLS) * cw, (i / GALLERY_COLS) * ch, cw, ch);
+    }
+
+    ILI9225_DMA_wait();
+    ILI9225_setScanOrder(ILI9225_SCAN_COLUMNS);
+    f_close(&gallery_cache);
+
+    if (created) f_chmod(GALLERY_CACHE_NAME, AM_HID | AM_SYS, AM_HID | AM_SYS);
+    return res;
+}
+
+/**
+ * @brief Имя файла в ячейке последней выведенной страницы
+ * @param slot номер ячейки, 0 — левая верхняя
+ * @return имя или NULL, если ячейка пустая
+ */
+const char *gallery_name(uint8_t slot) {
+    return (slot < gallery_count) ? gallery_page[slot].name : 0;
+}
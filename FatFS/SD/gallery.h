@@ -0,0 +1,53 @@
+#ifndef GALLERY_H
+#define GALLERY_H
+
+#include <stdint.h>
+#include "ff.h"
+
+// -----------------------------------------------------------------------------
+// Конфигурация
+// -----------------------------------------------------------------------------
+
+// Скрытый файл с миниатюрами в корне карты
+#define GALLERY_CACHE_NAME  "THUMBS.DAT"
+
+// Сетка на странице
+#define GALLERY_COLS        3
+#define GALLERY_ROWS        4
+#define GALLERY_PAGE        (GALLERY_COLS * GALLERY_ROWS)
+
+// Рамка миниатюры: влезает в ячейку и в портретной (58x55), и в альбомной (73x44)
+#define GALLERY_THUMB       40
+
+// Имена длиннее (GALLERY_NAME_LEN - 1) в галерею не попадают
+#define GALLERY_NAME_LEN    28
+
+// Запись кэша выровнена по сектору и читается посекторно
+#define GALLERY_SECTOR      512
+
+// -----------------------------------------------------------------------------
+// Публичные функции
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Вывод страницы галереи: сетка миниатюр BMP из корня карты
+ *
+ * Миниатюры RGB565 строятся один раз (bmp_scale, усреднение блоков) и
+ * лежат в GALLERY_CACHE_NAME по записи на картинку; запись выровнена по
+ * сектору, записи страницы идут подряд, поэтому вывод страницы — одно
+ * последовательное чтение. Запись хранит имя, размер и время изменения
+ * исходника: если они не совпали, миниатюра строится заново.
+ * @param page номер страницы, с 0
+ * @param count куда положить число картинок на странице (может быть NULL)
+ * @return FR_OK при успехе, иначе код ошибки FatFS
+ */
+FRESULT gallery_draw(uint16_t page, uint8_t *count);
+
+/**
+ * @brief Имя файла в ячейке последней выведенной страницы
+ * @param slot номер ячейки, 0 — левая верхняя
+ * @return имя или NULL, если ячейка пустая
+ */
+const char *gallery_name(uint8_t slot);
+
+#endif /* GALLERY_H */
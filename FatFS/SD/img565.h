@@ -0,0 +1,87 @@
+#ifndef IMG565_H
+#define IMG565_H
+
+/**
+ * @file img565.h
+ * @brief Формат картинок .565 — готовый поток пикселей для GRAM
+ *
+ * Общий для прошивки (file_work.c) и конвертера tools/bmp2565.c.
+ *
+ * Заголовок, 16 байт, все поля little-endian:
+ *   0  "R565"       сигнатура
+ *   4  uint16       ширина
+ *   6  uint16       высота
+ *   8  uint8        ориентация дисплея 0..3, IMG565_ANY_ORIENTATION — любая
+ *   9  uint8        флаги IMG565_FLAG_*
+ *   10 uint16       резерв (0)
+ *   12 uint32       смещение пикселей от начала файла (чётное)
+ *
+ * Пиксели: RGB565 little-endian, в порядке заполнения окна дисплея —
+ * столбец за столбцом (x снаружи, y внутри), как их принимает
+ * ILI9225_DMA_sendPixels() после ILI9225_setWindow(). SPI2 работает
+ * 16-битными кадрами, поэтому DMA берёт полуслова прямо из сектора.
+ */
+
+#include <stdint.h>
+
+#define IMG565_HEADER_SIZE       16
+#define IMG565_SECTOR            512
+
+#define IMG565_ANY_ORIENTATION   0xFF
+
+#define IMG565_FLAG_ALIGNED      0x01   // пиксели начинаются с границы сектора
+
+typedef struct {
+    uint16_t width;
+    uint16_t height;
+    uint8_t  orientation;
+    uint8_t  flags;
+    uint32_t data_offset;
+} img565_header_t;
+
+/**
+ * @brief Разбор заголовка
+ * @param buf первые IMG565_HEADER_SIZE байт файла
+ * @param hdr куда положить поля
+ * @return 1 если заголовок корректен, 0 если нет
+ */
+static inline uint8_t img565_parse(const uint8_t *buf, img565_header_t *hdr) {
+    if (buf[0] != 'R' || buf[1] != '5' || buf[2] != '6' || buf[3] != '5') return 0;
+
+    hdr->width       = (uint16_t)(buf[4] | (buf[5] << 8));
+    hdr->height      = (uint16_t)(buf[6] | (buf[7] << 8));
+    hdr->orientation = buf[8];
+    hdr->flags       = buf[9];
+    hdr->data_offset = (uint32_t)buf[12] | ((uint32_t)buf[13] << 8) |
+                       ((uint32_t)buf[14] << 16) | ((uint32_t)buf[15] << 24);
+
+    if (hdr->width == 0 || hdr->height == 0) return 0;
+    if (hdr->data_offset < IMG565_HEADER_SIZE || (hdr->data_offset & 1)) return 0;
+    return 1;
+}
+
+/**
+ * @brief Сборка заголовка
+ * @param hdr поля заголовка
+ * @param buf IMG565_HEADER_SIZE байт
+ */
+static inline void img565_pack(const img565_header_t *hdr, uint8_t *buf) {
+    buf[0]  = 'R';
+    buf[1]  = '5';
+    buf[2]  = '6';
+    buf[3]  = '5';
+    buf[4]  = (uint8_t)hdr->width;
+    buf[5]  = (uint8_t)(hdr->width >> 8);
+    buf[6]  = (uint8_t)hdr->height;
+    buf[7]  = (uint8_t)(hdr->height >> 8);
+    buf[8]  = hdr->orientation;
+    buf[9]  = hdr->flags;
+    buf[10] = 0;
+    buf[11] = 0;
+    buf[12] = (uint8_t)hdr->data_offset;
+    buf[13] = (uint8_t)(hdr->data_offset >> 8);
+    buf[14] = (uint8_t)(hdr->data_offset >> 16);
+    buf[15] = (uint8_t)(hdr->data_offset >> 24);
+}
+
+#endif /* IMG565_H */
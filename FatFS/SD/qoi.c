@@ -0,0 +1,170 @@
+/**
+ * @file qoi.c
+ * @brief Потоковый декодер картинок QOI (https://qoiformat.org) с выводом на LCD
+ *
+ * Вся картинка в памяти не нужна: декодер читает файл окном
+ * QOI_INPUT_WINDOW байт и собирает по одной строке RGB565. ОЗУ:
+ * таблица 64 цвета (256 байт) + окно + две строки по 220 пикселей,
+ * всё вместе с FIL — в общей work_area (work_area.h).
+ */
+
+#include "qoi.h"
+#include "ILI9225.h"
+#include "work_area.h"
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+// Константы формата
+// -----------------------------------------------------------------------------
+
+#define QOI_HEADER_SIZE   14
+
+#define QOI_OP_INDEX      0x00   // 00xxxxxx
+#define QOI_OP_DIFF       0x40   // 01xxxxxx
+#define QOI_OP_LUMA       0x80   // 10xxxxxx
+#define QOI_OP_RUN        0xC0   // 11xxxxxx
+#define QOI_OP_RGB        0xFE
+#define QOI_OP_RGBA       0xFF
+#define QOI_MASK_2        0xC0
+
+// -----------------------------------------------------------------------------
+// Типы данных
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    FIL     *fp;
+    uint16_t pos;    // следующий байт в окне
+    uint16_t len;    // сколько байт в окне
+    uint8_t  eof;    // файл кончился раньше картинки
+} qoi_input_t;
+
+// -----------------------------------------------------------------------------
+// Внутренние функции
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Следующий байт из окна, при необходимости дочитывает файл
+ * @return байт или 0, если данные кончились (тогда выставляется eof)
+ */
+static uint8_t qoi_byte(qoi_input_t *in) {
+    if (in->pos == in->len) {
+        UINT got = 0;
+        uint8_t *window = work_area.qoi.window;
+        if (in->eof || f_read(in->fp, window, sizeof(work_area.qoi.window), &got) != FR_OK || got == 0) {
+            in->eof = 1;
+            return 0;
+        }
+        in->pos = 0;
+        in->len = (uint16_t)got;
+    }
+    return work_area.qoi.window[in->pos++];
+}
+
+/**
+ * @brief Место цвета в таблице
+ */
+static inline uint8_t qoi_hash(qoi_rgba_t px) {
+    return (uint8_t)((px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64);
+}
+
+static inline uint32_t qoi_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// -----------------------------------------------------------------------------
+// Публичные функции
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Потоковый вывод картинки QOI на экран
+ * @param name имя файла
+ * @param x левый край на экране
+ * @param y верхний край на экране
+ * @return FR_OK при успехе, FR_INVALID_OBJECT если это не QOI,
+ * FR_INVALID_PARAMETER если картинка не влезает в экран,
+ * FR_INT_ERR если поток данных оборвался
+ */
+FRESULT qoi_draw(const char *name, uint16_t x, uint16_t y) {
+    FIL *file = &work_area.qoi.file;
+    uint8_t header[QOI_HEADER_SIZE];
+    UINT bytes_read;
+
+    FRESULT res = f_open(file, name, FA_READ);
+    if (res != FR_OK) return res;
+
+    res = f_read(file, header, sizeof(header), &bytes_read);
+    if (res == FR_OK && (bytes_read != sizeof(header) || memcmp(header, "qoif", 4) != 0)) {
+        res = FR_INVALID_OBJECT;
+    }
+
+    uint32_t width  = qoi_be32(header + 4);
+    uint32_t height = qoi_be32(header + 8);
+    if (res == FR_OK && (width == 0 || height == 0 ||
+                         x + width > ILI9225_maxX || y + height > ILI9225_maxY)) {
+        res = FR_INVALID_PARAMETER;
+    }
+    if (res != FR_OK) {
+        f_close(file);
+        return res;
+    }
+
+    qoi_input_t in = { file, 0, 0, 0 };
+    qoi_rgba_t px = { 0, 0, 0, 255 };
+    uint8_t run = 0;
+    memset(work_area.qoi.index, 0, sizeof(work_area.qoi.index));
+
+    ILI9225_setScanOrder(ILI9225_SCAN_ROWS);
+    ILI9225_setWindow(x, y, x + width - 1, y + height - 1);
+    ILI9225_writeIndex(GRAM_DATA_REG);
+
+    for (uint32_t row = 0; row < height && !in.eof; row++) {
+        // Строка row-2 в этом буфере уже ушла: её ждала передача row-1
+        uint16_t *line = work_area.qoi.line[row & 1];
+
+        for (uint32_t col = 0; col < width; col++) {
+            if (run) {
+                run--;
+            } else {
+                uint8_t b1 = qoi_byte(&in);
+
+                if (b1 == QOI_OP_RGB) {
+                    px.r = qoi_byte(&in);
+                    px.g = qoi_byte(&in);
+                    px.b = qoi_byte(&in);
+                } else if (b1 == QOI_OP_RGBA) {
+                    px.r = qoi_byte(&in);
+                    px.g = qoi_byte(&in);
+                    px.b = qoi_byte(&in);
+                    px.a = qoi_byte(&in);
+                } else if ((b1 & QOI_MASK_2) == QOI_OP_INDEX) {
+                    px = work_area.qoi.index[b1];
+                } else if ((b1 & QOI_MASK_2) == QOI_OP_DIFF) {
+                    px.r += ((b1 >> 4) & 0x03) - 2;
+                    px.g += ((b1 >> 2) & 0x03) - 2;
+                    px.b += ( b1       & 0x03) - 2;
+                } else if ((b1 & QOI_MASK_2) == QOI_OP_LUMA) {
+                    uint8_t b2 = qoi_byte(&in);
+                    int8_t vg = (int8_t)((b1 & 0x3F) - 32);
+                    px.r += vg - 8 + ((b2 >> 4) & 0x0F);
+                    px.g += vg;
+                    px.b += vg - 8 + (b2 & 0x0F);
+                } else {
+                    run = b1 & 0x3F;
+                }
+
+                work_area.qoi.index[qoi_hash(px)] = px;
+            }
+
+            line[col] = (uint16_t)(((px.r >> 3) << 11) | ((px.g >> 2) << 5) | (px.b >> 3));
+        }
+
+        // Ждёт только строку row-1, декодирование следующей идёт параллельно
+        if (!in.eof) ILI9225_DMA_sendPixels(line, width);
+    }
+
+    ILI9225_DMA_wait();
+    ILI9225_setScanOrder(ILI9225_SCAN_COLUMNS);
+    f_close(file);
+
+    return in.eof ? FR_INT_ERR : FR_OK;
+}
@@ -0,0 +1,44 @@
+#ifndef QOI_H
+#define QOI_H
+
+#include <stdint.h>
+#include "ff.h"
+
+// -----------------------------------------------------------------------------
+// Конфигурация
+// -----------------------------------------------------------------------------
+
+// Окно чтения файла, байт. Меньше — меньше ОЗУ, но чаще f_read
+#ifndef QOI_INPUT_WINDOW
+#define QOI_INPUT_WINDOW  512
+#endif
+
+// -----------------------------------------------------------------------------
+// Типы данных
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    uint8_t r, g, b, a;
+} qoi_rgba_t;
+
+// -----------------------------------------------------------------------------
+// Публичные функции
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Потоковый вывод картинки QOI на экран
+ *
+ * Декодер держит только таблицу из 64 цветов, окно чтения файла и две
+ * строки RGB565: пока одна строка уходит на дисплей DMA, следующая
+ * декодируется. Окно дисплея на время вывода заполняется по строкам.
+ * Альфа-канал не используется.
+ * @param name имя файла
+ * @param x левый край на экране
+ * @param y верхний край на экране
+ * @return FR_OK при успехе, FR_INVALID_OBJECT если это не QOI,
+ * FR_INVALID_PARAMETER если картинка не влезает в экран,
+ * FR_INT_ERR если поток данных оборвался
+ */
+FRESULT qoi_draw(const char *name, uint16_t x, uint16_t y);
+
+#endif /* QOI_H */
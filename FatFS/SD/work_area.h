@@ -0,0 +1,80 @@
+#ifndef WORK_AREA_H
+#define WORK_AREA_H
+
+/**
+ * @file work_area.h
+ * @brief Общая рабочая память вывода картинок и форматирования
+ *
+ * Декодеры BMP и QOI, конвейеры SD -> LCD, галерея и f_mkfs друг друга
+ * не вызывают: картинка рисуется одна за раз, а f_mkfs работает до
+ * монтирования. Поэтому их буферы и FIL лежат в одном union, а не каждый
+ * в своём static и не на стеке. Память принадлежит функции, которая
+ * сейчас рисует; все они перед возвратом дожидаются DMA дисплея.
+ */
+
+#include <stdint.h>
+#include "ff.h"
+#include "ILI9225.h"
+#include "bmp.h"
+#include "qoi.h"
+#include "gallery.h"
+#include "file_work.h"
+
+// -----------------------------------------------------------------------------
+// Конфигурация
+// -----------------------------------------------------------------------------
+
+// Самая длинная строка экрана — в альбомной ориентации
+#define WORK_LINE_MAX   ((LCD_WIDTH > LCD_HEIGHT) ? LCD_WIDTH : LCD_HEIGHT)
+
+// Рабочий буфер f_mkfs: меньше — короче пачки CMD25 при форматировании
+#define WORK_MKFS_SIZE  4096
+
+// -----------------------------------------------------------------------------
+// Типы данных
+// -----------------------------------------------------------------------------
+
+typedef union {
+    BYTE mkfs[WORK_MKFS_SIZE];
+
+    // bmp.c: палитра, сырой кусок строки, две строки RGB565, суммы по блокам
+    struct {
+        FIL      file;
+        DWORD    clmt[BMP_CLMT_LEN];
+        uint16_t palette[256];
+        uint8_t  raw[WORK_LINE_MAX * 3];
+        uint16_t line[2][WORK_LINE_MAX];
+        uint16_t acc[3][WORK_LINE_MAX];      // суммы R, G, B для BMP_SCALE_BOX
+    } bmp;
+
+    // qoi.c: окно чтения файла, таблица 64 цветов, две строки RGB565
+    struct {
+        FIL        file;
+        uint8_t    window[QOI_INPUT_WINDOW];
+        qoi_rgba_t index[64];
+        uint16_t   line[2][WORK_LINE_MAX];
+    } qoi;
+
+    // file_work.c: конвейеры SD -> LCD, по два буфера на сектор и на пиксели
+    struct {
+        FIL      file;
+        DWORD    clmt[STREAM_CLMT_LEN];
+        uint16_t sd[2][STREAM_SECTOR / 2];   // uint16_t: DMA в SPI2 идёт полусловами
+        uint16_t px[2][STREAM_PIXELS];
+    } stream;
+
+    // gallery.c: сначала обход каталога, потом вывод миниатюр из кэша
+    struct {
+        DIR     dir;
+        FILINFO fno;
+    } gallery_scan;
+    uint16_t gallery_sd[2][GALLERY_SECTOR / 2];
+} work_area_t;
+
+// -----------------------------------------------------------------------------
+// Глобальные переменные
+// -----------------------------------------------------------------------------
+
+extern work_area_t work_area;
+
+#endif /* WORK_AREA_H */
@@ -0,0 +1,493 @@
+/**
+ * @file diskcache.c
+ * @brief Кэш секторов между FatFS и SD_card.c
+ *
+ * Обходы каталогов и цепочки FAT раз за разом читают одни и те же
+ * сектора. Кэш наборно-ассоциативный: DISK_CACHE_SETS наборов по
+ * DISK_CACHE_WAYS строк, вытеснение LRU, запись отложенная (write-back).
+ * Сектора закреплённого диапазона (FAT) живут в своих DISK_CACHE_PINNED
+ * строках и не вытесняются потоком данных.
+ *
+ * Промахи кэша идут через упреждающее чтение: если чтения идут подряд,
+ * следующий сектор запрашивается заранее (SD_ReadAheadStart) и едет по
+ * DMA, пока вызывающий обрабатывает текущий. Глубина растёт на каждом
+ * попадании до DISK_PREFETCH_DEPTH и падает до 1 при разрыве потока.
+ * Дальше конца карты упреждение не заходит, а его сбой только выбрасывает
+ * сектор из кольца: повтор и низкую скорость решает настоящее чтение.
+ * Чтения FAT (закреплённый диапазон) поток не рвут.
+ *
+ * Конвейеры file_work.c читают сектора картинок с карты напрямую, мимо
+ * кэша: это файлы только для чтения, а после записи FatFS делает
+ * CTRL_SYNC в f_sync()/f_close(). Перед этим они зовут disk_prefetch_stop().
+ * Очередь SD_QueueSubmit() забирает чтение в пути сама (SD_setAsyncRelease).
+ *
+ * CTRL_SYNC не ждёт, пока карта запрограммирует блоки: грязные строки
+ * ставятся в очередь SD и дописываются SD_QueuePoll() главного цикла.
+ * Любое обращение к кэшу сначала дорабатывает очередь, так что строка в
+ * очереди не меняется, а прямые SD_* сами ждут её перед своим обменом.
+ */
+
+#include "diskcache.h"
+#include "SD_card.h"
+#include "TIMER.h"
+#include <string.h>
+
+#define DC_SECTOR   512
+#define DC_ASSOC    (DISK_CACHE_SETS * DISK_CACHE_WAYS)
+#define DC_LINES    (DC_ASSOC + DISK_CACHE_PINNED)
+
+static disk_cache_stats_t dc_stats;
+
+static LBA_t dc_pin_first = 0;
+static LBA_t dc_pin_count = 0;
+
+static inline uint8_t dc_pinned(LBA_t sector) {
+    return sector - dc_pin_first < dc_pin_count;
+}
+
+// -----------------------------------------------------------------------------
+// Упреждающее чтение
+// Кольцо из pf_count секторов начиная с pf_base; последний может ещё
+// читаться по DMA (pf_busy). Пока он в пути, SPI1 трогать нельзя
+// -----------------------------------------------------------------------------
+
+#if DISK_PREFETCH_DEPTH > 0
+
+static uint32_t pf_data[DISK_PREFETCH_DEPTH][DC_SECTOR / 4];
+static LBA_t    pf_base  = 0;
+static uint8_t  pf_head  = 0;
+static uint8_t  pf_count = 0;
+static uint8_t  pf_busy  = 0;
+static uint8_t  pf_depth = 1;
+static LBA_t    pf_next  = 0;   // где кончилось прошлое чтение с карты
+static uint8_t  pf_streak = 0;  // сколько чтений подряд его продолжали
+
+/**
+ * @brief Завершение чтения, которое ещё идёт; время ожидания — в счётчик
+ */
+static void dc_pf_finish(void) {
+    if (!pf_busy) return;
+
+    uint32_t t_start = SD_DMA_busy() ? get_us() : 0;
+    SD_Status st = SD_ReadBlockFinish();
+    if (t_start) dc_stats.pf_stall_us += get_us() - t_start;
+
+    pf_busy = 0;
+    if (st != SD_OK) pf_count--;
+}
+
+static void dc_pf_drop(void) {
+    dc_pf_finish();
+    dc_stats.pf_dropped += pf_count;
+    pf_count = 0;
+}
+
+/**
+ * @brief Перед записью: кольцо выбрасывается, только если в нём есть эти сектора
+ */
+static void dc_pf_write(LBA_t sector, UINT count) {
+    dc_pf_finish();
+    if (pf_count && sector < pf_base + pf_count && pf_base < sector + count) dc_pf_drop();
+}
+
+/**
+ * @brief Отдать сектор из кольца, если он там первый
+ */
+static uint8_t dc_pf_take(LBA_t sector, BYTE *buff) {
+    if (pf_count == 0 || sector != pf_base) return 0;
+    if (pf_count == 1) {
+        dc_pf_finish();
+        if (pf_count == 0) return 0;
+    }
+
+    memcpy(buff, pf_data[pf_head], DC_SECTOR);
+    pf_head = (uint8_t)((pf_head + 1) % DISK_PREFETCH_DEPTH);
+    pf_base++;
+    pf_count--;
+    dc_stats.pf_hits++;
+    return 1;
+}
+
+/**
+ * @brief Добор кольца до pf_depth: одно чтение в пути за раз
+ */
+static void dc_pf_fill(void) {
+    if (pf_count == 0) {
+        pf_base = pf_next;
+        pf_head = 0;
+    }
+    // Готовое чтение забирается без ожидания, идущее — не ждём
+    if (pf_busy) {
+        if (SD_DMA_busy()) return;
+        dc_pf_finish();
+    }
+    if (pf_count >= pf_depth) return;
+    if (pf_base + pf_count >= sd_card_info()->sectors) return;
+    // Упреждение не должно ждать очередь SD_QueueSubmit()
+    if (SD_QueueBusy()) return;
+
+    uint8_t slot = (uint8_t)((pf_head + pf_count) % DISK_PREFETCH_DEPTH);
+    if (SD_ReadAheadStart(pf_base + pf_count, (uint8_t *)pf_data[slot]) == SD_OK) {
+        pf_busy = 1;
+        pf_count++;
+        dc_stats.pf_issued++;
+        // Чтение переживает возврат из disk_read: если FatFS больше не позовут,
+        // его заберёт SD_QueuePoll(), а сектор останется в кольце
+        SD_setAsyncRelease(dc_pf_finish);
+    }
+}
+
+#else
+
+static inline void dc_pf_finish(void) {}
+static inline void dc_pf_drop(void) {}
+static inline void dc_pf_write(LBA_t sector, UINT count) { (void)sector; (void)count; }
+
+#endif /* DISK_PREFETCH_DEPTH */
+
+// -----------------------------------------------------------------------------
+// Внутренние функции: карта
+// -----------------------------------------------------------------------------
+
+static DRESULT dc_card_read(BYTE *buff, LBA_t sector, UINT count) {
+    dc_pf_finish();
+    // Несколько секторов подряд — одной командой CMD18
+    SD_Status st = (count > 1) ? SD_ReadBlocks(sector, buff, count) : SD_ReadBlock(sector, buff);
+    return (st == SD_OK) ? RES_OK : RES_ERROR;
+}
+
+static DRESULT dc_card_write(const BYTE *buff, LBA_t sector, UINT count) {
+    // Записанный сектор мог уже лежать в кольце
+    dc_pf_write(sector, count);
+    // Несколько секторов подряд — ACMD23 + CMD25 (f_mkfs, большие f_write)
+    SD_Status st = (count > 1) ? SD_WriteBlocks(sector, buff, count) : SD_WriteBlock(sector, buff);
+    return (st == SD_OK) ? RES_OK : RES_ERROR;
+}
+
+/**
+ * @brief Чтение с карты через упреждающее чтение
+ */
+static DRESULT dc_fetch(BYTE *buff, LBA_t sector, UINT count) {
+#if DISK_PREFETCH_DEPTH > 0
+    // FAT читается посреди потока данных и не должна его сбрасывать
+    if (dc_pinned(sector)) return dc_card_read(buff, sector, count);
+
+    uint8_t seq  = (sector == pf_next);
+    uint8_t took = 0;
+    while (count && dc_pf_take(sector, buff)) {
+        took = 1;
+        sector++;
+        buff += DC_SECTOR;
+        count--;
+    }
+
+    if (took) {
+        if (pf_depth < DISK_PREFETCH_DEPTH) pf_depth++;
+    } else {
+        dc_pf_drop();
+        pf_depth = 1;
+    }
+
+    DRESULT res = count ? dc_card_read(buff, sector, count) : RES_OK;
+    if (res != RES_OK) {
+        pf_streak = 0;
+        return res;
+    }
+
+    pf_next = sector + count;
+    if (!seq) {
+        pf_streak = 0;
+    } else if (pf_streak < 255) {
+        pf_streak++;
+    }
+
+    // Второе чтение подряд — уже поток
+    if (pf_streak > 0) dc_pf_fill();
+    return RES_OK;
+#else
+    return dc_card_read(buff, sector, count);
+#endif
+}
+
+/**
+ * @brief Продолжает ли чтение последовательный поток (тогда оно мимо строк кэша)
+ */
+static inline uint8_t dc_streaming(LBA_t sector) {
+#if DISK_PREFETCH_DEPTH > 0
+    return pf_streak > 0 && sector == pf_next && !dc_pinned(sector);
+#else
+    (void)sector;
+    return 0;
+#endif
+}
+
+void disk_prefetch_stop(void) {
+    dc_pf_drop();
+#if DISK_PREFETCH_DEPTH > 0
+    pf_streak = 0;
+#endif
+}
+
+#if DISK_CACHE_SETS > 0
+
+// -----------------------------------------------------------------------------
+// Внутренние переменные
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    LBA_t    sector;
+    uint32_t used;      // метка LRU: больше — свежее
+    uint8_t  valid;
+    uint8_t  dirty;
+} dc_tag_t;
+
+static dc_tag_t dc_tag[DC_LINES];
+static uint32_t dc_data[DC_LINES][DC_SECTOR / 4];
+static uint32_t dc_clock = 0;
+
+// Запись строк по CTRL_SYNC через очередь SD: запрос на строку
+static SD_Request dc_wb_req[DC_LINES];
+static uint8_t    dc_wb_pending = 0;   // запросов ещё в очереди
+static uint8_t    dc_wb_failed  = 0;   // сбой — отдаётся следующему CTRL_SYNC
+
+// -----------------------------------------------------------------------------
+// Внутренние функции: строки
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Строки, в которых может лежать сектор: набор или закреплённые
+ */
+static void dc_group(LBA_t sector, uint16_t *first, uint16_t *count) {
+    if (DISK_CACHE_PINNED > 0 && dc_pinned(sector)) {
+        *first = DC_ASSOC;
+        *count = DISK_CACHE_PINNED;
+    } else {
+        *first = (uint16_t)((sector % DISK_CACHE_SETS) * DISK_CACHE_WAYS);
+        *count = DISK_CACHE_WAYS;
+    }
+}
+
+/**
+ * @brief Поиск сектора; при промахе — свободная или самая старая строка
+ * @return номер строки; *hit — найден ли сектор
+ */
+static uint16_t dc_lookup(LBA_t sector, uint8_t *hit) {
+    uint16_t first, count;
+    dc_group(sector, &first, &count);
+
+    uint16_t victim = first;
+    for (uint16_t i = first; i < first + count; i++) {
+        if (dc_tag[i].valid && dc_tag[i].sector == sector) {
+            *hit = 1;
+            return i;
+        }
+        if (!dc_tag[i].valid) {
+            victim = i;
+        } else if (dc_tag[victim].valid && dc_tag[i].used < dc_tag[victim].used) {
+            victim = i;
+        }
+    }
+    *hit = 0;
+    return victim;
+}
+
+/**
+ * @brief Освобождение строки: грязная сначала уходит на карту
+ */
+static DRESULT dc_evict(uint16_t line) {
+    if (dc_tag[line].valid && dc_tag[line].dirty) {
+        DRESULT res = dc_card_write((const BYTE *)dc_data[line], dc_tag[line].sector, 1);
+        if (res != RES_OK) return res;
+        dc_tag[line].dirty = 0;
+        dc_stats.writebacks++;
+    }
+    dc_tag[line].valid = 0;
+    return RES_OK;
+}
+
+static inline void dc_touch(uint16_t line) {
+    dc_tag[line].used = ++dc_clock;
+}
+
+/**
+ * @brief Конец записи строки из очереди (в контексте SD_QueuePoll)
+ * При сбое строка остаётся грязной и уйдёт на карту ещё раз
+ */
+static void dc_wb_done(SD_Request *req) {
+    uint16_t line = (uint16_t)(req - dc_wb_req);
+    dc_wb_pending--;
+    if (req->status == SD_OK) {
+        dc_tag[line].dirty = 0;
+        dc_stats.writebacks++;
+    } else {
+        dc_wb_failed = 1;
+    }
+}
+
+/**
+ * @brief Доработка записей строк из очереди перед обращением к строкам
+ */
+static inline void dc_wb_settle(void) {
+    if (dc_wb_pending) SD_QueueFlush();
+}
+
+// -----------------------------------------------------------------------------
+// Публичные функции
+// -----------------------------------------------------------------------------
+
+void disk_cache_reset(void) {
+    dc_wb_settle();
+    disk_prefetch_stop();
+    memset(dc_tag, 0, sizeof(dc_tag));
+    dc_clock = 0;
+}
+
+void disk_cache_pin(LBA_t first, LBA_t count) {
+    // Закреплённые строки не должны пережить смену диапазона, а строка набора
+    // с сектором из нового диапазона стала бы второй копией этого сектора.
+    // Ошибку записи здесь вернуть некуда: такая строка остаётся грязной
+    // до disk_cache_flush()
+    dc_wb_settle();
+    for (uint16_t i = 0; i < DC_LINES; i++) {
+        if (i >= DC_ASSOC || (dc_tag[i].valid && dc_tag[i].sector - first < count)) {
+            dc_evict(i);
+        }
+    }
+    dc_pin_first = first;
+    dc_pin_count = count;
+}
+
+DRESULT disk_cache_read(BYTE *buff, LBA_t sector, UINT count) {
+    dc_wb_settle();
+    if (count > 1) {
+        dc_stats.bypass++;
+        DRESULT res = dc_fetch(buff, sector, count);
+        if (res != RES_OK) return res;
+
+        for (uint16_t i = 0; i < DC_LINES; i++) {
+            if (dc_tag[i].valid && dc_tag[i].sector - sector < count) {
+                memcpy(buff + (dc_tag[i].sector - sector) * DC_SECTOR, dc_data[i], DC_SECTOR);
+            }
+        }
+        return RES_OK;
+    }
+
+    uint8_t hit;
+    uint16_t line = dc_lookup(sector, &hit);
+    if (hit) {
+        dc_stats.hits++;
+    } else if (dc_streaming(sector)) {
+        // Данные файла читаются один раз — не вытеснять ими каталоги
+        dc_stats.bypass++;
+        return dc_fetch(buff, sector, 1);
+    } else {
+        dc_stats.misses++;
+        DRESULT res = dc_evict(line);
+        if (res == RES_OK) res = dc_fetch((BYTE *)dc_data[line], sector, 1);
+        if (res != RES_OK) return res;
+        dc_tag[line].sector = sector;
+        dc_tag[line].valid  = 1;
+    }
+    dc_touch(line);
+    memcpy(buff, dc_data[line], DC_SECTOR);
+    return RES_OK;
+}
+
+DRESULT disk_cache_write(const BYTE *buff, LBA_t sector, UINT count) {
+    dc_wb_settle();
+    if (count > 1) {
+        dc_stats.bypass++;
+        DRESULT res = dc_card_write(buff, sector, count);
+        if (res != RES_OK) return res;
+
+        for (uint16_t i = 0; i < DC_LINES; i++) {
+            if (dc_tag[i].valid && dc_tag[i].sector - sector < count) {
+                memcpy(dc_data[i], buff + (dc_tag[i].sector - sector) * DC_SECTOR, DC_SECTOR);
+                dc_tag[i].dirty = 0;
+            }
+        }
+        return RES_OK;
+    }
+
+    uint8_t hit;
+    uint16_t line = dc_lookup(sector, &hit);
+    if (hit) {
+        dc_stats.hits++;
+    } else {
+        dc_stats.misses++;
+        DRESULT res = dc_evict(line);
+        if (res != RES_OK) return res;
+        dc_tag[line].sector = sector;
+        dc_tag[line].valid  = 1;
+    }
+    dc_touch(line);
+    memcpy(dc_data[line], buff, DC_SECTOR);
+    dc_tag[line].dirty = 1;
+    return RES_OK;
+}
+
+DRESULT disk_cache_flush(void) {
+    dc_wb_settle();
+    DRESULT res = dc_wb_failed ? RES_ERROR : RES_OK;
+    dc_wb_failed = 0;
+
+    for (uint16_t i = 0; i < DC_LINES; i++) {
+        if (!dc_tag[i].valid || !dc_tag[i].dirty) continue;
+
+        // Сектор мог лежать в кольце упреждающего чтения
+        dc_pf_write(dc_tag[i].sector, 1);
+        SD_Request *req = &dc_wb_req[i];
+        req->type     = SD_REQ_WRITE;
+        req->sector   = dc_tag[i].sector;
+        req->buffer   = (uint8_t *)dc_data[i];
+        req->callback = dc_wb_done;
+        if (SD_QueueSubmit(req) == SD_OK) {
+            dc_wb_pending++;
+            continue;
+        }
+
+        // Очередь полна: строка пишется сразу, после уже поставленных
+        if (dc_card_write((const BYTE *)dc_data[i], dc_tag[i].sector, 1) != RES_OK) {
+            res = RES_ERROR;   // строка остаётся грязной, остальные всё равно пишутся
+            continue;
+        }
+        dc_tag[i].dirty = 0;
+        dc_stats.writebacks++;
+    }
+    return res;
+}
+
+#else /* DISK_CACHE_SETS == 0: прямой доступ к карте */
+
+void disk_cache_reset(void) {
+    disk_prefetch_stop();
+}
+
+void disk_cache_pin(LBA_t first, LBA_t count) {
+    dc_pin_first = first;
+    dc_pin_count = count;
+}
+
+DRESULT disk_cache_read(BYTE *buff, LBA_t sector, UINT count) {
+    dc_stats.bypass++;
+    return dc_fetch(buff, sector, count);
+}
+
+DRESULT disk_cache_write(const BYTE *buff, LBA_t sector, UINT count) {
+    dc_stats.bypass++;
+    return dc_card_write(buff, sector, count);
+}
+
+DRESULT disk_cache_flush(void) {
+    return RES_OK;
+}
+
+#endif /* DISK_CACHE_SETS */
+
+void disk_cache_get_stats(disk_cache_stats_t *stats) {
+    *stats = dc_stats;
+}
+
+void disk_cache_clear_stats(void) {
+    memset(&dc_stats, 0, sizeof(dc_stats));
+}
@@ -0,0 +1,111 @@
+#ifndef DISKCACHE_H
+#define DISKCACHE_H
+
+#include <stdint.h>
+#include "ff.h"
+#include "diskio.h"
+
+// -----------------------------------------------------------------------------
+// Конфигурация
+// ОЗУ: 512 * (DISK_CACHE_SETS * DISK_CACHE_WAYS + DISK_CACHE_PINNED) байт
+// плюс по 12 байт на строку. DISK_CACHE_SETS = 0 — кэш выключен
+// -----------------------------------------------------------------------------
+
+// Число наборов: сектор попадает в набор sector % DISK_CACHE_SETS
+#ifndef DISK_CACHE_SETS
+#define DISK_CACHE_SETS    2
+#endif
+
+// Строк в наборе, вытесняется давно не использованная (LRU)
+#ifndef DISK_CACHE_WAYS
+#define DISK_CACHE_WAYS    2
+#endif
+
+// Отдельные строки под FAT (см. disk_cache_pin), данные их не вытесняют
+#ifndef DISK_CACHE_PINNED
+#define DISK_CACHE_PINNED  1
+#endif
+
+// Упреждающее чтение: сколько секторов максимум держать впереди
+// последовательного потока (по 512 байт ОЗУ). 0 — выключено
+#ifndef DISK_PREFETCH_DEPTH
+#define DISK_PREFETCH_DEPTH  2
+#endif
+
+// -----------------------------------------------------------------------------
+// Типы данных
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    uint32_t hits;        // одиночные сектора, найденные в кэше
+    uint32_t misses;      // одиночные сектора, за которыми пришлось идти на карту
+    uint32_t writebacks;  // грязные строки, записанные на карту
+    uint32_t bypass;      // многосекторные обращения мимо кэша
+    uint32_t pf_issued;   // секторов прочитано наперёд
+    uint32_t pf_hits;     // из них отданы FatFS
+    uint32_t pf_dropped;  // выброшены: поток прервался или была запись
+    uint32_t pf_stall_us; // ожидание незаконченного упреждающего чтения, мкс
+} disk_cache_stats_t;
+
+// -----------------------------------------------------------------------------
+// Публичные функции
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Сброс всех строк без записи (после инициализации карты)
+ */
+void disk_cache_reset(void);
+
+/**
+ * @brief Закрепление диапазона секторов за отдельными строками
+ * Обычно это FAT: fs.fatbase, fs.fsize * fs.n_fats
+ * @param first первый сектор
+ * @param count сколько секторов, 0 — снять закрепление
+ */
+void disk_cache_pin(LBA_t first, LBA_t count);
+
+/**
+ * @brief Чтение секторов через кэш
+ *
+ * Одиночный сектор ищется в кэше и при промахе попадает в него.
+ * Несколько секторов читаются с карты одной командой, мимо кэша,
+ * поверх кладутся строки кэша из этого диапазона (они свежее карты).
+ */
+DRESULT disk_cache_read(BYTE *buff, LBA_t sector, UINT count);
+
+/**
+ * @brief Запись секторов через кэш
+ *
+ * Одиночный сектор только помечается грязным и уйдёт на карту при
+ * вытеснении или disk_cache_flush(). Несколько секторов пишутся на
+ * карту сразу, копии в кэше обновляются.
+ */
+DRESULT disk_cache_write(const BYTE *buff, LBA_t sector, UINT count);
+
+/**
+ * @brief Запись всех грязных строк на карту (CTRL_SYNC)
+ *
+ * Строки ставятся в очередь SD (SD_QueueSubmit) и дописываются
+ * SD_QueuePoll(); если очередь полна — пишутся сразу. Любое следующее
+ * обращение к кэшу или SD_* сначала дорабатывает очередь.
+ * @return RES_ERROR, если сбоила запись сейчас или запись из очереди после
+ * прошлого вызова (строка осталась грязной и поставлена снова)
+ */
+DRESULT disk_cache_flush(void);
+
+/**
+ * @brief Остановка упреждающего чтения
+ *
+ * Дожидается чтения, которое ещё идёт по DMA, и выбрасывает прочитанное.
+ * Нужна перед прямыми SD_* вызовами мимо diskio, иначе SPI1 занят.
+ */
+void disk_prefetch_stop(void);
+
+/**
+ * @brief Счётчики попаданий и промахов с последнего disk_cache_clear_stats()
+ */
+void disk_cache_get_stats(disk_cache_stats_t *stats);
+
+void disk_cache_clear_stats(void);
+
+#endif /* DISKCACHE_H */
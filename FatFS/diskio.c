@@ -1,11 +1,14 @@
 #include "ff.h"
 #include "diskio.h"
 #include "SD_card.h"
+#include "diskcache.h"
 #include <stdio.h>
 #include <string.h>
 
 DSTATUS disk_initialize(BYTE pdrv) {
     if(pdrv != 0) return STA_NOINIT;
+    // Карта могла смениться: всё, что было в кэше, уже не её
+    disk_cache_reset();
     return (sd_init() == SD_OK) ? 0 : STA_NOINIT;
 }
 
@@ -17,24 +20,12 @@ DSTATUS disk_status(BYTE pdrv)
 
 DRESULT disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count) {
     if (pdrv != 0) return RES_PARERR;
-    
-    for (UINT i = 0; i < count; i++) {
-        if (SD_ReadBlock(sector + i, buff + i * 512) != SD_OK) {
-            return RES_ERROR;
-        }
-    }
-    return RES_OK;
+    return disk_cache_read(buff, sector, count);
 }
 
 DRESULT disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
     if (pdrv != 0) return RES_PARERR;
-    
-    for (UINT i = 0; i < count; i++) {
-        if (SD_WriteBlock(sector + i, buff + i * 512) != SD_OK) {
-            return RES_ERROR;
-        }
-    }
-    return RES_OK;
+    return disk_cache_write(buff, sector, count);
 }
 
 DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff) {
@@ -43,10 +34,13 @@ DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff) {
     switch(cmd)
     {
         case CTRL_SYNC:
-            return RES_OK;
+            // Отложенные записи кэша — на карту
+            return disk_cache_flush();
             
         case GET_SECTOR_COUNT:
-            *(DWORD*)buff = 15728640; // 8GB карта (точнее 7.5)
+            // Ёмкость из CSD, прочитанного в sd_init()
+            if (sd_card_info()->sectors == 0) return RES_NOTRDY;
+            *(LBA_t*)buff = sd_card_info()->sectors;
             return RES_OK;
             
         case GET_SECTOR_SIZE:
@@ -54,8 +48,34 @@ DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff) {
             return RES_OK;
             
         case GET_BLOCK_SIZE:
-            *(DWORD*)buff = 1;
+            // Блок стирания (AU) в секторах: по нему f_mkfs выравнивает данные
+            if (sd_card_info()->sectors == 0) return RES_NOTRDY;
+            *(DWORD*)buff = sd_card_info()->erase_block;
+            return RES_OK;
+
+        case MMC_GET_TYPE:
+            // SD_TYPE_SD1 / SD_TYPE_SD2, плюс SD_TYPE_BLOCK у SDHC/SDXC
+            *(BYTE*)buff = sd_card_info()->type;
+            return RES_OK;
+
+        case MMC_GET_CSD:
+            memcpy(buff, sd_card_info()->csd, 16);
+            return RES_OK;
+
+        case MMC_GET_CID:
+            memcpy(buff, sd_card_info()->cid, 16);
+            return RES_OK;
+
+        case MMC_GET_OCR: {
+            // Как пришёл с карты: старший байт первым
+            uint32_t ocr = sd_card_info()->ocr;
+            BYTE *p = (BYTE*)buff;
+            p[0] = (BYTE)(ocr >> 24);
+            p[1] = (BYTE)(ocr >> 16);
+            p[2] = (BYTE)(ocr >> 8);
+            p[3] = (BYTE)ocr;
             return RES_OK;
+        }
     }
     
     return RES_PARERR;
@@ -34,7 +34,7 @@
 /* This option switches f_mkfs(). (0:Disable or 1:Enable) */
 
 
-#define FF_USE_FASTSEEK	0
+#define FF_USE_FASTSEEK	1
 /* This option switches fast seek feature. (0:Disable or 1:Enable) */
 
 
@@ -42,7 +42,7 @@
 /* This option switches f_expand(). (0:Disable or 1:Enable) */
 
 
-#define FF_USE_CHMOD	0
+#define FF_USE_CHMOD	1
 /* This option switches attribute control API functions, f_chmod() and f_utime().
 /  (0:Disable or 1:Enable) Also FF_FS_READONLY needs to be 0 to enable this option. */
 
@@ -113,7 +113,7 @@
 */
 
 
-#define FF_USE_LFN		2 /* используем стек */
+#define FF_USE_LFN		1 /* буфер в BSS: на стеке он лежал под каждой f_open */
 #define FF_MAX_LFN		128 /* максимальная длина имени файла */
 /* The FF_USE_LFN switches the support for LFN (long file name).
 /
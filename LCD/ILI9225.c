@@ -1,10 +1,120 @@
 #include "ILI9225.h"
 
 
+#ifdef ILI9225_FIXED_ORIENTATION
+	#define ILI9225_SET_SIZE(w, h)
+#else
 uint8_t  ILI9225_orientation = 0;
 uint16_t ILI9225_maxX = LCD_WIDTH;
 uint16_t ILI9225_maxY = LCD_HEIGHT;
 
+	#define ILI9225_SET_SIZE(w, h)	do { ILI9225_maxX = (w); ILI9225_maxY = (h); } while (0)
+#endif
+
+// ENTRY_MODE для каждой ориентации: окно заполняется по логическим столбцам
+// (x снаружи, y внутри). BGR=1, биты ID1/ID0 — направления, AM — что внутри
+static const uint16_t ILI9225_entry_mode[4] = {
+	0x1038, // 0: ID1=1, ID0=1, AM=1
+	0x1030, // 1: ID1=1, ID0=1, AM=0 (логический y — физическая горизонталь)
+	0x1028, // 2: ID1=1, ID0=0, AM=1
+	0x1020, // 3: ID1=1, ID0=0, AM=0
+};
+#define ILI9225_ENTRY_AM	0x0008
+#define ILI9225_ENTRY_ID0	0x0010
+#define ILI9225_ENTRY_ID1	0x0020
+
+// Максимум пересылок за один запуск канала DMA (CNDTR 16 бит)
+#define ILI9225_DMA_MAX_CHUNK	0xFFFFu
+
+static volatile uint8_t  ILI9225_dma_busy = 0;
+static volatile uint32_t ILI9225_dma_left = 0;
+static uint16_t const   *ILI9225_dma_src = 0;
+static uint8_t           ILI9225_dma_minc = 0;
+static uint16_t          ILI9225_dma_color = 0;
+static void (*ILI9225_dma_callback)(void) = 0;
+
+// Теневые копии регистров: ENTRY_MODE, адрес GRAM и окно
+#define ILI9225_SHADOW_ENTRY	0
+#define ILI9225_SHADOW_ADDR1	1
+#define ILI9225_SHADOW_ADDR2	2
+#define ILI9225_SHADOW_HWIN1	3
+#define ILI9225_SHADOW_HWIN2	4
+#define ILI9225_SHADOW_VWIN1	5
+#define ILI9225_SHADOW_VWIN2	6
+#define ILI9225_SHADOW_COUNT	7
+
+// Область прокрутки в логических координатах вдоль оси прокрутки
+static uint16_t ILI9225_scroll_start  = 0;
+static uint16_t ILI9225_scroll_end    = LCD_HEIGHT - 1;
+static uint16_t ILI9225_scroll_offset = 0;
+
+static uint16_t ILI9225_shadow[ILI9225_SHADOW_COUNT];
+static uint8_t  ILI9225_shadow_valid = 0;	// бит на каждый регистр
+
+/**
+ * @brief Номер теневой копии для регистра
+ * @return номер или -1 если регистр не кэшируется
+ */
+static int8_t ILI9225_shadowSlot(uint16_t address) {
+	switch (address) {
+	case ENTRY_MODE:              return ILI9225_SHADOW_ENTRY;
+	case RAM_ADDR_SET1:           return ILI9225_SHADOW_ADDR1;
+	case RAM_ADDR_SET2:           return ILI9225_SHADOW_ADDR2;
+	case HORIZONTAL_WINDOW_ADDR1: return ILI9225_SHADOW_HWIN1;
+	case HORIZONTAL_WINDOW_ADDR2: return ILI9225_SHADOW_HWIN2;
+	case VERTICAL_WINDOW_ADDR1:   return ILI9225_SHADOW_VWIN1;
+	case VERTICAL_WINDOW_ADDR2:   return ILI9225_SHADOW_VWIN2;
+	default:                      return -1;
+	}
+}
+
+/**
+ * @brief Запуск очередной порции передачи DMA (не больше 65535 пикселей)
+ */
+static void ILI9225_DMA_startChunk(void) {
+	uint32_t n = ILI9225_dma_left;
+	if (n > ILI9225_DMA_MAX_CHUNK) n = ILI9225_DMA_MAX_CHUNK;
+
+	DMA1_Channel5->CCR   = 0;
+	DMA1_Channel5->CMAR  = (uint32_t)ILI9225_dma_src;
+	DMA1_Channel5->CNDTR = n;
+
+	ILI9225_dma_left -= n;
+	if (ILI9225_dma_minc) ILI9225_dma_src += n;
+
+	// Память -> периферия, 16 бит на 16 бит, прерывание по окончанию
+	DMA1_Channel5->CCR = DMA_CCR_DIR     |
+	                     DMA_CCR_PSIZE_0 |
+	                     DMA_CCR_MSIZE_0 |
+	                     DMA_CCR_PL_1    |
+	                     DMA_CCR_TCIE    |
+	                     (ILI9225_dma_minc ? DMA_CCR_MINC : 0) |
+	                     DMA_CCR_EN;
+}
+
+/**
+ * @brief Общий запуск передачи: CS вниз, старт канала
+ * @param src откуда брать пиксели
+ * @param count количество пикселей
+ * @param minc 1 - идти по массиву, 0 - слать одно и то же значение
+ */
+static void ILI9225_DMA_start(uint16_t const *src, uint32_t count, uint8_t minc) {
+	if (count == 0) return;
+	ILI9225_DMA_wait();
+
+	ILI9225_dma_busy = 1;
+	ILI9225_dma_left = count;
+	ILI9225_dma_src  = src;
+	ILI9225_dma_minc = minc;
+
+	// SPI2 уже в 16-битном режиме (см. spi2_init_master)
+	SPI_apply_profile(2);
+	SPI2->CR2 |= SPI_CR2_TXDMAEN;
+
+	LCD_CS.activate();
+	ILI9225_DMA_startChunk();
+}
+
 /**
  * @brief Сброс дисплея или его активация
  */
@@ -15,6 +125,7 @@ void ILI9225_reset(void) {
 	Delay_ms(150);
 	LCD_RST.deactivate();
 	Delay_ms(50);
+	ILI9225_invalidateShadow();
 }
 
 /**
@@ -22,10 +133,18 @@ void ILI9225_reset(void) {
  * @param address регистр к которому обращаешься
  */
 void ILI9225_writeIndex(uint16_t address) {
+	ILI9225_DMA_wait();
+	// Профиль шины сверяется один раз на транзакцию, а не на каждое слово
+	SPI_apply_profile(2);
 	LCD_CS.activate();
 	LCD_RS.activate();
 	SPI_send_16bit(SPI2, address);
 	LCD_RS.deactivate();
+
+	// Запись в GRAM сдвигает счетчик адреса - его копия больше не верна
+	if (address == GRAM_DATA_REG) {
+		ILI9225_shadow_valid &= ~((1 << ILI9225_SHADOW_ADDR1) | (1 << ILI9225_SHADOW_ADDR2));
+	}
 }
 
 /**
@@ -34,48 +153,91 @@ void ILI9225_writeIndex(uint16_t address) {
  * @param data параметр который ты хочешь положить в указанный регистр
  */
 void ILI9225_write(uint16_t address, uint16_t data) {
+	int8_t slot = ILI9225_shadowSlot(address);
+	if (slot >= 0) {
+		if ((ILI9225_shadow_valid & (1 << slot)) && ILI9225_shadow[slot] == data) return;
+		ILI9225_shadow[slot] = data;
+		ILI9225_shadow_valid |= (1 << slot);
+	}
+
 	ILI9225_writeIndex(address);
 	SPI_send_16bit(SPI2, data);
 	LCD_CS.deactivate();
 }
 
 
+/**
+ * @brief Сброс теневых копий регистров окна, адреса GRAM и ENTRY_MODE
+ * Вызывать если регистры дисплея могли измениться в обход драйвера
+ * (сброс, смена ориентации)
+ */
+void ILI9225_invalidateShadow(void) {
+	ILI9225_shadow_valid = 0;
+}
+
 /**
  * @brief Изменение ориентации дисплея
  * @param orientation одно из четырех возможных положений см документацию вложенную
  */
 void ILI9225_setOrientation(uint8_t orientation) {
+#ifdef ILI9225_FIXED_ORIENTATION
+    (void)orientation;
+#else
     ILI9225_orientation = orientation % 4;
+#endif
+    ILI9225_invalidateShadow();
+    ILI9225_scrollReset();
 
     switch (ILI9225_orientation) {
         case 0: // Портрет, нормальный
-            ILI9225_maxX = LCD_WIDTH;   // 176
-            ILI9225_maxY = LCD_HEIGHT;  // 220
-            ILI9225_write(ENTRY_MODE, 0x1038); // AM=0, ID1=1, ID0=1 → горизонтальный инкремент, вертикальный инкремент
+            ILI9225_SET_SIZE(LCD_WIDTH, LCD_HEIGHT);   // 176 x 220
             ILI9225_write(DRIVER_OUTPUT_CTRL, 0x001C); // SM=0, GS=0 → нормальное сканирование
             break;
 
         case 1: // Альбом, поворот на 90°
-            ILI9225_maxX = LCD_HEIGHT;  // 220
-            ILI9225_maxY = LCD_WIDTH;   // 176
-            ILI9225_write(ENTRY_MODE, 0x1030); // AM=1, ID1=1, ID0=0 → вертикальный инкремент, горизонтальный декремент
+            ILI9225_SET_SIZE(LCD_HEIGHT, LCD_WIDTH);   // 220 x 176
             ILI9225_write(DRIVER_OUTPUT_CTRL, 0x001C); // SM=0, GS=0
             break;
 
         case 2: // Портрет, 180°
-            ILI9225_maxX = LCD_WIDTH;
-            ILI9225_maxY = LCD_HEIGHT;
-            ILI9225_write(ENTRY_MODE, 0x1028); // AM=0, ID1=0, ID0=1 → горизонтальный декремент, вертикальный декремент
+            ILI9225_SET_SIZE(LCD_WIDTH, LCD_HEIGHT);
             ILI9225_write(DRIVER_OUTPUT_CTRL, 0x001C);
             break;
 
         case 3: // Альбом, 270°
-            ILI9225_maxX = LCD_HEIGHT;
-            ILI9225_maxY = LCD_WIDTH;
-            ILI9225_write(ENTRY_MODE, 0x1020); // AM=1, ID1=0, ID0=0 → вертикальный декремент, горизонтальный инкремент
+            ILI9225_SET_SIZE(LCD_HEIGHT, LCD_WIDTH);
             ILI9225_write(DRIVER_OUTPUT_CTRL, 0x001C);
             break;
     }
+    ILI9225_write(ENTRY_MODE, ILI9225_entry_mode[ILI9225_orientation]);
+}
+
+/**
+ * @brief Порядок заполнения окна
+ * @param order ILI9225_SCAN_COLUMNS (по умолчанию), ILI9225_SCAN_ROWS
+ * или ILI9225_SCAN_ROWS_UP. После вывода вернуть ILI9225_SCAN_COLUMNS
+ */
+void ILI9225_setScanOrder(uint8_t order) {
+	uint16_t mode = ILI9225_entry_mode[ILI9225_orientation];
+	if (order != ILI9225_SCAN_COLUMNS) mode ^= ILI9225_ENTRY_AM;
+
+	// Логический y идёт по физической вертикали (0, 2) или горизонтали (1, 3)
+	if (order == ILI9225_SCAN_ROWS_UP) {
+		mode ^= (ILI9225_orientation & 1) ? ILI9225_ENTRY_ID0 : ILI9225_ENTRY_ID1;
+	}
+	ILI9225_write(ENTRY_MODE, mode);
+}
+
+/**
+ * @brief Установка адреса GRAM на логическую точку внутри уже открытого окна
+ * Нужна, когда окно заполняется не с левого верхнего угла (ILI9225_SCAN_ROWS_UP)
+ * @param x координата x
+ * @param y координата y
+ */
+void ILI9225_setCursor(uint16_t x, uint16_t y) {
+	ILI9225_orientCoordinates(&x, &y);
+	ILI9225_write(RAM_ADDR_SET1, x);
+	ILI9225_write(RAM_ADDR_SET2, y);
 }
 
 /**
@@ -83,6 +245,7 @@ void ILI9225_setOrientation(uint8_t orientation) {
  * Записью в настроечные регистры конфигурации дисплея
  */
 void ILI9225_init(void) {
+	ILI9225_DMA_init();
 	ILI9225_reset();
 
 	/* Start Initial Sequence */
@@ -148,7 +311,7 @@ void ILI9225_init(void) {
 	ILI9225_setOrientation(0);
 
 	ILI9225_clear();
-	LCD_CS.deactivate();
+	ILI9225_DMA_wait();
 }
 
 /**
@@ -160,6 +323,7 @@ void ILI9225_swap(uint16_t *a, uint16_t *b) {
     *b = w;
 }
 
+#ifndef ILI9225_FIXED_ORIENTATION
 /**
  * @brief Функция по смене системы координат
  */
@@ -182,6 +346,7 @@ void ILI9225_orientCoordinates(uint16_t *x1, uint16_t *y1) {
         break;
     }
 }
+#endif
 
 /**
  * @brief Функция выбора части дисплея для изменения
@@ -191,6 +356,9 @@ void ILI9225_orientCoordinates(uint16_t *x1, uint16_t *y1) {
  * @param y1 координата правого нижнего угла
  */
 void ILI9225_setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+    if (x1 < x0) ILI9225_swap(&x0, &x1);
+    if (y1 < y0) ILI9225_swap(&y0, &y1);
+
 	uint16_t xb = x0;
 	uint16_t xe = x1;
 	uint16_t yb = y0;
@@ -199,8 +367,12 @@ void ILI9225_setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
 	ILI9225_orientCoordinates(&xb, &yb);
 	ILI9225_orientCoordinates(&xe, &ye);
 
-    if (x1 < x0) ILI9225_swap(&xb, &xe);
-    if (y1 < y0) ILI9225_swap(&yb, &ye);
+	// Счетчик адреса идет от образа левого верхнего угла (по ENTRY_MODE),
+	// а границы окна дисплей ждет по возрастанию
+    uint16_t xs = xb;
+    uint16_t ys = yb;
+    if (xe < xb) ILI9225_swap(&xb, &xe);
+    if (ye < yb) ILI9225_swap(&yb, &ye);
 
     ILI9225_write(HORIZONTAL_WINDOW_ADDR1, xe);
     ILI9225_write(HORIZONTAL_WINDOW_ADDR2, xb);
@@ -208,8 +380,8 @@ void ILI9225_setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
     ILI9225_write(VERTICAL_WINDOW_ADDR1, ye);
     ILI9225_write(VERTICAL_WINDOW_ADDR2, yb);
 
-    ILI9225_write(RAM_ADDR_SET1, xb);
-    ILI9225_write(RAM_ADDR_SET2, yb);
+    ILI9225_write(RAM_ADDR_SET1, xs);
+    ILI9225_write(RAM_ADDR_SET2, ys);
 }
 
 /**
@@ -221,13 +393,10 @@ void ILI9225_setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
 void ILI9225_drawPixel(uint16_t x1, uint16_t y1, uint16_t color) {
     if ((x1 >= ILI9225_maxX) || (y1 >= ILI9225_maxY)) return;
 
-	uint16_t x = x1;
-	uint16_t y = y1;
-
-    ILI9225_orientCoordinates(&x, &y);
-    ILI9225_write(RAM_ADDR_SET1,x);
-    ILI9225_write(RAM_ADDR_SET2,y);
-    ILI9225_write(GRAM_DATA_REG,color);
+	// Адрес GRAM должен попадать в окно, а примитивы оставляют окно маленьким.
+	// Окно в одну точку: при том же окне теневые копии срежут лишние записи
+	ILI9225_setWindow(x1, y1, x1, y1);
+	ILI9225_write(GRAM_DATA_REG, color);
 }
 
 /**
@@ -235,16 +404,254 @@ void ILI9225_drawPixel(uint16_t x1, uint16_t y1, uint16_t color) {
  */
 void ILI9225_clear(void) {
 	uint16_t size = LCD_WIDTH*LCD_HEIGHT;
-	int i = 0;
-		
-    ILI9225_setWindow(0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1);
+
+    // Окно в логических координатах: в альбомных ориентациях это 220x176
+    ILI9225_setWindow(0, 0, ILI9225_maxX - 1, ILI9225_maxY - 1);
 
     ILI9225_writeIndex(GRAM_DATA_REG);
-	LCD_CS.activate();
-    for(i = 0; i< size; i++)
-    {
-    	SPI_send_16bit(SPI2, COLOR_BLACK);
-    }
+    ILI9225_DMA_fillColor(COLOR_BLACK, size);
+}
+
+/**
+ * @brief Идет ли ось прокрутки навстречу строкам затворов
+ * В ориентациях 2 и 3 логическая координата вдоль оси прокрутки
+ * отражена относительно физической
+ */
+static uint8_t ILI9225_scrollReversed(void) {
+	return (ILI9225_orientation == 2) || (ILI9225_orientation == 3);
+}
+
+/**
+ * @brief Перевод строки вдоль оси прокрутки: логическая <-> физическая
+ */
+static uint16_t ILI9225_scrollFlip(uint16_t line) {
+	return ILI9225_scrollReversed() ? (LCD_HEIGHT - 1 - line) : line;
+}
+
+/**
+ * @brief Запись области и смещения прокрутки в дисплей
+ */
+static void ILI9225_scrollApply(void) {
+	uint16_t ssa = ILI9225_scrollFlip(ILI9225_scroll_start);
+	uint16_t sea = ILI9225_scrollFlip(ILI9225_scroll_end);
+	if (sea < ssa) ILI9225_swap(&ssa, &sea);
+
+	uint16_t lines = sea - ssa + 1;
+	uint16_t sst = ILI9225_scroll_offset % lines;
+	if (ILI9225_scrollReversed() && sst) sst = lines - sst;
+
+	ILI9225_write(VERTICAL_SCROLL_CTRL1, sea);
+	ILI9225_write(VERTICAL_SCROLL_CTRL2, ssa);
+	ILI9225_write(VERTICAL_SCROLL_CTRL3, sst);
+}
+
+/**
+ * @brief Задание области прокрутки, смещение сбрасывается в 0
+ * @param start первая строка области вдоль оси прокрутки
+ * @param end последняя строка области вдоль оси прокрутки
+ */
+void ILI9225_scrollSetArea(uint16_t start, uint16_t end) {
+	if (end < start) ILI9225_swap(&start, &end);
+	if (end >= LCD_HEIGHT) end = LCD_HEIGHT - 1;
+	if (start > end) start = end;
+
+	ILI9225_scroll_start  = start;
+	ILI9225_scroll_end    = end;
+	ILI9225_scroll_offset = 0;
+	ILI9225_scrollApply();
+}
+
+/**
+ * @brief Установка смещения прокрутки
+ * @param offset на сколько строк содержимое сдвинуто к началу области
+ */
+void ILI9225_scrollTo(uint16_t offset) {
+	ILI9225_scroll_offset = offset % (ILI9225_scroll_end - ILI9225_scroll_start + 1);
+	ILI9225_scrollApply();
+}
+
+/**
+ * @brief Сдвиг содержимого области на lines строк к ее началу
+ * Освободившиеся в конце строки нужно дорисовать через ILI9225_scrollLine()
+ * @param lines количество строк (отрицательное - в обратную сторону)
+ */
+void ILI9225_scrollBy(int16_t lines) {
+	int32_t size = ILI9225_scroll_end - ILI9225_scroll_start + 1;
+	int32_t offset = ((int32_t)ILI9225_scroll_offset + lines) % size;
+	if (offset < 0) offset += size;
+	ILI9225_scrollTo(offset);
+}
+
+/**
+ * @brief Текущее смещение прокрутки
+ */
+uint16_t ILI9225_scrollOffset(void) {
+	return ILI9225_scroll_offset;
+}
+
+/**
+ * @brief Куда рисовать, чтобы строка оказалась на экране в позиции line
+ * @param line видимая строка вдоль оси прокрутки
+ * @return строка в памяти дисплея вдоль той же оси
+ */
+uint16_t ILI9225_scrollLine(uint16_t line) {
+	if (line < ILI9225_scroll_start || line > ILI9225_scroll_end) return line;
+
+	uint16_t size = ILI9225_scroll_end - ILI9225_scroll_start + 1;
+	return ILI9225_scroll_start + (line - ILI9225_scroll_start + ILI9225_scroll_offset) % size;
+}
+
+/**
+ * @brief Отключение прокрутки (вся высота, смещение 0)
+ */
+void ILI9225_scrollReset(void) {
+	ILI9225_scrollSetArea(0, LCD_HEIGHT - 1);
+}
+
+/**
+ * @brief Заливка прямоугольника с обрезкой по экрану
+ * Координаты знаковые, чтобы круг и линии могли выходить за край
+ */
+static void ILI9225_fillRectClip(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+	if (x < 0) { w += x; x = 0; }
+	if (y < 0) { h += y; y = 0; }
+	if (x + w > ILI9225_maxX) w = ILI9225_maxX - x;
+	if (y + h > ILI9225_maxY) h = ILI9225_maxY - y;
+	if (w <= 0 || h <= 0) return;
+
+	ILI9225_setWindow(x, y, x + w - 1, y + h - 1);
+	ILI9225_writeIndex(GRAM_DATA_REG);
+	ILI9225_DMA_fillColor(color, (uint32_t)w * h);
+}
+
+/**
+ * @brief Заливка прямоугольника
+ * @param x координата левого верхнего угла
+ * @param y координата левого верхнего угла
+ * @param w ширина
+ * @param h высота
+ * @param color цвет заливки
+ */
+void ILI9225_fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+	ILI9225_fillRectClip(x, y, w, h, color);
+}
+
+/**
+ * @brief Горизонтальная линия
+ * @param x координата начала
+ * @param y координата начала
+ * @param w длина
+ * @param color цвет линии
+ */
+void ILI9225_drawHLine(uint16_t x, uint16_t y, uint16_t w, uint16_t color) {
+	ILI9225_fillRectClip(x, y, w, 1, color);
+}
+
+/**
+ * @brief Вертикальная линия
+ * @param x координата начала
+ * @param y координата начала
+ * @param h длина
+ * @param color цвет линии
+ */
+void ILI9225_drawVLine(uint16_t x, uint16_t y, uint16_t h, uint16_t color) {
+	ILI9225_fillRectClip(x, y, 1, h, color);
+}
+
+/**
+ * @brief Контур прямоугольника
+ * @param x координата левого верхнего угла
+ * @param y координата левого верхнего угла
+ * @param w ширина
+ * @param h высота
+ * @param color цвет линии
+ */
+void ILI9225_drawRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+	if (w == 0 || h == 0) return;
+
+	ILI9225_drawHLine(x, y, w, color);
+	if (h > 1) ILI9225_drawHLine(x, y + h - 1, w, color);
+	if (h > 2) {
+		ILI9225_drawVLine(x, y + 1, h - 2, color);
+		if (w > 1) ILI9225_drawVLine(x + w - 1, y + 1, h - 2, color);
+	}
+}
+
+/**
+ * @brief Линия между двумя точками (Брезенхем, рисуется отрезками)
+ * Пиксели с одинаковой второй координатой собираются в отрезок,
+ * и на каждый отрезок открывается только одно окно
+ * @param x0 координата начала
+ * @param y0 координата начала
+ * @param x1 координата конца
+ * @param y1 координата конца
+ * @param color цвет линии
+ */
+void ILI9225_drawLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color) {
+	int32_t ax = x0, ay = y0, bx = x1, by = y1;
+	int32_t t;
+
+	uint8_t steep = ((by > ay) ? by - ay : ay - by) > ((bx > ax) ? bx - ax : ax - bx);
+	if (steep) {
+		t = ax; ax = ay; ay = t;
+		t = bx; bx = by; by = t;
+	}
+	if (ax > bx) {
+		t = ax; ax = bx; bx = t;
+		t = ay; ay = by; by = t;
+	}
+
+	int32_t dx = bx - ax;
+	int32_t dy = (by > ay) ? by - ay : ay - by;
+	int32_t err = dx / 2;
+	int32_t ystep = (ay < by) ? 1 : -1;
+	int32_t run_start = ax;
+	int32_t y = ay;
+
+	for (int32_t x = ax; x <= bx; x++) {
+		err -= dy;
+		if (err < 0 || x == bx) {
+			if (steep) ILI9225_fillRectClip(y, run_start, 1, x - run_start + 1, color);
+			else       ILI9225_fillRectClip(run_start, y, x - run_start + 1, 1, color);
+			y += ystep;
+			err += dx;
+			run_start = x + 1;
+		}
+	}
+}
+
+/**
+ * @brief Закрашенный круг
+ * Строки с одинаковой полушириной объединяются в один прямоугольник
+ * @param x0 координата центра
+ * @param y0 координата центра
+ * @param r радиус
+ * @param color цвет заливки
+ */
+void ILI9225_fillCircle(uint16_t x0, uint16_t y0, uint16_t r, uint16_t color) {
+	int32_t rr = (int32_t)r * r;
+	int32_t dx = r;
+	int32_t band_y = 0;	// первая строка текущей полосы одинаковой ширины
+
+	for (int32_t dy = 0; dy <= r; dy++) {
+		while (dx * dx + dy * dy > rr) dx--;
+
+		// Ширина на следующей строке будет другой - рисуем накопленную полосу
+		int32_t next_dx = dx;
+		if (dy < r) {
+			while (next_dx * next_dx + (dy + 1) * (dy + 1) > rr) next_dx--;
+		}
+		if (dy == r || next_dx != dx) {
+			int32_t h = dy - band_y + 1;
+			if (band_y == 0) {
+				ILI9225_fillRectClip((int32_t)x0 - dx, (int32_t)y0 - dy, 2 * dx + 1, 2 * dy + 1, color);
+			} else {
+				ILI9225_fillRectClip((int32_t)x0 - dx, (int32_t)y0 - dy, 2 * dx + 1, h, color);
+				ILI9225_fillRectClip((int32_t)x0 - dx, (int32_t)y0 + band_y, 2 * dx + 1, h, color);
+			}
+			band_y = dy + 1;
+		}
+	}
 }
 
 /**
@@ -254,6 +661,89 @@ void ILI9225_clear(void) {
  */
 void ILI9225_Draw_File(uint8_t const *data, uint16_t len_b) {
 	for(int i = 0; i < len_b; i+=3) {
-		SPI_send_16bit(SPI2, RGB888_RGB565(data[i+2]<<16 | data[i + 1] << 8 | data[i]));
+		SPI_write_16bit(SPI2, RGB888_RGB565(data[i+2]<<16 | data[i + 1] << 8 | data[i]));
     }
-}	
\ No newline at end of file
+	SPI_wait_idle(SPI2);
+}	
+
+/**
+ * @brief Настройка DMA1 канал 5 на передачу в SPI2->DR
+ */
+void ILI9225_DMA_init(void) {
+	RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+
+	DMA1_Channel5->CCR  = 0;
+	DMA1_Channel5->CPAR = (uint32_t)&SPI2->DR;
+	DMA1->IFCR = DMA_IFCR_CGIF5;
+
+	// Выше кнопок (EXTI = 2), иначе ожидание из их обработчиков зависнет
+	NVIC_SetPriority(DMA1_Channel5_IRQn, 1);
+	NVIC_EnableIRQ(DMA1_Channel5_IRQn);
+}
+
+/**
+ * @brief Передача массива пикселей через DMA (без ожидания окончания)
+ * @param pixels массив пикселей RGB565, должен жить до конца передачи
+ * @param count количество пикселей
+ */
+void ILI9225_DMA_sendPixels(uint16_t const *pixels, uint32_t count) {
+	ILI9225_DMA_start(pixels, count, 1);
+}
+
+/**
+ * @brief Передача count копий одного цвета через DMA (без ожидания окончания)
+ * @param color цвет RGB565
+ * @param count количество пикселей
+ */
+void ILI9225_DMA_fillColor(uint16_t color, uint32_t count) {
+	ILI9225_DMA_wait();
+	ILI9225_dma_color = color;
+	ILI9225_DMA_start(&ILI9225_dma_color, count, 0);
+}
+
+/**
+ * @brief Идет ли сейчас передача через DMA
+ * @return 1 если передача не закончена, 0 если канал свободен
+ */
+uint8_t ILI9225_DMA_busy(void) {
+	return ILI9225_dma_busy;
+}
+
+/**
+ * @brief Ожидание окончания передачи через DMA
+ */
+void ILI9225_DMA_wait(void) {
+	while (ILI9225_dma_busy) {};
+}
+
+/**
+ * @brief Функция которая вызовется из прерывания по окончанию передачи
+ * @param callback указатель на функцию или NULL
+ */
+void ILI9225_DMA_setCallback(void (*callback)(void)) {
+	ILI9225_dma_callback = callback;
+}
+
+/**
+ * @brief Обработчик прерывания DMA1 канал 5
+ * Догружает следующую порцию, а в конце дожидается ухода последнего
+ * слова из сдвигового регистра и отпускает CS
+ */
+void DMA1_Channel5_IRQHandler(void) {
+	if (!(DMA1->ISR & DMA_ISR_TCIF5)) return;
+	DMA1->IFCR = DMA_IFCR_CGIF5;
+
+	if (ILI9225_dma_left) {
+		ILI9225_DMA_startChunk();
+		return;
+	}
+
+	DMA1_Channel5->CCR = 0;
+	SPI_wait_idle(SPI2);
+
+	SPI2->CR2 &= ~SPI_CR2_TXDMAEN;
+	LCD_CS.deactivate();
+
+	ILI9225_dma_busy = 0;
+	if (ILI9225_dma_callback) ILI9225_dma_callback();
+}
@@ -14,9 +14,28 @@
 	// ILI9225 screen size
 	#define LCD_WIDTH  				176
 	#define LCD_HEIGHT 				220
+
+	// Ориентацию можно зафиксировать при сборке: -DILI9225_FIXED_ORIENTATION=0..3
+	// (в CMake: -DLCD_ORIENTATION=0..3). Тогда ориентация, размеры и перевод
+	// координат становятся константами, а ILI9225_setOrientation() игнорирует
+	// аргумент. Без этого дефайна ориентация выбирается во время работы.
+#ifdef ILI9225_FIXED_ORIENTATION
+	#if (ILI9225_FIXED_ORIENTATION < 0) || (ILI9225_FIXED_ORIENTATION > 3)
+		#error "ILI9225_FIXED_ORIENTATION must be 0..3"
+	#endif
+	#define ILI9225_orientation		((uint8_t)ILI9225_FIXED_ORIENTATION)
+	#if (ILI9225_FIXED_ORIENTATION & 1)
+		#define ILI9225_maxX		((uint16_t)LCD_HEIGHT)
+		#define ILI9225_maxY		((uint16_t)LCD_WIDTH)
+	#else
+		#define ILI9225_maxX		((uint16_t)LCD_WIDTH)
+		#define ILI9225_maxY		((uint16_t)LCD_HEIGHT)
+	#endif
+#else
 	extern uint8_t  ILI9225_orientation;
 	extern uint16_t  ILI9225_maxX;
 	extern uint16_t  ILI9225_maxY;
+#endif
 
 	/**
 	 * @brief Сброс дисплея или его активация
@@ -38,12 +57,31 @@
 	void ILI9225_write(uint16_t address, uint16_t data);
 
 
+	/**
+	 * @brief Сброс теневых копий регистров окна, адреса GRAM и ENTRY_MODE
+	 * Вызывать если регистры дисплея могли измениться в обход драйвера
+	 * (сброс, смена ориентации)
+	 */
+	void ILI9225_invalidateShadow(void);
+
 	/**
 	 * @brief Изменение ориентации дисплея
 	 * @param orientation одно из четырех возможных положений см документацию вложенную
 	 */
 	void ILI9225_setOrientation(uint8_t orientation);
 
+	// Порядок заполнения окна при записи в GRAM
+	#define ILI9225_SCAN_COLUMNS	0	// по столбцам: x снаружи, y внутри (по умолчанию)
+	#define ILI9225_SCAN_ROWS		1	// по строкам сверху вниз
+	#define ILI9225_SCAN_ROWS_UP	2	// по строкам снизу вверх (BMP), начинать с ILI9225_setCursor(x0, y1)
+
+	/**
+	 * @brief Порядок заполнения окна
+	 * @param order ILI9225_SCAN_COLUMNS (по умолчанию), ILI9225_SCAN_ROWS
+	 * или ILI9225_SCAN_ROWS_UP. После вывода вернуть ILI9225_SCAN_COLUMNS
+	 */
+	void ILI9225_setScanOrder(uint8_t order);
+
 	/**
 	 * @brief Инициализация дисплея
 	 * Записью в настроечные регистры конфигурации дисплея
@@ -58,7 +96,27 @@
 	/**
 	 * @brief Функция по смене системы координат
 	 */
+#ifdef ILI9225_FIXED_ORIENTATION
+	static inline void ILI9225_orientCoordinates(uint16_t *x1, uint16_t *y1) {
+	#if (ILI9225_FIXED_ORIENTATION == 1)
+		uint16_t x = *x1;
+		*x1 = ILI9225_maxY - *y1 - 1;
+		*y1 = x;
+	#elif (ILI9225_FIXED_ORIENTATION == 2)
+		*x1 = ILI9225_maxX - *x1 - 1;
+		*y1 = ILI9225_maxY - *y1 - 1;
+	#elif (ILI9225_FIXED_ORIENTATION == 3)
+		uint16_t x = *x1;
+		*x1 = *y1;
+		*y1 = ILI9225_maxX - x - 1;
+	#else
+		(void)x1;
+		(void)y1;
+	#endif
+	}
+#else
 	void ILI9225_orientCoordinates(uint16_t *x1, uint16_t *y1);
+#endif
 
 	/**
 	 * @brief Функция выбора части дисплея для изменения
@@ -69,6 +127,14 @@
 	 */
 	void ILI9225_setWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
 
+	/**
+	 * @brief Установка адреса GRAM на логическую точку внутри уже открытого окна
+	 * Нужна, когда окно заполняется не с левого верхнего угла (ILI9225_SCAN_ROWS_UP)
+	 * @param x координата x
+	 * @param y координата y
+	 */
+	void ILI9225_setCursor(uint16_t x, uint16_t y);
+
 	/**
 	 * @brief Функция закращивания пикселя по координатам
 	 * @param x1 координата x пикселя
@@ -82,11 +148,164 @@
 	 */
 	void ILI9225_clear(void);
 
+	// -----------------------------------------------------------------------------
+	// Аппаратная вертикальная прокрутка (VERTICAL_SCROLL_CTRL1..3)
+	// Дисплей прокручивает строки затворов (220 штук), поэтому ось прокрутки
+	// в портретной ориентации (0, 2) - это y, а в альбомной (1, 3) - это x.
+	// Все координаты ниже логические, вдоль оси прокрутки, перевод в
+	// физические строки с учетом ориентации делает драйвер.
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Задание области прокрутки, смещение сбрасывается в 0
+	 * @param start первая строка области вдоль оси прокрутки
+	 * @param end последняя строка области вдоль оси прокрутки
+	 */
+	void ILI9225_scrollSetArea(uint16_t start, uint16_t end);
+
+	/**
+	 * @brief Установка смещения прокрутки
+	 * @param offset на сколько строк содержимое сдвинуто к началу области
+	 */
+	void ILI9225_scrollTo(uint16_t offset);
+
+	/**
+	 * @brief Сдвиг содержимого области на lines строк к ее началу
+	 * Освободившиеся в конце строки нужно дорисовать через ILI9225_scrollLine()
+	 * @param lines количество строк (отрицательное - в обратную сторону)
+	 */
+	void ILI9225_scrollBy(int16_t lines);
+
+	/**
+	 * @brief Текущее смещение прокрутки
+	 */
+	uint16_t ILI9225_scrollOffset(void);
+
+	/**
+	 * @brief Куда рисовать, чтобы строка оказалась на экране в позиции line
+	 * @param line видимая строка вдоль оси прокрутки
+	 * @return строка в памяти дисплея вдоль той же оси
+	 */
+	uint16_t ILI9225_scrollLine(uint16_t line);
+
+	/**
+	 * @brief Отключение прокрутки (вся высота, смещение 0)
+	 */
+	void ILI9225_scrollReset(void);
+
+	// -----------------------------------------------------------------------------
+	// Примитивы: одно окно на каждый отрезок, пиксели уходят через DMA
+	// Все примитивы обрезаются по границам экрана
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Заливка прямоугольника
+	 * @param x координата левого верхнего угла
+	 * @param y координата левого верхнего угла
+	 * @param w ширина
+	 * @param h высота
+	 * @param color цвет заливки
+	 */
+	void ILI9225_fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+
+	/**
+	 * @brief Горизонтальная линия
+	 * @param x координата начала
+	 * @param y координата начала
+	 * @param w длина
+	 * @param color цвет линии
+	 */
+	void ILI9225_drawHLine(uint16_t x, uint16_t y, uint16_t w, uint16_t color);
+
+	/**
+	 * @brief Вертикальная линия
+	 * @param x координата начала
+	 * @param y координата начала
+	 * @param h длина
+	 * @param color цвет линии
+	 */
+	void ILI9225_drawVLine(uint16_t x, uint16_t y, uint16_t h, uint16_t color);
+
+	/**
+	 * @brief Контур прямоугольника
+	 * @param x координата левого верхнего угла
+	 * @param y координата левого верхнего угла
+	 * @param w ширина
+	 * @param h высота
+	 * @param color цвет линии
+	 */
+	void ILI9225_drawRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+
+	/**
+	 * @brief Линия между двумя точками (Брезенхем, рисуется отрезками)
+	 * @param x0 координата начала
+	 * @param y0 координата начала
+	 * @param x1 координата конца
+	 * @param y1 координата конца
+	 * @param color цвет линии
+	 */
+	void ILI9225_drawLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color);
+
+	/**
+	 * @brief Закрашенный круг
+	 * @param x0 координата центра
+	 * @param y0 координата центра
+	 * @param r радиус
+	 * @param color цвет заливки
+	 */
+	void ILI9225_fillCircle(uint16_t x0, uint16_t y0, uint16_t r, uint16_t color);
+
 	/**
 	 * @brief Отправка на дисплей массива данных 
 	 * @param data данные которые нужно отправить
 	 * @param len_b длинна массива
 	 */
 	void ILI9225_Draw_File(uint8_t const *data, uint16_t len_b);
+
+	// -----------------------------------------------------------------------------
+	// Потоковая передача пикселей через DMA1 канал 5 (SPI2_TX)
+	// Перед вызовом должно быть открыто окно и выбран GRAM_DATA_REG
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Настройка DMA1 канал 5 на передачу в SPI2->DR
+	 */
+	void ILI9225_DMA_init(void);
+
+	/**
+	 * @brief Передача массива пикселей через DMA (без ожидания окончания)
+	 * @param pixels массив пикселей RGB565, должен жить до конца передачи
+	 * @param count количество пикселей
+	 */
+	void ILI9225_DMA_sendPixels(uint16_t const *pixels, uint32_t count);
+
+	/**
+	 * @brief Передача count копий одного цвета через DMA (без ожидания окончания)
+	 * @param color цвет RGB565
+	 * @param count количество пикселей
+	 */
+	void ILI9225_DMA_fillColor(uint16_t color, uint32_t count);
+
+	/**
+	 * @brief Идет ли сейчас передача через DMA
+	 * @return 1 если передача не закончена, 0 если канал свободен
+	 */
+	uint8_t ILI9225_DMA_busy(void);
+
+	/**
+	 * @brief Ожидание окончания передачи через DMA
+	 */
+	void ILI9225_DMA_wait(void);
+
+	/**
+	 * @brief Функция которая вызовется из прерывания по окончанию передачи
+	 * @param callback указатель на функцию или NULL
+	 */
+	void ILI9225_DMA_setCallback(void (*callback)(void));
+
+	/**
+	 * @brief Обработчик прерывания DMA1 канал 5
+	 */
+	void DMA1_Channel5_IRQHandler(void);
 	
 #endif /* SRC_ILI9225_H_ */
@@ -0,0 +1,183 @@
+#include "band.h"
+
+
+typedef enum {
+	BAND_OP_RECT,
+	BAND_OP_TEXT,
+	BAND_OP_BITMAP
+} band_op_type_t;
+
+typedef struct {
+	band_op_type_t type;
+	uint16_t x;
+	uint16_t y;
+	uint16_t w;
+	uint16_t h;
+	uint16_t color;
+	const void *data;	// строка или пиксели
+} band_op_t;
+
+static uint16_t  band_buf[2][BAND_PIXELS];
+static band_op_t band_ops[BAND_MAX_OPS];
+static uint8_t   band_op_count = 0;
+
+static uint16_t band_x = 0;
+static uint16_t band_y = 0;
+static uint16_t band_w = 0;
+static uint16_t band_h = 0;
+static uint16_t band_bg = 0;
+
+/**
+ * @brief Добавление примитива в список кадра
+ */
+static void band_addOp(band_op_type_t type, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                       uint16_t color, const void *data) {
+	if (band_op_count >= BAND_MAX_OPS || w == 0 || h == 0) return;
+
+	band_op_t *op = &band_ops[band_op_count++];
+	op->type  = type;
+	op->x     = x;
+	op->y     = y;
+	op->w     = w;
+	op->h     = h;
+	op->color = color;
+	op->data  = data;
+}
+
+/**
+ * @brief Растеризация одного примитива в полосу
+ * @param op примитив
+ * @param buf буфер полосы
+ * @param col0 первый экранный столбец полосы
+ * @param cols количество столбцов в полосе
+ */
+static void band_rasterOp(band_op_t const *op, uint16_t *buf, uint16_t col0, uint16_t cols) {
+	// Пересечение примитива с полосой по x и с окном по y
+	uint16_t c_begin = (op->x > col0) ? op->x : col0;
+	uint16_t c_end   = ((op->x + op->w) < (col0 + cols)) ? (op->x + op->w) : (col0 + cols);
+	uint16_t r_begin = (op->y > band_y) ? op->y : band_y;
+	uint16_t r_end   = ((op->y + op->h) < (band_y + band_h)) ? (op->y + op->h) : (band_y + band_h);
+	if (c_begin >= c_end || r_begin >= r_end) return;
+
+	for (uint16_t col = c_begin; col < c_end; col++) {
+		uint16_t *dst = buf + (uint32_t)(col - col0) * band_h + (r_begin - band_y);
+
+		switch (op->type) {
+		case BAND_OP_RECT:
+			for (uint16_t row = r_begin; row < r_end; row++) *dst++ = op->color;
+			break;
+
+		case BAND_OP_TEXT: {
+			const char *str = (const char *)op->data;
+			uint16_t dx = col - op->x;
+			uint16_t bits = Font8x16[(unsigned char)str[dx / FONT_8x16_WIDTH]][dx % FONT_8x16_WIDTH];
+			for (uint16_t row = r_begin; row < r_end; row++, dst++) {
+				if (bits & (1 << (15 - (row - op->y)))) *dst = op->color;
+			}
+			break;
+		}
+
+		case BAND_OP_BITMAP: {
+			uint16_t const *src = (uint16_t const *)op->data +
+			                      (uint32_t)(r_begin - op->y) * op->w + (col - op->x);
+			for (uint16_t row = r_begin; row < r_end; row++) {
+				*dst++ = *src;
+				src += op->w;
+			}
+			break;
+		}
+		}
+	}
+}
+
+/**
+ * @brief Начало сборки окна
+ * @param x координата левого верхнего угла окна
+ * @param y координата левого верхнего угла окна
+ * @param w ширина окна
+ * @param h высота окна
+ * @param bg цвет фона окна
+ */
+void band_begin(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t bg) {
+	if (x >= ILI9225_maxX || y >= ILI9225_maxY) w = h = 0;
+	if (x + w > ILI9225_maxX) w = ILI9225_maxX - x;
+	if (y + h > ILI9225_maxY) h = ILI9225_maxY - y;
+	if (h > BAND_PIXELS) h = BAND_PIXELS;
+
+	band_x = x;
+	band_y = y;
+	band_w = w;
+	band_h = h;
+	band_bg = bg;
+	band_op_count = 0;
+}
+
+/**
+ * @brief Залитый прямоугольник (координаты экранные)
+ * @param x координата левого верхнего угла
+ * @param y координата левого верхнего угла
+ * @param w ширина
+ * @param h высота
+ * @param color цвет заливки
+ */
+void band_fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+	band_addOp(BAND_OP_RECT, x, y, w, h, color, 0);
+}
+
+/**
+ * @brief Строка шрифтом 8x16, рисуются только пиксели символа
+ * @param x координата начала строки
+ * @param y координата начала строки
+ * @param str строка, должна жить до band_end()
+ * @param color цвет символов
+ */
+void band_drawString8x16(uint16_t x, uint16_t y, const char *str, uint16_t color) {
+	band_addOp(BAND_OP_TEXT, x, y, strlen(str) * FONT_8x16_WIDTH, FONT_8x16_HEIGHT, color, str);
+}
+
+/**
+ * @brief Картинка RGB565, строки сверху вниз
+ * @param x координата левого верхнего угла
+ * @param y координата левого верхнего угла
+ * @param w ширина картинки
+ * @param h высота картинки
+ * @param pixels пиксели (w * h), должны жить до band_end()
+ */
+void band_drawBitmap(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t const *pixels) {
+	band_addOp(BAND_OP_BITMAP, x, y, w, h, 0, pixels);
+}
+
+/**
+ * @brief Растеризация всех примитивов по полосам и отправка на дисплей
+ *
+ * Буфер, в который рисуется полоса, свободен: DMA_sendPixels() перед
+ * стартом ждет окончания предыдущей передачи, а она шла из этого же буфера
+ * две полосы назад.
+ */
+void band_end(void) {
+	if (band_w == 0 || band_h == 0) return;
+
+	uint16_t cols_per_band = BAND_PIXELS / band_h;
+	uint8_t  cur = 0;
+
+	ILI9225_setWindow(band_x, band_y, band_x + band_w - 1, band_y + band_h - 1);
+	ILI9225_writeIndex(GRAM_DATA_REG);
+
+	for (uint16_t c = 0; c < band_w; c += cols_per_band) {
+		uint16_t cols = band_w - c;
+		if (cols > cols_per_band) cols = cols_per_band;
+
+		uint16_t *buf = band_buf[cur];
+		uint32_t pixels = (uint32_t)cols * band_h;
+
+		for (uint32_t i = 0; i < pixels; i++) buf[i] = band_bg;
+		for (uint8_t i = 0; i < band_op_count; i++) {
+			band_rasterOp(&band_ops[i], buf, band_x + c, cols);
+		}
+
+		ILI9225_DMA_sendPixels(buf, pixels);
+		cur ^= 1;
+	}
+
+	band_op_count = 0;
+}
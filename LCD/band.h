@@ -0,0 +1,73 @@
+#ifndef SRC_BAND_H_
+
+	#define SRC_BAND_H_
+
+	#include "stm32f1xx.h"
+	#include "ILI9225.h"
+	#include "fonts.h"
+
+	/*
+	 * Полосовой рендер: вся картинка окна собирается в ОЗУ по полосам,
+	 * пока DMA отправляет одну полосу, процессор рисует следующую.
+	 * Полный кадр 176x220 (77 КБ) в 20 КБ не влезает, а две полосы
+	 * по BAND_PIXELS пикселей - 880 байт.
+	 *
+	 * Порядок пикселей в полосе такой же как у drawChar8x16():
+	 * столбец за столбцом, внутри столбца сверху вниз.
+	 *
+	 * Использование:
+	 *   band_begin(x, y, w, h, COLOR_BLACK);
+	 *   band_fillRect(...);
+	 *   band_drawString8x16(...);
+	 *   band_end();  // здесь все и рисуется
+	 */
+
+	#define BAND_PIXELS			LCD_HEIGHT	// размер одного буфера полосы в пикселях
+	#define BAND_MAX_OPS		16			// сколько примитивов можно положить в один кадр
+
+	/**
+	 * @brief Начало сборки окна
+	 * @param x координата левого верхнего угла окна
+	 * @param y координата левого верхнего угла окна
+	 * @param w ширина окна
+	 * @param h высота окна
+	 * @param bg цвет фона окна
+	 */
+	void band_begin(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t bg);
+
+	/**
+	 * @brief Залитый прямоугольник (координаты экранные)
+	 * @param x координата левого верхнего угла
+	 * @param y координата левого верхнего угла
+	 * @param w ширина
+	 * @param h высота
+	 * @param color цвет заливки
+	 */
+	void band_fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+
+	/**
+	 * @brief Строка шрифтом 8x16, рисуются только пиксели символа
+	 * (фон под строкой - то, что нарисовано раньше)
+	 * @param x координата начала строки
+	 * @param y координата начала строки
+	 * @param str строка, должна жить до band_end()
+	 * @param color цвет символов
+	 */
+	void band_drawString8x16(uint16_t x, uint16_t y, const char *str, uint16_t color);
+
+	/**
+	 * @brief Картинка RGB565, строки сверху вниз
+	 * @param x координата левого верхнего угла
+	 * @param y координата левого верхнего угла
+	 * @param w ширина картинки
+	 * @param h высота картинки
+	 * @param pixels пиксели (w * h), должны жить до band_end()
+	 */
+	void band_drawBitmap(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t const *pixels);
+
+	/**
+	 * @brief Растеризация всех примитивов по полосам и отправка на дисплей
+	 */
+	void band_end(void);
+
+#endif /* SRC_BAND_H_ */
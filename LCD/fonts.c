@@ -262,32 +262,154 @@ const uint16_t Font8x16[256][8]={
 };
 
 
+//   4    4     
+static uint16_t font_lut[16][4];
+static uint16_t font_lut_color = 0;
+static uint16_t font_lut_bg_color = 0;
+static uint8_t  font_lut_valid = 0;
+
+#if (FONT_GLYPH_CACHE_SIZE > 0)
+//         (LRU)
+typedef struct {
+    uint16_t tile[FONT_GLYPH_PIXELS];
+    uint16_t color;
+    uint16_t bg_color;
+    uint32_t last_used;
+    uint8_t  ch;
+    uint8_t  valid;
+} font_cache_entry_t;
+
+static font_cache_entry_t font_cache[FONT_GLYPH_CACHE_SIZE];
+static uint32_t font_cache_tick = 0;
+#else
+//   -     :
+//  DMA  ,  
+static uint16_t font_glyph_buf[2][FONT_GLYPH_PIXELS];
+static uint8_t  font_glyph_buf_index = 0;
+#endif
+static uint32_t font_cache_hits = 0;
+static uint32_t font_cache_misses = 0;
+
+
+//       (  )
+static void font_build_lut(uint16_t color, uint16_t bg_color) {
+    if (font_lut_valid && font_lut_color == color && font_lut_bg_color == bg_color) return;
+
+    for (uint8_t n = 0; n < 16; n++) {
+        for (uint8_t b = 0; b < 4; b++) {
+            font_lut[n][b] = (n & (8 >> b)) ? color : bg_color;
+        }
+    }
+    font_lut_color = color;
+    font_lut_bg_color = bg_color;
+    font_lut_valid = 1;
+}
+
+//    : 8   16 ,   - 
+static void font_expand_glyph(uint16_t *dst, unsigned char uc) {
+    for (uint8_t col = 0; col < MENU_ITEM_WIDTH; col++) {
+        uint16_t bits = Font8x16[uc][col];
+        for (int8_t shift = 12; shift >= 0; shift -= 4) {
+            uint16_t const *p = font_lut[(bits >> shift) & 0x0F];
+            *dst++ = p[0];
+            *dst++ = p[1];
+            *dst++ = p[2];
+            *dst++ = p[3];
+        }
+    }
+}
+
+//   :      .
+//       DMA
+static uint16_t const *font_get_glyph(unsigned char uc, uint16_t color, uint16_t bg_color) {
+#if (FONT_GLYPH_CACHE_SIZE > 0)
+    font_cache_entry_t *victim = &font_cache[0];
+
+    for (uint8_t i = 0; i < FONT_GLYPH_CACHE_SIZE; i++) {
+        font_cache_entry_t *e = &font_cache[i];
+        if (e->valid && e->ch == uc && e->color == color && e->bg_color == bg_color) {
+            e->last_used = ++font_cache_tick;
+            font_cache_hits++;
+            return e->tile;
+        }
+        if (!e->valid) {
+            if (victim->valid) victim = e;
+        } else if (victim->valid && e->last_used < victim->last_used) {
+            victim = e;
+        }
+    }
+
+    //       DMA (  1 )
+    if (victim->valid) ILI9225_DMA_wait();
+
+    font_build_lut(color, bg_color);
+    font_expand_glyph(victim->tile, uc);
+    victim->ch = uc;
+    victim->color = color;
+    victim->bg_color = bg_color;
+    victim->valid = 1;
+    victim->last_used = ++font_cache_tick;
+    font_cache_misses++;
+    return victim->tile;
+#else
+    //  :   DMA   ,
+    //       
+    uint16_t *buf = font_glyph_buf[font_glyph_buf_index];
+    font_glyph_buf_index ^= 1;
+
+    font_build_lut(color, bg_color);
+    font_expand_glyph(buf, uc);
+    font_cache_misses++;
+    return buf;
+#endif
+}
+
+
 void drawChar8x16(uint16_t x, uint16_t y, char c, uint16_t color, uint16_t bg_color) {
     unsigned char uc = (unsigned char)c;
-    uart_putc(uc);
+    uint16_t const *glyph = font_get_glyph(uc, color, bg_color);
+
     //    
     ILI9225_setWindow(x, y, x + MENU_ITEM_HEIGHT_16 - 1, y + MENU_ITEM_HEIGHT_16 - 1);
     ILI9225_writeIndex(GRAM_DATA_REG);
+    ILI9225_DMA_sendPixels(glyph, FONT_GLYPH_PIXELS);
+}
 
-    for (uint8_t col = 0; col < 8; col++) {
-        uint16_t bits = Font8x16[uc][col];
-        for (uint8_t row = 0; row < 16; row++) {
-            if (bits & (1 << (15 - row))) {
-                SPI_send_16bit(SPI2, color);
-            } else {
-                SPI_send_16bit(SPI2, bg_color);
-            }
 
-        }
+//      :      ,
+//       ,     
+void drawString8x16(uint16_t x, uint16_t y, const char *str, uint16_t color, uint16_t bg_color) {
+    if (x >= ILI9225_maxX || y >= ILI9225_maxY) return;
+
+    uint16_t len = strlen(str);
+    uint16_t max_len = (ILI9225_maxX - x) / MENU_ITEM_WIDTH;
+    if (len > max_len) len = max_len;
+    if (len == 0) return;
+
+    ILI9225_setWindow(x, y, x + len * MENU_ITEM_WIDTH - 1, y + MENU_ITEM_HEIGHT_16 - 1);
+    ILI9225_writeIndex(GRAM_DATA_REG);
+
+    for (uint16_t i = 0; i < len; i++) {
+        ILI9225_DMA_sendPixels(font_get_glyph((unsigned char)str[i], color, bg_color),
+                               FONT_GLYPH_PIXELS);
     }
 }
 
 
-void drawString8x16(uint16_t x, uint16_t y, const char *str, uint16_t color, uint8_t inversion) {
-    uint16_t cursor_x = x;
-    while (*str) {
-        drawChar8x16(cursor_x, y, *str, color, inversion);
-        cursor_x += MENU_ITEM_WIDTH;
-        str++;
-    }
+//   
+void font_cache_stats(uint32_t *hits, uint32_t *misses) {
+    if (hits) *hits = font_cache_hits;
+    if (misses) *misses = font_cache_misses;
 }
+
+
+//     
+void font_cache_clear(void) {
+    ILI9225_DMA_wait();
+#if (FONT_GLYPH_CACHE_SIZE > 0)
+    for (uint8_t i = 0; i < FONT_GLYPH_CACHE_SIZE; i++) font_cache[i].valid = 0;
+    font_cache_tick = 0;
+#endif
+    font_cache_hits = 0;
+    font_cache_misses = 0;
+}
\ No newline at end of file
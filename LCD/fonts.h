@@ -6,9 +6,24 @@
 #include "ILI9225.h"
 #include "menu.h"
 
+// Размер символа шрифта 8x16, пикселей
+#define FONT_8x16_WIDTH         8
+#define FONT_8x16_HEIGHT        16
+
+// Кэш развернутых символов: FONT_GLYPH_CACHE_SIZE символов по 256 байт ОЗУ
+// (ключ - символ, цвет и фон), 0 - кэш выключен
+#ifndef FONT_GLYPH_CACHE_SIZE
+#define FONT_GLYPH_CACHE_SIZE   8
+#endif
+
+#define FONT_GLYPH_PIXELS       (FONT_8x16_WIDTH * FONT_8x16_HEIGHT)
+
 extern const uint16_t Font8x16[256][8];
 
 void drawChar8x16(uint16_t x, uint16_t y, char c, uint16_t color, uint16_t bg_color);
-void drawString8x16(uint16_t x, uint16_t y, const char *str, uint16_t color, uint8_t inversion);
+void drawString8x16(uint16_t x, uint16_t y, const char *str, uint16_t color, uint16_t bg_color);
+
+void font_cache_stats(uint32_t *hits, uint32_t *misses);
+void font_cache_clear(void);
 
 #endif
\ No newline at end of file
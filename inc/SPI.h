@@ -19,6 +19,9 @@
 	#define SPI_BaudRatePrescaler_4 	( SPI_CR1_BR_0 )
 	#define SPI_BaudRatePrescaler_2 	( ~SPI_BaudRatePrescaler_256 )
 
+	// Биты CR1, из которых состоит профиль устройства: скорость, режим, кадр
+	#define SPI_PROFILE_MASK	( SPI_CR1_BR | SPI_CR1_CPOL | SPI_CR1_CPHA | SPI_CR1_DFF | SPI_CR1_LSBFIRST )
+
 	#define SD_cart_CS		SPI_devices[0]
 	#define LCD_RST			SPI_devices[1]
 	#define LCD_CS			SPI_devices[2]
@@ -31,6 +34,8 @@
 	typedef struct {
 		void (*activate)(void);
 		void (*deactivate)(void);
+		SPI_TypeDef *SPI;	// шина устройства (NULL — просто линия GPIO без профиля)
+		uint16_t profile;	// биты CR1 из SPI_PROFILE_MASK, ставятся в начале транзакции
 	} spi_device_t;
 
 
@@ -107,6 +112,21 @@
 	 */
 	void Create_SPI_devices(spi_device_t* SPI_devices);
 
+	/**
+	 * @brief Смена профиля устройства (скорость/режим/кадр)
+	 * Новый профиль применяется в начале следующей транзакции устройства
+	 * @param key_number Номер устройства в массиве
+	 * @param profile Биты CR1 из SPI_PROFILE_MASK
+	 */
+	void SPI_set_profile(uint8_t key_number, uint16_t profile);
+
+	/**
+	 * @brief Применение профиля устройства к его шине прямо сейчас
+	 * Шина перенастраивается только если профиль отличается от текущего
+	 * @param key_number Номер устройства в массиве
+	 */
+	void SPI_apply_profile(uint8_t key_number);
+
 	/**
 	 * @brief Обмен данными с устройством (передача/приём)
 	 * @param tx_data Буфер передаваемых данных
@@ -142,6 +162,18 @@
 	 */
 	void SPI_send_16bit(SPI_TypeDef *SPI, uint16_t data);
 
+	/**
+	 * @brief Потоковая запись 16 бит без управления CS и без ожидания BSY
+	 * CS держит вызывающий, в конце пачки нужно вызвать SPI_wait_idle()
+	 * @param data Слово для отправки
+	 */
+	void SPI_write_16bit(SPI_TypeDef *SPI, uint16_t data);
+
+	/**
+	 * @brief Ожидание ухода последнего слова из сдвигового регистра
+	 */
+	void SPI_wait_idle(SPI_TypeDef *SPI);
+
 #endif /* SPI_H */
 
 
@@ -2,11 +2,15 @@
 
 	#define _TIMER
 	#include "stm32f1xx.h"
+
+	// Частота ядра (HCLK) после настройки PLL в main.c, МГц
+	#define CORE_CLOCK_MHZ	72
 	
 	void TIM3_init( void );
 	int Delay_ms( int time_ms );
 	void SysTick_init( void );
 	uint32_t get_ms(void);
+	uint32_t get_us(void);
 	void TIM1_init( void );
 
 #endif
@@ -0,0 +1,71 @@
+#ifndef SCENE_H
+
+#define SCENE_H
+
+    #include "stm32f1xx.h"
+    #include <string.h>
+    #include "ILI9225.h"
+    #include "band.h"
+
+/*
+    Сцена из текстовых виджетов с отслеживанием изменений.
+
+    Виджет - прямоугольник с фоном и строкой шрифтом 8x16. scene_set() только
+    запоминает новое содержимое и помечает изменившиеся столбцы грязными,
+    а scene_flush() объединяет пересекающиеся грязные прямоугольники и
+    перерисовывает только их через полосовой рендер (band.h).
+*/
+
+#define SCENE_MAX_WIDGETS   12
+#define SCENE_TEXT_LEN      32
+#define SCENE_BG_COLOR      COLOR_BLACK   // цвет под виджетами
+
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+    char     text[SCENE_TEXT_LEN];
+    uint16_t color;
+    uint16_t bg_color;
+    uint16_t dirty_x0;   // грязные столбцы [dirty_x0, dirty_x1) относительно x
+    uint16_t dirty_x1;
+} scene_widget_t;
+
+/**
+ * @brief Удаление всех виджетов
+ */
+void scene_reset(void);
+
+/**
+ * @brief Добавление виджета, изначально он пустой и целиком грязный
+ * @return номер виджета или -1 если места нет
+ */
+int8_t scene_add(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+/**
+ * @brief Новое содержимое виджета
+ * Если цвета те же, грязными становятся только столбцы изменившихся символов
+ * @param id номер виджета
+ * @param text строка (копируется)
+ * @param color цвет текста
+ * @param bg_color цвет фона виджета
+ */
+void scene_set(int8_t id, const char *text, uint16_t color, uint16_t bg_color);
+
+/**
+ * @brief Пометить виджет целиком грязным
+ */
+void scene_invalidate(int8_t id);
+
+/**
+ * @brief Перерисовка всех грязных областей
+ */
+void scene_flush(void);
+
+/**
+ * @brief Сколько пикселей отправлено на дисплей через scene_flush()
+ */
+uint32_t scene_get_pixels_sent(void);
+
+#endif /* SCENE_H */
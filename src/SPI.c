@@ -71,12 +71,14 @@ static void spi2_init_master(void) {
     // - Software slave management (SSI = 1)
     // - CPOL = 0, CPHA = 0 (Mode 0)
     // - Baud rate: PCLK2/256 (на старте)
+    // - 16-битный кадр: у ILI9225 и индекс, и данные по 16 бит
     // - SPI Enable
     // - SPI TX DMA
 
     SPI2->CR1 = SPI_CR1_MSTR |
                 SPI_CR1_SSM  |
                 SPI_CR1_SSI  |
+                SPI_CR1_DFF  |
                 SPI_BaudRatePrescaler_4 | 
                 SPI_CR1_SPE;	
 }
@@ -176,6 +178,7 @@ void spi_init(void) {
  * @brief Активация CS (PA4 = 0)
  */
 void CS_Activate_0(void) {
+    SPI_apply_profile(0);
     GPIOA->BSRR = GPIO_BSRR_BR4;  // PA4 = 0
 }
 
@@ -278,6 +281,46 @@ void Create_SPI_devices(spi_device_t* SPI_devices) {
     SPI_devices[2].deactivate = CS_Deactivate_2;
     SPI_devices[3].activate   = CS_Activate_3;
     SPI_devices[3].deactivate = CS_Deactivate_3;
+
+    // Профили совпадают с начальной настройкой spi1/spi2_init_master
+    SPI_devices[0].SPI     = SPI1;
+    SPI_devices[0].profile = SPI_BaudRatePrescaler_64;
+    SPI_devices[1].SPI     = NULL;
+    SPI_devices[1].profile = 0;
+    SPI_devices[2].SPI     = SPI2;
+    SPI_devices[2].profile = SPI_CR1_DFF | SPI_BaudRatePrescaler_4;
+    SPI_devices[3].SPI     = NULL;
+    SPI_devices[3].profile = 0;
+}
+
+/**
+ * @brief Смена профиля устройства (скорость/режим/кадр)
+ * Новый профиль применяется при следующей активации CS
+ * @param key_number Номер устройства в массиве
+ * @param profile Биты CR1 из SPI_PROFILE_MASK
+ */
+void SPI_set_profile(uint8_t key_number, uint16_t profile) {
+    SPI_devices[key_number].profile = profile & SPI_PROFILE_MASK;
+}
+
+/**
+ * @brief Применение профиля устройства к его шине прямо сейчас
+ * Шина перенастраивается только если профиль отличается от текущего
+ * @param key_number Номер устройства в массиве
+ */
+void SPI_apply_profile(uint8_t key_number) {
+    spi_device_t *dev = &SPI_devices[key_number];
+    if (dev->SPI == NULL) return;
+
+    uint16_t cr1 = dev->SPI->CR1;
+    if ((cr1 & SPI_PROFILE_MASK) == dev->profile) return;
+
+    // BR/CPOL/CPHA меняются только в покое, DFF — только при SPE = 0
+    SPI_wait_idle(dev->SPI);
+    cr1 &= ~(SPI_PROFILE_MASK | SPI_CR1_SPE);
+    dev->SPI->CR1 = cr1;
+    dev->SPI->CR1 = cr1 | dev->profile;
+    dev->SPI->CR1 = cr1 | dev->profile | SPI_CR1_SPE;
 }
 
 /**
@@ -333,6 +376,15 @@ void SPI_send_16bit(SPI_TypeDef *SPI, uint16_t data) {
 	uint8_t buff = 0;
 	while(!(SPI->SR & SPI_SR_TXE)) {};
 	LCD_CS.activate();
+
+	// В 16-битном режиме слово уходит одной записью
+	if (SPI->CR1 & SPI_CR1_DFF) {
+		SPI->DR = data;
+		while(!(SPI->SR & SPI_SR_TXE)) {};
+		while((SPI->SR & SPI_SR_BSY)) {};
+		LCD_CS.deactivate();
+		return;
+	}
     
 	buff = data >> 8;
 	SPI->DR = buff;
@@ -346,3 +398,31 @@ void SPI_send_16bit(SPI_TypeDef *SPI, uint16_t data) {
 	while((SPI->SR & SPI_SR_BSY)) {};
 	LCD_CS.deactivate();
 }
+
+
+/**
+ * @brief Потоковая запись 16 бит без управления CS и без ожидания BSY
+ * CS держит вызывающий, в конце пачки нужно вызвать SPI_wait_idle()
+ * @param data Слово для отправки
+ */
+void SPI_write_16bit(SPI_TypeDef *SPI, uint16_t data) {
+	if (SPI->CR1 & SPI_CR1_DFF) {
+		while(!(SPI->SR & SPI_SR_TXE)) {};
+		SPI->DR = data;
+		return;
+	}
+
+	while(!(SPI->SR & SPI_SR_TXE)) {};
+	SPI->DR = (uint8_t)(data >> 8);
+	while(!(SPI->SR & SPI_SR_TXE)) {};
+	SPI->DR = (uint8_t)(0x00FF & data);
+}
+
+
+/**
+ * @brief Ожидание ухода последнего слова из сдвигового регистра
+ */
+void SPI_wait_idle(SPI_TypeDef *SPI) {
+	while(!(SPI->SR & SPI_SR_TXE)) {};
+	while((SPI->SR & SPI_SR_BSY)) {};
+}
@@ -29,7 +29,8 @@ void SysTick_Handler(void) {
 
 // Настройка SysTick на 1 мс (при 72 МГц)
 void SysTick_init(void ) {
-    SysTick->LOAD = (72000000 / 8 / 1000) - 1; // 72 MHz / 8 = 9 MHz → 9000 тиков = 1 мс
+    // CLKSOURCE = HCLK без деления: 72 МГц → 72000 отсчётов = 1 мс
+    SysTick->LOAD = CORE_CLOCK_MHZ * 1000 - 1;
     SysTick->VAL = 0;
     SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk |
                     SysTick_CTRL_TICKINT_Msk  |
@@ -40,6 +41,21 @@ uint32_t get_ms(void) {
     return systick_ms;
 }
 
+// Микросекунды: тики SysTick плюс уже отсчитанная часть текущего.
+// Период тика и частота счёта — из LOAD и CLKSOURCE, а не из расчёта на 1 мс
+uint32_t get_us(void) {
+    uint32_t ticks, val;
+    do {
+        ticks = systick_ms;
+        val   = SysTick->VAL;
+    } while (ticks != systick_ms);   // перезагрузка счётчика между чтениями
+
+    uint32_t period  = SysTick->LOAD + 1;
+    uint32_t per_us  = (SysTick->CTRL & SysTick_CTRL_CLKSOURCE_Msk) ? CORE_CLOCK_MHZ : CORE_CLOCK_MHZ / 8;
+    uint32_t elapsed = (period - val) % period;   // VAL = 0 — тик только что засчитан
+    return ticks * (period / per_us) + elapsed / per_us;
+}
+
 //--------------------------------------/
 // TIM1 configuration:					//
 // PA8 	- PWM output for channel 1		//
@@ -22,9 +22,6 @@
 #include "menu.h"
 
 
-//#define BUF_READ_PICTURE (15 /*  */ * LCD_HEIGHT * 3 /*    */)
-//static uint8_t picture[BUF_READ_PICTURE];
-
 
 /**
  * @brief   
@@ -123,7 +120,7 @@ int main(void) {
     //   (011)
     ILI9225_write(ENTRY_MODE, (0x1000) | (0b011 << 3));
 
-    file_read("xp_.bmp", picture, BUF_READ_PICTURE);
+    file_read("xp_.bmp");
 
     drawString8x8(10, 10, "HELLO WORLD", COLOR_TOMATO, 0);
     drawString8x8(10, 10 + 9, "HELLO WORLD", COLOR_TOMATO, 0);
@@ -139,7 +136,8 @@ int main(void) {
 
     //char buf[50];
     while(1){
-
+        //  SD:    ,    
+        SD_QueuePoll();
     }
 }
 
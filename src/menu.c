@@ -1,4 +1,5 @@
 #include "menu.h"
+#include "scene.h"
 
 
 menu_id_t current_menu = MENU_MAIN;
@@ -87,58 +88,40 @@ void print_menu(void) {
 }
 
 
-//        
-//   (   Y)
-static void menu_fill_rect(uint16_t x, uint16_t y_top, uint16_t width, uint16_t height, uint16_t color) {
-    if (width == 0 || height == 0) return;
-    
-    // y_top    Y ( ""    )
-    // y_bottom    Y ( "")
-    uint16_t y_bottom = y_top + height - 1;
-    
-    ILI9225_setWindow(x, y_top, x + width - 1, y_bottom);
-    ILI9225_writeIndex(GRAM_DATA_REG);
-    
-    uint32_t pixels = (uint32_t)width * height;
-    for (uint32_t i = 0; i < pixels; i++) {
-        SPI_send_16bit(SPI2, color);
-    }
-}
+//  : ,   
+static int8_t menu_widget_title = -1;
+static int8_t menu_widget_items[MAX_MENU_ITEMS];
+static int8_t menu_widget_hints[4];
 
-//   
-void menu_redraw_full(void) {
-    const menu_t* menu = &menus[current_menu];
-    
-    // 1.    (   )
-    //   = MENU_START_Y - MENU_HEIGHT_16 + 1
-    uint16_t area_top = MENU_START_Y - MENU_HEIGHT_16 + 1;
-    menu_fill_rect(MENU_START_X, area_top, MENU_WIDTH, MENU_HEIGHT_16, COLOR_BLACK);
-    
-    // 2.  ( )
-    drawString8x16(MENU_START_X, MENU_HEADER_Y, menu->title, COLOR_WHITE, COLOR_BLACK);
-    
-    // 3.  
-    uint8_t visible_count = (menu->count < MAX_MENU_ITEMS) ? menu->count : MAX_MENU_ITEMS;
-    for (uint8_t i = 0; i < visible_count; i++) {
-        menu_redraw_item(i, (i == selected_item));
-    }
-    
-    // 4.  ( )
-    drawString8x16(MENU_START_X, MENU_HINTS_Y,      "BACK  - ",    COLOR_GREEN, COLOR_BLACK);
-    drawString8x16(MENU_START_X, MENU_HINTS_Y + 16, "UP    - ",    COLOR_GREEN, COLOR_BLACK);
-    drawString8x16(MENU_START_X, MENU_HINTS_Y + 32, "DOWN  - ",     COLOR_GREEN, COLOR_BLACK);
-    drawString8x16(MENU_START_X, MENU_HINTS_Y + 48, "ENTER - ",  COLOR_GREEN, COLOR_BLACK);
-}
+//     
+static void menu_scene_init(void) {
+    if (menu_widget_title >= 0) return;
+
+    scene_reset();
+    menu_widget_title = scene_add(MENU_START_X, MENU_HEADER_Y, MENU_WIDTH, MENU_ITEM_HEIGHT_16);
 
-//   
-void menu_redraw_item(uint8_t index, uint8_t is_selected) {
-    if (index >= menus[current_menu].count || index >= MAX_MENU_ITEMS) return;
-    
     //    :
     // index=0 ? Y = MENU_START_Y (   )
     // index=1 ? Y = MENU_START_Y - 16 ()
-    uint16_t y = MENU_START_Y - index * MENU_ITEM_HEIGHT_16;
-    
+    for (uint8_t i = 0; i < MAX_MENU_ITEMS; i++) {
+        menu_widget_items[i] = scene_add(MENU_START_X, MENU_START_Y - i * MENU_ITEM_HEIGHT_16,
+                                         MENU_WIDTH, MENU_ITEM_HEIGHT_16);
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        menu_widget_hints[i] = scene_add(MENU_START_X, MENU_HINTS_Y + i * MENU_ITEM_HEIGHT_16,
+                                         MENU_WIDTH, MENU_ITEM_HEIGHT_16);
+    }
+}
+
+//      (,   )
+static void menu_set_item(uint8_t index, uint8_t is_selected) {
+    if (index >= MAX_MENU_ITEMS) return;
+
+    if (index >= menus[current_menu].count) {
+        scene_set(menu_widget_items[index], "", COLOR_WHITE, COLOR_BLACK);
+        return;
+    }
+
     const char* text = menus[current_menu].items[index].text;
     char line[32];
     
@@ -147,20 +130,49 @@ void menu_redraw_item(uint8_t index, uint8_t is_selected) {
     } else {
         snprintf(line, sizeof(line), "  %s", text);
     }
+
+    scene_set(menu_widget_items[index], line, COLOR_WHITE,
+              is_selected ? COLOR_BLUE : COLOR_BLACK);
+}
+
+//    (     )
+void menu_redraw_full(void) {
+    const menu_t* menu = &menus[current_menu];
+
+    menu_scene_init();
+    
+    // 1.  ( )
+    scene_set(menu_widget_title, menu->title, COLOR_WHITE, COLOR_BLACK);
     
-    //   
-    menu_fill_rect(MENU_START_X, y, MENU_WIDTH, MENU_ITEM_HEIGHT_16,
-                   is_selected ? COLOR_BLUE : COLOR_BLACK);
+    // 2.  ,   
+    for (uint8_t i = 0; i < MAX_MENU_ITEMS; i++) {
+        menu_set_item(i, (i == selected_item));
+    }
     
-    //  
-    drawString8x16(MENU_START_X, y, line, COLOR_WHITE,
-                   is_selected ? COLOR_BLUE : COLOR_BLACK);
+    // 3.  ( ),     
+    scene_set(menu_widget_hints[0], "BACK  - ",    COLOR_GREEN, COLOR_BLACK);
+    scene_set(menu_widget_hints[1], "UP    - ",    COLOR_GREEN, COLOR_BLACK);
+    scene_set(menu_widget_hints[2], "DOWN  - ",     COLOR_GREEN, COLOR_BLACK);
+    scene_set(menu_widget_hints[3], "ENTER - ",  COLOR_GREEN, COLOR_BLACK);
+
+    scene_flush();
+}
+
+//   
+void menu_redraw_item(uint8_t index, uint8_t is_selected) {
+    if (index >= menus[current_menu].count || index >= MAX_MENU_ITEMS) return;
+
+    menu_scene_init();
+    menu_set_item(index, is_selected);
+    scene_flush();
 }
 
-//   ( 2 )
+//   ( 2 ,    )
 void menu_update_selection(void) {
     if (prev_selected != selected_item) {
-       menu_redraw_item(prev_selected, 0);  //  
-       menu_redraw_item(selected_item, 1);  //  
+       menu_scene_init();
+       menu_set_item(prev_selected, 0);  //  
+       menu_set_item(selected_item, 1);  //  
+       scene_flush();
     }
 }
@@ -0,0 +1,223 @@
+/**
+ * @file scene.c
+ * @brief Сцена из текстовых виджетов с минимальной перерисовкой
+ *
+ * Вместо полной перерисовки экрана виджеты помечают изменившиеся
+ * столбцы грязными, а scene_flush() отправляет на дисплей только их.
+ */
+
+#include "scene.h"
+
+// -----------------------------------------------------------------------------
+// Типы данных
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    uint16_t x0;
+    uint16_t y0;
+    uint16_t x1;    // не включительно
+    uint16_t y1;    // не включительно
+} scene_rect_t;
+
+// -----------------------------------------------------------------------------
+// Глобальные переменные
+// -----------------------------------------------------------------------------
+
+static scene_widget_t scene_widgets[SCENE_MAX_WIDGETS];
+static uint8_t  scene_count = 0;
+static uint32_t scene_pixels_sent = 0;
+
+// -----------------------------------------------------------------------------
+// Внутренние функции
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Площадь прямоугольника
+ */
+static uint32_t scene_rect_area(scene_rect_t const *r) {
+    return (uint32_t)(r->x1 - r->x0) * (r->y1 - r->y0);
+}
+
+/**
+ * @brief Пересекаются ли прямоугольники
+ */
+static uint8_t scene_rect_overlap(scene_rect_t const *a, scene_rect_t const *b) {
+    return a->x0 < b->x1 && b->x0 < a->x1 && a->y0 < b->y1 && b->y0 < a->y1;
+}
+
+/**
+ * @brief Объединение пересекающихся или вплотную прилегающих прямоугольников
+ * Прилегающие объединяются только если это не добавляет лишних пикселей
+ * @return новое количество прямоугольников
+ */
+static uint8_t scene_merge_rects(scene_rect_t *rects, uint8_t n) {
+    uint8_t merged;
+    do {
+        merged = 0;
+        for (uint8_t i = 0; i < n && !merged; i++) {
+            for (uint8_t j = i + 1; j < n; j++) {
+                scene_rect_t u = {
+                    (rects[i].x0 < rects[j].x0) ? rects[i].x0 : rects[j].x0,
+                    (rects[i].y0 < rects[j].y0) ? rects[i].y0 : rects[j].y0,
+                    (rects[i].x1 > rects[j].x1) ? rects[i].x1 : rects[j].x1,
+                    (rects[i].y1 > rects[j].y1) ? rects[i].y1 : rects[j].y1
+                };
+                if (scene_rect_overlap(&rects[i], &rects[j]) ||
+                    scene_rect_area(&u) <= scene_rect_area(&rects[i]) + scene_rect_area(&rects[j])) {
+                    rects[i] = u;
+                    rects[j] = rects[--n];
+                    merged = 1;
+                    break;
+                }
+            }
+        }
+    } while (merged);
+    return n;
+}
+
+/**
+ * @brief Перерисовка одного прямоугольника со всеми виджетами под ним
+ */
+static void scene_draw_rect(scene_rect_t const *r) {
+    band_begin(r->x0, r->y0, r->x1 - r->x0, r->y1 - r->y0, SCENE_BG_COLOR);
+
+    for (uint8_t i = 0; i < scene_count; i++) {
+        scene_widget_t const *wd = &scene_widgets[i];
+        scene_rect_t box = { wd->x, wd->y, wd->x + wd->w, wd->y + wd->h };
+        if (!scene_rect_overlap(&box, r)) continue;
+
+        band_fillRect(wd->x, wd->y, wd->w, wd->h, wd->bg_color);
+        if (wd->text[0]) band_drawString8x16(wd->x, wd->y, wd->text, wd->color);
+    }
+
+    band_end();
+    scene_pixels_sent += scene_rect_area(r);
+}
+
+// -----------------------------------------------------------------------------
+// Публичные функции
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Удаление всех виджетов
+ */
+void scene_reset(void) {
+    scene_count = 0;
+}
+
+/**
+ * @brief Добавление виджета, изначально он пустой и целиком грязный
+ * @return номер виджета или -1 если места нет
+ */
+int8_t scene_add(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    if (scene_count >= SCENE_MAX_WIDGETS) return -1;
+
+    scene_widget_t *wd = &scene_widgets[scene_count];
+    wd->x = x;
+    wd->y = y;
+    wd->w = w;
+    wd->h = h;
+    wd->text[0] = '\0';
+    wd->color = SCENE_BG_COLOR;
+    wd->bg_color = SCENE_BG_COLOR;
+    wd->dirty_x0 = 0;
+    wd->dirty_x1 = w;
+
+    return scene_count++;
+}
+
+/**
+ * @brief Новое содержимое виджета
+ * Если цвета те же, грязными становятся только столбцы изменившихся символов
+ * @param id номер виджета
+ * @param text строка (копируется)
+ * @param color цвет текста
+ * @param bg_color цвет фона виджета
+ */
+void scene_set(int8_t id, const char *text, uint16_t color, uint16_t bg_color) {
+    if (id < 0 || id >= scene_count) return;
+    scene_widget_t *wd = &scene_widgets[id];
+
+    if (color != wd->color || bg_color != wd->bg_color) {
+        wd->color = color;
+        wd->bg_color = bg_color;
+        strncpy(wd->text, text, SCENE_TEXT_LEN - 1);
+        wd->text[SCENE_TEXT_LEN - 1] = '\0';
+        scene_invalidate(id);
+        return;
+    }
+
+    // Ищем первый и последний отличающийся символ
+    int16_t first = -1;
+    int16_t last = -1;
+    uint8_t old_end = 0;
+    uint8_t new_end = 0;
+    for (uint8_t i = 0; i < SCENE_TEXT_LEN - 1 && !(old_end && new_end); i++) {
+        char old_c = old_end ? '\0' : wd->text[i];
+        char new_c = new_end ? '\0' : text[i];
+        if (old_c == '\0') old_end = 1;
+        if (new_c == '\0') new_end = 1;
+        if (old_c != new_c) {
+            if (first < 0) first = i;
+            last = i;
+        }
+        wd->text[i] = new_c;
+    }
+    wd->text[SCENE_TEXT_LEN - 1] = '\0';
+    if (first < 0) return;
+
+    uint16_t x0 = first * FONT_8x16_WIDTH;
+    uint16_t x1 = (last + 1) * FONT_8x16_WIDTH;
+    if (x0 >= wd->w) return;
+    if (x1 > wd->w) x1 = wd->w;
+
+    if (wd->dirty_x0 >= wd->dirty_x1) {
+        wd->dirty_x0 = x0;
+        wd->dirty_x1 = x1;
+    } else {
+        if (x0 < wd->dirty_x0) wd->dirty_x0 = x0;
+        if (x1 > wd->dirty_x1) wd->dirty_x1 = x1;
+    }
+}
+
+/**
+ * @brief Пометить виджет целиком грязным
+ */
+void scene_invalidate(int8_t id) {
+    if (id < 0 || id >= scene_count) return;
+    scene_widgets[id].dirty_x0 = 0;
+    scene_widgets[id].dirty_x1 = scene_widgets[id].w;
+}
+
+/**
+ * @brief Перерисовка всех грязных областей
+ */
+void scene_flush(void) {
+    scene_rect_t rects[SCENE_MAX_WIDGETS];
+    uint8_t n = 0;
+
+    for (uint8_t i = 0; i < scene_count; i++) {
+        scene_widget_t *wd = &scene_widgets[i];
+        if (wd->dirty_x0 >= wd->dirty_x1) continue;
+
+        rects[n].x0 = wd->x + wd->dirty_x0;
+        rects[n].y0 = wd->y;
+        rects[n].x1 = wd->x + wd->dirty_x1;
+        rects[n].y1 = wd->y + wd->h;
+        n++;
+
+        wd->dirty_x0 = wd->dirty_x1 = 0;
+    }
+
+    n = scene_merge_rects(rects, n);
+    for (uint8_t i = 0; i < n; i++) {
+        scene_draw_rect(&rects[i]);
+    }
+}
+
+/**
+ * @brief Сколько пикселей отправлено на дисплей через scene_flush()
+ */
+uint32_t scene_get_pixels_sent(void) {
+    return scene_pixels_sent;
+}
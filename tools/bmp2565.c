@@ -0,0 +1,156 @@
+/**
+ * @file bmp2565.c
+ * @brief Конвертер BMP -> .565 для вывода картинок без обработки на МК
+ *
+ * Собирается на ПК (tools/CMakeLists.txt, цель host_tools в основном CMake).
+ *
+ * Использование:
+ *   bmp2565 [-a] [-o 0..3] input.bmp output.565
+ *   -a      пиксели с границы сектора (512 байт) — заголовок в отдельном секторе
+ *   -o N    картинка только для ориентации дисплея N (по умолчанию любая)
+ *
+ * Поддерживаются несжатые BMP 24 и 32 бита, снизу вверх и сверху вниз.
+ * Формат результата описан в FatFS/SD/img565.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "img565.h"
+
+// -----------------------------------------------------------------------------
+// Внутренние функции
+// -----------------------------------------------------------------------------
+
+static uint32_t le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/**
+ * @brief Чтение всего файла в память
+ * @return буфер (освобождает вызывающий) или NULL
+ */
+static uint8_t *read_file(const char *path, long *size) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    uint8_t *data = malloc(*size > 0 ? (size_t)*size : 1);
+    if (data && fread(data, 1, (size_t)*size, f) != (size_t)*size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    return data;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: bmp2565 [-a] [-o 0..3] input.bmp output.565\n");
+}
+
+// -----------------------------------------------------------------------------
+// Точка входа
+// -----------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+    img565_header_t hdr = { 0 };
+    hdr.orientation = IMG565_ANY_ORIENTATION;
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        if (strcmp(argv[i], "-a") == 0) {
+            hdr.flags |= IMG565_FLAG_ALIGNED;
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            int o = atoi(argv[++i]);
+            if (o < 0 || o > 3) {
+                usage();
+                return 1;
+            }
+            hdr.orientation = (uint8_t)o;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (argc - i != 2) {
+        usage();
+        return 1;
+    }
+
+    long size;
+    uint8_t *bmp = read_file(argv[i], &size);
+    if (!bmp || size < 54 || bmp[0] != 'B' || bmp[1] != 'M') {
+        fprintf(stderr, "%s: not a BMP file\n", argv[i]);
+        free(bmp);
+        return 1;
+    }
+
+    uint32_t off   = le32(bmp + 10);
+    int32_t  w     = (int32_t)le32(bmp + 18);
+    int32_t  h     = (int32_t)le32(bmp + 22);
+    uint16_t bpp   = le16(bmp + 28);
+    uint32_t compr = le32(bmp + 30);
+
+    // h < 0 — строки сверху вниз
+    int top_down = (h < 0);
+    if (top_down) h = -h;
+
+    if ((bpp != 24 && bpp != 32) || (compr != 0 && compr != 3) ||
+        w <= 0 || h <= 0 || w > 0xFFFF || h > 0xFFFF) {
+        fprintf(stderr, "%s: only uncompressed 24/32-bit BMP is supported\n", argv[i]);
+        free(bmp);
+        return 1;
+    }
+
+    uint32_t bytes_pp = bpp / 8;
+    uint32_t stride   = ((uint32_t)w * bytes_pp + 3) & ~3u;
+    if (off + stride * (uint32_t)h > (uint32_t)size) {
+        fprintf(stderr, "%s: truncated pixel data\n", argv[i]);
+        free(bmp);
+        return 1;
+    }
+
+    hdr.width  = (uint16_t)w;
+    hdr.height = (uint16_t)h;
+    hdr.data_offset = (hdr.flags & IMG565_FLAG_ALIGNED) ? IMG565_SECTOR : IMG565_HEADER_SIZE;
+
+    FILE *out = fopen(argv[i + 1], "wb");
+    if (!out) {
+        fprintf(stderr, "%s: cannot create\n", argv[i + 1]);
+        free(bmp);
+        return 1;
+    }
+
+    uint8_t head[IMG565_SECTOR] = { 0 };
+    img565_pack(&hdr, head);
+    fwrite(head, 1, hdr.data_offset, out);
+
+    // Порядок окна GRAM: столбец за столбцом, в столбце сверху вниз
+    for (int32_t x = 0; x < w; x++) {
+        for (int32_t y = 0; y < h; y++) {
+            int32_t row = top_down ? y : (h - 1 - y);
+            const uint8_t *p = bmp + off + (uint32_t)row * stride + (uint32_t)x * bytes_pp;
+            uint16_t c = (uint16_t)(((p[2] >> 3) << 11) | ((p[1] >> 2) << 5) | (p[0] >> 3));
+            uint8_t le[2] = { (uint8_t)c, (uint8_t)(c >> 8) };
+            fwrite(le, 1, 2, out);
+        }
+    }
+
+    int err = ferror(out);
+    fclose(out);
+    free(bmp);
+
+    if (err) {
+        fprintf(stderr, "%s: write error\n", argv[i + 1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file bench_orientation.c
+ * @brief Скорость перевода координат и drawPixel в одном варианте ориентации
+ *
+ * Собирается по разу на каждый LCD_ORIENTATION (RUNTIME, 0..3) со своей
+ * копией библиотеки прошивки, запуск всех: --target bench-orientations.
+ * Печатает нс на вызов ILI9225_orientCoordinates() и ILI9225_drawPixel().
+ * Время drawPixel включает модель SPI и дисплея — она одна и та же во
+ * всех вариантах, поэтому разница между ними — это разница драйвера.
+ * Заодно сверяет перевод координат с формулой ориентации.
+ */
+
+#include "host.h"
+#include <time.h>
+
+#ifdef ILI9225_FIXED_ORIENTATION
+#define MODE_NAME   "fixed"
+#define MODE        ILI9225_FIXED_ORIENTATION
+#else
+#define MODE_NAME   "RUNTIME"
+#define MODE        2
+#endif
+
+#define COORD_CALLS     20000000u
+#define PIXEL_CALLS     200000u
+
+static volatile uint32_t sink;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * @brief Физическая точка для логической (x, y) по формуле ориентации
+ */
+static void expected(uint16_t x, uint16_t y, uint16_t *px, uint16_t *py) {
+    switch (MODE) {
+    case 0:  *px = x;                  *py = y;                   break;
+    case 1:  *px = LCD_WIDTH - 1 - y;  *py = x;                   break;
+    case 2:  *px = LCD_WIDTH - 1 - x;  *py = LCD_HEIGHT - 1 - y;  break;
+    default: *px = y;                  *py = LCD_HEIGHT - 1 - x;  break;
+    }
+}
+
+static void test(void) {
+    ILI9225_init();
+    ILI9225_setOrientation(MODE);
+
+    uint32_t bad = 0;
+    for (uint16_t y = 0; y < ILI9225_maxY; y++) {
+        for (uint16_t x = 0; x < ILI9225_maxX; x++) {
+            uint16_t px = x, py = y, ex, ey;
+            ILI9225_orientCoordinates(&px, &py);
+            expected(x, y, &ex, &ey);
+            bad += (px != ex) || (py != ey);
+        }
+    }
+    CHECK_EQ(bad, 0);
+
+    // Аргументы меняются, чтобы перевод не вынесся из цикла
+    double t0 = now_ns();
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < COORD_CALLS; i++) {
+        uint16_t x = (uint16_t)(i % ILI9225_maxX);
+        uint16_t y = (uint16_t)((i >> 8) % ILI9225_maxY);
+        ILI9225_orientCoordinates(&x, &y);
+        acc += x ^ y;
+    }
+    double coord_ns = (now_ns() - t0) / COORD_CALLS;
+    sink = acc;
+
+    t0 = now_ns();
+    for (uint32_t i = 0; i < PIXEL_CALLS; i++) {
+        ILI9225_drawPixel((uint16_t)(i % ILI9225_maxX), (uint16_t)((i >> 7) % ILI9225_maxY), (uint16_t)i);
+    }
+    double pixel_ns = (now_ns() - t0) / PIXEL_CALLS;
+    CHECK_EQ(host_lcd.outside, 0);
+
+    printf("LCD_ORIENTATION=%s (%u): orientCoordinates %.2f ns, drawPixel %.1f ns\n",
+           MODE_NAME, MODE, coord_ns, pixel_ns);
+}
+
+int main(void) {
+    return host_run(test);
+}
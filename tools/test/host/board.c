@@ -0,0 +1,591 @@
+/**
+ * @file board.c
+ * @brief Модель платы: SPI-устройства, DMA1, NVIC, таймер и UART
+ *
+ * Заменяет src/SPI.c, src/TIMER.c и src/USART.c при сборке на ПК.
+ * Функции таймера слабые: test_systick собирается с настоящим
+ * src/TIMER.c, а счёт SysTick в тактах ядра ведёт host_systick_run().
+ * Байты SPI1 уходят в модель карты (sd.c), кадры SPI2 — в модель
+ * дисплея (lcd.c). Каналы DMA обслуживаются из обработчика SIGALRM,
+ * который срабатывает каждые HOST_TICK_US мкс, как прерывание.
+ */
+
+#define _GNU_SOURCE
+#include "host.h"
+#include "host_models.h"
+#include "SPI.h"
+#include "TIMER.h"
+#include "USART.h"
+#include "SD_card.h"
+#include <signal.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+// -----------------------------------------------------------------------------
+// Конфигурация
+// -----------------------------------------------------------------------------
+
+#define HOST_TICK_US        20          // период «прерывания» DMA
+#define HOST_STACK_SIZE     (1 << 20)   // стек теста, ниже 4 ГБ
+#define HOST_UART_LOG       65536
+#define HOST_IDLE_TIMEOUT_S 5           // host_dma_idle(): дольше — DMA встал
+
+// Тактирование шин: SPI1 на APB2, SPI2 на APB1
+#define HOST_PCLK2_MHZ      72
+#define HOST_PCLK1_MHZ      36
+
+// -----------------------------------------------------------------------------
+// Периферия (см. host/stm32f1xx.h)
+// -----------------------------------------------------------------------------
+
+SPI_TypeDef          host_spi1;
+SPI_TypeDef          host_spi2;
+DMA_TypeDef          host_dma1;
+DMA_Channel_TypeDef  host_dma1_channel[8];
+RCC_TypeDef          host_rcc;
+SysTick_Type         host_systick;
+
+volatile uint8_t  host_line[4];
+volatile uint32_t host_errors;
+host_bus_stats_t  host_bus;
+
+static uint32_t host_failures;
+static uint32_t host_nvic_iser[2];
+static uint8_t  host_nvic_prio[64];
+static uint32_t host_basepri;
+
+static volatile uint64_t host_ps;   // модельное время, пс: кадр SPI не кратен нс
+static volatile uint8_t  host_bus_busy[3];   // CPU сейчас в модели шины [1], [2]
+static uint8_t  host_dma_wait;
+static uint8_t  host_dma_age[8];
+
+static char     host_uart_buf[HOST_UART_LOG];
+static size_t   host_uart_len;
+static uint8_t  host_uart_echo;
+
+// -----------------------------------------------------------------------------
+// Проверки и ошибки
+// -----------------------------------------------------------------------------
+
+int host_check(int ok, const char *what, const char *file, int line) {
+    if (!ok) {
+        printf("%s:%d: FAIL: %s\n", file, line, what);
+        host_failures++;
+    }
+    return ok;
+}
+
+int host_check_eq(long long a, long long b, const char *sa, const char *sb, const char *file, int line) {
+    if (a != b) {
+        printf("%s:%d: FAIL: %s == %s (%lld != %lld)\n", file, line, sa, sb, a, b);
+        host_failures++;
+    }
+    return a == b;
+}
+
+void host_error(const char *fmt, ...) {
+    // Первые сообщения — в stderr, дальше только счёт: ошибка может
+    // повторяться на каждом байте
+    if (host_errors++ < 10) {
+        char msg[256];
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(msg, sizeof(msg) - 1, fmt, ap);
+        va_end(ap);
+        if (n < 0) return;
+        if (n > (int)sizeof(msg) - 2) n = sizeof(msg) - 2;
+        msg[n++] = '\n';
+        if (write(2, msg, n) < 0) return;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Время
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Время на байт (кадр) при делителе из CR1
+ */
+static void host_bus_time(SPI_TypeDef const *spi, uint32_t frames) {
+    uint32_t div = 2u << ((spi->CR1 & SPI_CR1_BR) >> SPI_CR1_BR_Pos);
+    uint32_t bits = (spi->CR1 & SPI_CR1_DFF) ? 16 : 8;
+    uint32_t mhz = (spi == SPI1) ? HOST_PCLK2_MHZ : HOST_PCLK1_MHZ;
+    host_ps += (uint64_t)frames * bits * div * 1000000 / mhz;
+}
+
+uint64_t host_time_us(void) {
+    return host_ps / 1000000;
+}
+
+__attribute__((weak)) uint32_t get_ms(void) {
+    host_ps += 1000000;
+    return (uint32_t)(host_ps / 1000000000);
+}
+
+__attribute__((weak)) uint32_t get_us(void) {
+    host_ps += 1000000;
+    return (uint32_t)(host_ps / 1000000);
+}
+
+__attribute__((weak)) int Delay_ms(int time_ms) {
+    host_ps += (uint64_t)time_ms * 1000000000;
+    return 0;
+}
+
+__attribute__((weak)) void TIM3_init(void) {}
+__attribute__((weak)) void TIM1_init(void) {}
+__attribute__((weak)) void SysTick_init(void) {}
+__attribute__((weak)) void SysTick_Handler(void) {}
+
+void host_systick_run(uint32_t cycles) {
+    static uint32_t rest;   // такты ядра в счёт следующего отсчёта HCLK/8
+
+    if (!(SysTick->CTRL & SysTick_CTRL_ENABLE_Msk)) return;
+    uint32_t div = (SysTick->CTRL & SysTick_CTRL_CLKSOURCE_Msk) ? 1 : 8;
+    rest += cycles;
+    uint32_t counts = rest / div;
+    rest %= div;
+
+    // Из 0 — перезагрузка из LOAD, переход в 0 — прерывание
+    while (counts--) {
+        if (SysTick->VAL == 0) {
+            SysTick->VAL = SysTick->LOAD;
+        } else if (--SysTick->VAL == 0 && (SysTick->CTRL & SysTick_CTRL_TICKINT_Msk)) {
+            SysTick_Handler();
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// UART
+// -----------------------------------------------------------------------------
+
+void uart_init(void) {}
+
+void uart_putc(char c) {
+    if (host_uart_len < HOST_UART_LOG - 1) {
+        host_uart_buf[host_uart_len++] = c;
+        host_uart_buf[host_uart_len] = '\0';
+    }
+    if (host_uart_echo && write(1, &c, 1) < 0) host_uart_echo = 0;
+}
+
+void uart_puts(const char *s) {
+    while (*s) uart_putc(*s++);
+}
+
+void print_string(const char *str) {
+    uart_puts(str);
+}
+
+void print_hex(uint8_t value) {
+    static const char digits[] = "0123456789ABCDEF";
+    uart_putc(digits[value >> 4]);
+    uart_putc(digits[value & 0x0F]);
+}
+
+const char *host_uart_log(void) {
+    return host_uart_buf;
+}
+
+void host_uart_clear(void) {
+    host_uart_len = 0;
+    host_uart_buf[0] = '\0';
+}
+
+// -----------------------------------------------------------------------------
+// NVIC
+// -----------------------------------------------------------------------------
+
+void host_nvic_enable_irq(IRQn_Type irq) {
+    if (irq >= 0) host_nvic_iser[irq >> 5] |= 1u << (irq & 31);
+}
+
+void host_nvic_disable_irq(IRQn_Type irq) {
+    if (irq >= 0) host_nvic_iser[irq >> 5] &= ~(1u << (irq & 31));
+}
+
+uint32_t host_nvic_enabled(IRQn_Type irq) {
+    return (irq >= 0) && (host_nvic_iser[irq >> 5] & (1u << (irq & 31)));
+}
+
+void host_nvic_set_priority(IRQn_Type irq, uint32_t priority) {
+    if (irq >= 0 && irq < 64) host_nvic_prio[irq] = (uint8_t)priority;
+}
+
+uint32_t host_nvic_get_priority(IRQn_Type irq) {
+    return (irq >= 0 && irq < 64) ? host_nvic_prio[irq] : 0;
+}
+
+uint32_t host_get_basepri(void) {
+    return host_basepri;
+}
+
+void host_set_basepri(uint32_t value) {
+    host_basepri = value & 0xFF;
+}
+
+/**
+ * @brief Закрыты ли сейчас прерывания, из которых работает FatFS (EXTI)
+ */
+static uint8_t host_fatfs_masked(void) {
+    return host_basepri != 0 && host_basepri <= (SD_FATFS_IRQ_PRIORITY << (8 - __NVIC_PRIO_BITS));
+}
+
+// -----------------------------------------------------------------------------
+// SPI: то же API, что у src/SPI.c
+// -----------------------------------------------------------------------------
+
+spi_device_t devices[4];
+spi_device_t *SPI_devices = devices;
+
+/**
+ * @brief Идёт ли передача DMA по шине
+ */
+static uint8_t host_dma_active(SPI_TypeDef const *spi) {
+    if (spi == SPI1) {
+        return ((DMA1_Channel2->CCR & DMA_CCR_EN) && DMA1_Channel2->CNDTR) ||
+               ((DMA1_Channel3->CCR & DMA_CCR_EN) && DMA1_Channel3->CNDTR);
+    }
+    return (DMA1_Channel5->CCR & DMA_CCR_EN) && DMA1_Channel5->CNDTR;
+}
+
+/**
+ * @brief Кадр в SPI2: 16 бит одним кадром или два по 8 бит
+ */
+static void host_spi2_frame(uint16_t data) {
+    if (!(SPI2->CR1 & SPI_CR1_SPE)) host_error("SPI2: передача при выключенном SPE");
+    host_bus_time(SPI2, 1);
+    if (SPI2->CR1 & SPI_CR1_DFF) {
+        host_bus.spi2_frames16++;
+        host_lcd_word(data);
+    } else {
+        host_bus.spi2_frames8++;
+        host_lcd_byte((uint8_t)data);
+    }
+}
+
+static uint8_t host_spi1_byte(uint8_t data) {
+    if (!(SPI1->CR1 & SPI_CR1_SPE)) host_error("SPI1: передача при выключенном SPE");
+    if (SPI1->CR1 & SPI_CR1_DFF) host_error("SPI1: карта работает 8-битными кадрами");
+    host_bus_time(SPI1, 1);
+    host_bus.spi1_bytes++;
+    return host_sd_xfer(data);
+}
+
+static void host_line_set(uint8_t line, uint8_t active) {
+    host_line[line] = active;
+    if (line == HOST_LINE_SD_CS) host_sd_select(active);
+    else host_lcd_line(line, active);
+}
+
+void CS_Activate_0(void)   { SPI_apply_profile(0); host_line_set(0, 1); }
+void CS_Deactivate_0(void) { host_line_set(0, 0); }
+void CS_Activate_1(void)   { host_line_set(1, 1); }
+void CS_Deactivate_1(void) { host_line_set(1, 0); }
+void CS_Activate_2(void)   { host_line_set(2, 1); }
+void CS_Deactivate_2(void) { host_line_set(2, 0); }
+void CS_Activate_3(void)   { host_line_set(3, 1); }
+void CS_Deactivate_3(void) { host_line_set(3, 0); }
+
+void spi_init(void) {
+    SPI1->CR1 = SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI | SPI_BaudRatePrescaler_64 | SPI_CR1_SPE;
+    SPI2->CR1 = SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI | SPI_CR1_DFF |
+                SPI_BaudRatePrescaler_4 | SPI_CR1_SPE;
+    SPI1->SR = SPI_SR_TXE;
+    SPI2->SR = SPI_SR_TXE;
+    for (uint8_t i = 0; i < 4; i++) host_line[i] = 0;
+    Create_SPI_devices(SPI_devices);
+}
+
+void Create_SPI_devices(spi_device_t *SPI_devices) {
+    SPI_devices[0].activate   = CS_Activate_0;
+    SPI_devices[0].deactivate = CS_Deactivate_0;
+    SPI_devices[1].activate   = CS_Activate_1;
+    SPI_devices[1].deactivate = CS_Deactivate_1;
+    SPI_devices[2].activate   = CS_Activate_2;
+    SPI_devices[2].deactivate = CS_Deactivate_2;
+    SPI_devices[3].activate   = CS_Activate_3;
+    SPI_devices[3].deactivate = CS_Deactivate_3;
+
+    SPI_devices[0].SPI     = SPI1;
+    SPI_devices[0].profile = SPI_BaudRatePrescaler_64;
+    SPI_devices[1].SPI     = NULL;
+    SPI_devices[1].profile = 0;
+    SPI_devices[2].SPI     = SPI2;
+    SPI_devices[2].profile = SPI_CR1_DFF | SPI_BaudRatePrescaler_4;
+    SPI_devices[3].SPI     = NULL;
+    SPI_devices[3].profile = 0;
+}
+
+void SPI_set_profile(uint8_t key_number, uint16_t profile) {
+    SPI_devices[key_number].profile = profile & SPI_PROFILE_MASK;
+}
+
+void SPI_apply_profile(uint8_t key_number) {
+    spi_device_t *dev = &SPI_devices[key_number];
+    if (dev->SPI == NULL) return;
+
+    uint16_t cr1 = dev->SPI->CR1;
+    if ((cr1 & SPI_PROFILE_MASK) == dev->profile) return;
+
+    if (host_dma_active(dev->SPI)) host_error("SPI%d: смена CR1 во время DMA", dev->SPI == SPI1 ? 1 : 2);
+    host_bus.profile_writes[dev->SPI == SPI1 ? 0 : 1]++;
+    cr1 &= ~(SPI_PROFILE_MASK | SPI_CR1_SPE);
+    dev->SPI->CR1 = cr1 | dev->profile | SPI_CR1_SPE;
+}
+
+void SPI1_TransmitReceive(uint16_t *tx_data, uint16_t *rx_data, uint8_t key_number) {
+    SPI_devices[key_number].activate();
+    for (uint8_t i = 0; i < 2; i++) rx_data[i] = SPI_transfer(SPI1, (uint8_t)tx_data[i]);
+    SPI_devices[key_number].deactivate();
+}
+
+uint8_t SPI1_write(SPI_TypeDef *SPI, uint8_t data) {
+    return SPI_transfer(SPI, data);
+}
+
+uint8_t SPI_transfer(SPI_TypeDef *SPI, uint8_t data) {
+    if (SPI != SPI1) {
+        host_error("SPI_transfer: дисплей ничего не отвечает");
+        return 0xFF;
+    }
+    if (host_dma_active(SPI1)) host_error("SPI1: байт от CPU во время DMA");
+
+    host_bus_busy[1] = 1;
+    if (host_fatfs_masked()) host_bus.spi1_masked_bytes++;
+    uint8_t r = host_spi1_byte(data);
+    host_bus_busy[1] = 0;
+    return r;
+}
+
+void SPI_send(SPI_TypeDef *SPI, char data) {
+    SD_cart_CS.activate();
+    SPI_transfer(SPI, (uint8_t)data);
+    SD_cart_CS.deactivate();
+}
+
+void SPI_write_16bit(SPI_TypeDef *SPI, uint16_t data) {
+    if (SPI != SPI2) {
+        host_error("SPI_write_16bit: не SPI2");
+        return;
+    }
+    if (host_dma_active(SPI2)) host_error("SPI2: слово от CPU во время DMA");
+
+    host_bus_busy[2] = 1;
+    if (SPI2->CR1 & SPI_CR1_DFF) {
+        host_spi2_frame(data);
+    } else {
+        host_spi2_frame(data >> 8);
+        host_spi2_frame(data & 0xFF);
+    }
+    host_bus_busy[2] = 0;
+}
+
+void SPI_send_16bit(SPI_TypeDef *SPI, uint16_t data) {
+    LCD_CS.activate();
+    SPI_write_16bit(SPI, data);
+    LCD_CS.deactivate();
+}
+
+void SPI_wait_idle(SPI_TypeDef *SPI) {
+    (void)SPI;
+}
+
+// -----------------------------------------------------------------------------
+// DMA1
+// -----------------------------------------------------------------------------
+
+void host_bus_clear(void) {
+    memset(&host_bus, 0, sizeof(host_bus));
+}
+
+void host_dma_latency(uint8_t ticks) {
+    host_dma_wait = ticks;
+}
+
+/**
+ * @brief Готов ли канал к работе: включён, есть что передавать, прошла задержка
+ */
+static uint8_t host_dma_ready(uint8_t n) {
+    DMA_Channel_TypeDef *ch = &host_dma1_channel[n];
+    if (!(ch->CCR & DMA_CCR_EN) || ch->CNDTR == 0) {
+        host_dma_age[n] = 0;
+        return 0;
+    }
+    if (host_dma_age[n] < host_dma_wait) {
+        host_dma_age[n]++;
+        return 0;
+    }
+    host_dma_age[n] = 0;
+    return 1;
+}
+
+/**
+ * @brief Флаг окончания и прерывание канала; флаг должен сбросить обработчик
+ */
+static void host_dma_complete(uint8_t n, IRQn_Type irq, void (*handler)(void)) {
+    uint32_t flags = (DMA_ISR_GIF1 | DMA_ISR_TCIF1) << (4 * (n - 1));
+    DMA_Channel_TypeDef *ch = &host_dma1_channel[n];
+
+    host_dma1.ISR |= flags;
+    if (!(ch->CCR & DMA_CCR_TCIE) || !host_nvic_enabled(irq)) return;
+
+    host_dma1.IFCR = 0;
+    handler();
+    if (!(host_dma1.IFCR & (DMA_IFCR_CGIF1 << (4 * (n - 1))))) {
+        host_error("DMA1 канал %d: обработчик не сбросил флаг", n);
+    }
+    host_dma1.ISR &= ~flags;
+}
+
+static uint16_t host_dma_read(DMA_Channel_TypeDef const *ch, uint32_t i) {
+    uint32_t msize = (ch->CCR & DMA_CCR_MSIZE) >> DMA_CCR_MSIZE_Pos;
+    uintptr_t addr = ch->CMAR + ((ch->CCR & DMA_CCR_MINC) ? (i << msize) : 0);
+    return msize ? *(const uint16_t *)addr : *(const uint8_t *)addr;
+}
+
+/**
+ * @brief Канал 5: память -> SPI2 (дисплей)
+ */
+static uint8_t host_dma_spi2(void) {
+    if (host_bus_busy[2] || !(SPI2->CR2 & SPI_CR2_TXDMAEN) || !host_dma_ready(5)) return 0;
+
+    DMA_Channel_TypeDef *ch = DMA1_Channel5;
+    if (!(ch->CCR & DMA_CCR_DIR) || ch->CPAR != (uint32_t)(uintptr_t)&SPI2->DR) {
+        host_error("DMA1 канал 5: ожидается память -> SPI2->DR");
+    }
+    // В CNDTR только 16 бит: больше за один запуск канал не передаст
+    if (ch->CNDTR > 0xFFFF) {
+        host_error("DMA1 канал 5: CNDTR = %u больше 65535", (unsigned)ch->CNDTR);
+        ch->CNDTR &= 0xFFFF;
+    }
+    for (uint32_t i = 0; i < ch->CNDTR; i++) {
+        host_spi2_frame(host_dma_read(ch, i));
+        host_bus.spi2_dma_words++;
+    }
+    ch->CNDTR = 0;
+    host_dma_complete(5, DMA1_Channel5_IRQn, DMA1_Channel5_IRQHandler);
+    return 1;
+}
+
+/**
+ * @brief Каналы 2 (SPI1 -> память) и 3 (память -> SPI1): карта
+ */
+static uint8_t host_dma_spi1(void) {
+    DMA_Channel_TypeDef *rx = DMA1_Channel2;
+    DMA_Channel_TypeDef *tx = DMA1_Channel3;
+    uint32_t both = SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+
+    if (host_bus_busy[1] || (SPI1->CR2 & both) != both) return 0;
+    if (!(rx->CCR & DMA_CCR_EN) || !(tx->CCR & DMA_CCR_EN)) return 0;
+    if (!host_dma_ready(3)) return 0;
+
+    if (rx->CNDTR != tx->CNDTR) host_error("DMA1: у каналов 2 и 3 разная длина");
+    if ((rx->CCR & DMA_CCR_DIR) || !(tx->CCR & DMA_CCR_DIR)) host_error("DMA1: направления каналов 2/3");
+
+    uint32_t n = tx->CNDTR;
+    uint8_t *dst = (uint8_t *)(uintptr_t)rx->CMAR;
+    for (uint32_t i = 0; i < n; i++) {
+        uint8_t r = host_spi1_byte((uint8_t)host_dma_read(tx, i));
+        dst[(rx->CCR & DMA_CCR_MINC) ? i : 0] = r;
+    }
+    host_bus.spi1_dma_bytes += n;
+    rx->CNDTR = 0;
+    tx->CNDTR = 0;
+    host_dma1.ISR |= (DMA_ISR_GIF3 | DMA_ISR_TCIF3);
+    host_dma_complete(2, DMA1_Channel2_IRQn, DMA1_Channel2_IRQHandler);
+    host_dma1.ISR &= ~(DMA_ISR_GIF3 | DMA_ISR_TCIF3);
+    return 1;
+}
+
+static void host_dma_service(void) {
+    // Обработчик может сразу запустить следующую порцию — её тоже
+    for (uint8_t pass = 0; pass < 64; pass++) {
+        uint8_t did = host_dma_spi2();
+        did |= host_dma_spi1();
+        if (!did) break;
+    }
+}
+
+static void host_tick(int sig) {
+    (void)sig;
+    host_dma_service();
+}
+
+void host_dma_idle(void) {
+    time_t deadline = time(NULL) + HOST_IDLE_TIMEOUT_S;
+    while (host_dma_active(SPI1) || host_dma_active(SPI2)) {
+        if (time(NULL) > deadline) {
+            host_error("DMA не закончился за %d с", HOST_IDLE_TIMEOUT_S);
+            return;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Запуск теста
+// -----------------------------------------------------------------------------
+
+static ucontext_t host_main_ctx;
+static ucontext_t host_test_ctx;
+static void (*host_test)(void);
+
+static void host_entry(void) {
+    host_test();
+}
+
+static void host_timer(uint32_t us) {
+    struct itimerval t = {{0, us}, {0, us}};
+    setitimer(ITIMER_REAL, &t, NULL);
+}
+
+int host_run(void (*test)(void)) {
+    // DMA берёт адрес из 32-битного CMAR: данные и стек должны быть ниже 4 ГБ
+    if ((uintptr_t)&host_errors > UINT32_MAX) {
+        fprintf(stderr, "host: статические данные выше 4 ГБ, нужна сборка с -no-pie\n");
+        return 1;
+    }
+    void *stack = mmap(NULL, HOST_STACK_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+    if (stack == MAP_FAILED) {
+        perror("host: mmap");
+        return 1;
+    }
+
+    setvbuf(stdout, NULL, _IONBF, 0);
+    host_uart_echo = getenv("HOST_UART") != NULL;
+    host_uart_clear();
+    host_bus_clear();
+    host_lcd_reset();
+    host_sd_insert(HOST_SD_V2HC, 0);
+    spi_init();
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = host_tick;
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGALRM, &sa, NULL);
+
+    host_test = test;
+    getcontext(&host_test_ctx);
+    host_test_ctx.uc_stack.ss_sp = stack;
+    host_test_ctx.uc_stack.ss_size = HOST_STACK_SIZE;
+    host_test_ctx.uc_link = &host_main_ctx;
+    makecontext(&host_test_ctx, host_entry, 0);
+
+    host_timer(HOST_TICK_US);
+    swapcontext(&host_main_ctx, &host_test_ctx);
+    host_timer(0);
+
+    if (host_errors) printf("host: ошибок модели: %u\n", (unsigned)host_errors);
+    uint32_t failed = host_failures + host_errors;
+    printf("%s\n", failed ? "FAIL" : "OK");
+    return failed ? 1 : 0;
+}
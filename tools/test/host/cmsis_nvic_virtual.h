@@ -0,0 +1,23 @@
+#ifndef HOST_CMSIS_NVIC_VIRTUAL_H
+#define HOST_CMSIS_NVIC_VIRTUAL_H
+
+/**
+ * @file cmsis_nvic_virtual.h
+ * @brief NVIC модели платы: core_cm3.h подключает его при CMSIS_NVIC_VIRTUAL
+ *
+ * Прерывание DMA вызывается моделью, только если прошивка его разрешила.
+ */
+
+void     host_nvic_enable_irq(IRQn_Type irq);
+void     host_nvic_disable_irq(IRQn_Type irq);
+uint32_t host_nvic_enabled(IRQn_Type irq);
+void     host_nvic_set_priority(IRQn_Type irq, uint32_t priority);
+uint32_t host_nvic_get_priority(IRQn_Type irq);
+
+#define NVIC_EnableIRQ       host_nvic_enable_irq
+#define NVIC_DisableIRQ      host_nvic_disable_irq
+#define NVIC_GetEnableIRQ    host_nvic_enabled
+#define NVIC_SetPriority     host_nvic_set_priority
+#define NVIC_GetPriority     host_nvic_get_priority
+
+#endif /* HOST_CMSIS_NVIC_VIRTUAL_H */
@@ -0,0 +1,273 @@
+#ifndef HOST_H
+#define HOST_H
+
+/**
+ * @file host.h
+ * @brief Модель платы для тестов прошивки на ПК
+ *
+ * Прошивка собирается обычным компилятором хоста вместе с моделью:
+ * - board.c — SPI-устройства вместо src/SPI.c, DMA1 (каналы 2, 3, 5) с
+ *   прерываниями, NVIC, get_ms()/Delay_ms() по модельному времени, UART в буфер;
+ * - lcd.c   — ILI9225 на SPI2: регистры, окно, счётчик адреса, GRAM;
+ * - sd.c    — SD-карта на SPI1 в SPI-режиме (SDv1, SDv2 SDSC, SDHC).
+ *
+ * DMA идёт по таймеру (SIGALRM), то есть как настоящее прерывание —
+ * посреди кода прошивки, в том числе пока она крутится в ожидании.
+ * Адреса для DMA 32-битные, поэтому тест выполняется на стеке ниже 4 ГБ
+ * (host_run), а сама программа собирается с -no-pie.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stm32f1xx.h>   // через -I: иначе #include_next найдёт этот же файл
+#include "ILI9225.h"
+
+// -----------------------------------------------------------------------------
+// Запуск и проверки
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Запуск теста на модели: spi_init(), модели в исходном состоянии
+ * @param test тело теста
+ * @return код выхода для ctest: 0 — все проверки прошли
+ */
+int host_run(void (*test)(void));
+
+/**
+ * @brief Проверка условия; при провале — сообщение с местом и счётчик ошибок
+ */
+#define CHECK(cond)  host_check((cond) != 0, #cond, __FILE__, __LINE__)
+
+/**
+ * @brief Проверка равенства целых с выводом обоих значений
+ */
+#define CHECK_EQ(a, b)  host_check_eq((long long)(a), (long long)(b), #a, #b, __FILE__, __LINE__)
+
+int  host_check(int ok, const char *what, const char *file, int line);
+int  host_check_eq(long long a, long long b, const char *sa, const char *sb, const char *file, int line);
+
+/**
+ * @brief Ошибка модели: неверная последовательность на шине и т.п.
+ * Можно звать из прерывания
+ */
+void host_error(const char *fmt, ...);
+
+extern volatile uint32_t host_errors;   // ошибки моделей
+
+// -----------------------------------------------------------------------------
+// Плата: линии, время, DMA, UART
+// -----------------------------------------------------------------------------
+
+// Линии устройств SPI_devices[]: 1 — активна (на ножке 0)
+#define HOST_LINE_SD_CS     0
+#define HOST_LINE_LCD_RST   1
+#define HOST_LINE_LCD_CS    2
+#define HOST_LINE_LCD_RS    3
+extern volatile uint8_t host_line[4];
+
+// Байты и кадры на шинах с начала теста (или host_bus_clear)
+typedef struct {
+    uint32_t spi1_bytes;        // SPI1 целиком: и CPU, и DMA
+    uint32_t spi1_dma_bytes;
+    uint32_t spi1_masked_bytes; // CPU при BASEPRI, закрывающем EXTI с FatFS
+    uint32_t spi2_frames8;      // кадры SPI2 по 8 бит
+    uint32_t spi2_frames16;     // кадры SPI2 по 16 бит
+    uint32_t spi2_dma_words;    // из них пришло через DMA (канал 5)
+    uint32_t profile_writes[2]; // сколько раз менялся CR1 SPI1 / SPI2
+} host_bus_stats_t;
+
+extern host_bus_stats_t host_bus;
+void host_bus_clear(void);
+
+/**
+ * @brief Модельное время, мкс
+ * Идёт от байтов на шинах (по делителю из CR1), от Delay_ms() и на 1 мкс
+ * за каждый вызов get_ms()/get_us(), чтобы циклы ожидания кончались
+ */
+uint64_t host_time_us(void);
+
+/**
+ * @brief Прогнать SysTick на cycles тактов ядра (HCLK 72 МГц)
+ * Счётчик идёт по CTRL/LOAD/VAL, как их настроил SysTick_init(), и на
+ * переходе в 0 зовёт SysTick_Handler(). С модельным временем не связан:
+ * нужен тестам, собранным с настоящим src/TIMER.c
+ */
+void host_systick_run(uint32_t cycles);
+
+/**
+ * @brief BASEPRI модели; прошивка меняет его через __set_BASEPRI()
+ */
+uint32_t host_get_basepri(void);
+
+/**
+ * @brief Дождаться, пока DMA доработает (каналы выключены или стоят)
+ */
+void host_dma_idle(void);
+
+/**
+ * @brief Задержка DMA: канал начинает работать не раньше, чем через
+ * столько срабатываний таймера после включения. Больше — сильнее
+ * проверка, что прошивка не трогает буфер, который ещё передаётся
+ */
+void host_dma_latency(uint8_t ticks);
+
+/**
+ * @brief Всё, что прошивка вывела в UART с последнего host_uart_clear()
+ */
+const char *host_uart_log(void);
+void host_uart_clear(void);
+
+// -----------------------------------------------------------------------------
+// Дисплей ILI9225
+// -----------------------------------------------------------------------------
+
+typedef struct {
+    uint32_t index_writes;      // выбор регистра (RS = 0)
+    uint32_t reg_writes[256];   // запись в регистр, кроме GRAM
+    uint32_t pixels;            // слова в GRAM_DATA_REG
+    uint32_t outside;           // из них вне окна (ошибка)
+} host_lcd_stats_t;
+
+extern host_lcd_stats_t host_lcd;
+
+// Окно записи: сколько раз его меняли (любой из четырёх регистров)
+uint32_t host_lcd_window_writes(void);
+
+/**
+ * @brief Пиксель GRAM в физических координатах (176 x 220)
+ */
+uint16_t host_lcd_pixel(uint16_t x, uint16_t y);
+
+/**
+ * @brief Пиксель, который видно на экране в (x, y): GRAM с учётом
+ * вертикальной прокрутки (VERTICAL_SCROLL_CTRL1..3)
+ */
+uint16_t host_lcd_visible(uint16_t x, uint16_t y);
+
+/**
+ * @brief Значение регистра дисплея
+ */
+uint16_t host_lcd_reg(uint8_t reg);
+
+void host_lcd_clear_stats(void);
+
+/**
+ * @brief Заливка GRAM одним цветом (в обход шины, для подготовки теста)
+ */
+void host_lcd_fill(uint16_t color);
+
+/**
+ * @brief Сравнение области GRAM с эталоном
+ *
+ * При расхождении обе картинки пишутся в <name>.ppm и <name>_ref.ppm
+ * в текущий каталог (каталог сборки ctest).
+ * @param ref эталон RGB565, w * h, строки сверху вниз
+ * @return число несовпавших пикселей
+ */
+uint32_t host_lcd_expect(const uint16_t *ref, uint16_t x, uint16_t y,
+                         uint16_t w, uint16_t h, const char *name);
+
+/**
+ * @brief Сравнение области GRAM с эталонной картинкой tools/test/golden/<name>.ppm
+ *
+ * С переменной окружения HOST_GOLDEN_UPDATE эталон вместо сравнения
+ * перезаписывается текущей картинкой.
+ * @return число несовпавших пикселей (нет файла — вся область)
+ */
+uint32_t host_lcd_golden(const char *name, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+/**
+ * @brief Запись области GRAM в PPM (P6)
+ */
+int host_lcd_write_ppm(const char *path, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+/**
+ * @brief Чтение PPM (P3 или P6) в RGB565
+ * @return 1 если файл прочитан и размеры совпали
+ */
+int host_ppm_load(const char *path, uint16_t *dst, uint16_t w, uint16_t h);
+
+/**
+ * @brief Запись картинки RGB565 в PPM (P6)
+ */
+int host_ppm_write(const char *path, const uint16_t *src, uint16_t w, uint16_t h);
+
+/**
+ * @brief Цвет RGB888 в RGB565 — эталон, независимый от ILI9225_colours.h
+ */
+static inline uint16_t host_rgb565(uint8_t r, uint8_t g, uint8_t b) {
+    return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+}
+
+// -----------------------------------------------------------------------------
+// SD-карта
+// -----------------------------------------------------------------------------
+
+#define HOST_SD_V1      0   // SD 1.x: CMD8 неизвестна, адресация байтами
+#define HOST_SD_V2SC    1   // SD 2.0 до 2 ГБ: адресация байтами
+#define HOST_SD_V2HC    2   // SDHC: адресация блоками, нужен HCS в ACMD41
+
+typedef struct {
+    uint32_t cmd[64];           // команды по номерам
+    uint32_t acmd[64];          // команды после CMD55
+    uint32_t acmd23_arg;        // последний ACMD23 (блоков на стирание)
+    uint32_t blocks_read;       // блоки, отданные карте (CMD17 и CMD18)
+    uint32_t blocks_written;    // блоки, принятые картой
+} host_sd_stats_t;
+
+extern host_sd_stats_t host_sd;
+
+/**
+ * @brief Вставить карту: содержимое нулевое
+ * @param gen HOST_SD_*
+ * @param sectors ёмкость в секторах по 512 байт; 0 — карты нет.
+ * SDHC — кратно 1024, SDSC — кратно 512
+ */
+void host_sd_insert(uint8_t gen, uint32_t sectors);
+
+/**
+ * @brief Содержимое сектора карты (в обход шины)
+ */
+uint8_t *host_sd_sector(uint32_t sector);
+
+/**
+ * @brief Занятость после записи блока, байт 0x00; -1 — карта висит
+ */
+void host_sd_busy(int32_t bytes);
+
+/**
+ * @brief Сколько ACMD41 до выхода из IDLE; -1 — карта не выходит
+ */
+void host_sd_ready_after(int32_t polls);
+
+/**
+ * @brief AU_SIZE в ответе ACMD13 (0 — не сообщается); -1 — по ёмкости.
+ * Сбрасывается в host_sd_insert()
+ */
+void host_sd_au_size(int8_t au);
+
+/**
+ * @brief Сектор, на чтение которого карта отвечает Data Error Token;
+ * -1 — таких нет. Сбрасывается в host_sd_insert()
+ */
+void host_sd_bad_sector(int32_t sector);
+
+void host_sd_clear_stats(void);
+
+// -----------------------------------------------------------------------------
+// Файлы на модельной карте (через FatFS прошивки)
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Новая карта и filesystem_init(): форматирование и монтирование
+ * @return FR_OK при успехе
+ */
+int host_fs_format(uint8_t gen, uint32_t sectors);
+
+/**
+ * @brief Записать файл целиком
+ * @return FR_OK при успехе
+ */
+int host_fs_write(const char *name, const void *data, uint32_t len);
+
+#endif /* HOST_H */
@@ -0,0 +1,51 @@
+#ifndef HOST_MODELS_H
+#define HOST_MODELS_H
+
+/**
+ * @file host_models.h
+ * @brief Связь модели платы (board.c) с моделями устройств на шинах
+ *
+ * Тестам не нужен: они видят устройства через host.h.
+ */
+
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Дисплей (lcd.c), SPI2
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Исходное состояние: регистры после сброса, GRAM чёрная, счётчики 0
+ */
+void host_lcd_reset(void);
+
+/**
+ * @brief Смена линии CS, RS или RST (1 — активна)
+ */
+void host_lcd_line(uint8_t line, uint8_t active);
+
+/**
+ * @brief 16-битный кадр SPI2
+ */
+void host_lcd_word(uint16_t word);
+
+/**
+ * @brief 8-битный кадр SPI2: дисплей собирает слово из двух, старший первым
+ */
+void host_lcd_byte(uint8_t byte);
+
+// -----------------------------------------------------------------------------
+// SD-карта (sd.c), SPI1
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Смена CS карты (1 — выбрана)
+ */
+void host_sd_select(uint8_t active);
+
+/**
+ * @brief Байт на шине: карта принимает data и отвечает
+ */
+uint8_t host_sd_xfer(uint8_t data);
+
+#endif /* HOST_MODELS_H */
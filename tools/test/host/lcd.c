@@ -0,0 +1,296 @@
+/**
+ * @file lcd.c
+ * @brief Модель ILI9225 на SPI2: индекс регистра, регистры, окно, GRAM
+ *
+ * Слово при активной RS выбирает регистр, без RS — пишется в выбранный.
+ * Регистр GRAM_DATA_REG (0x22) кладёт пиксель по счётчику адреса и
+ * двигает счётчик по ENTRY_MODE (AM, ID0, ID1) в пределах окна, как
+ * контроллер: конец строки окна — переход на следующую, конец окна —
+ * снова начало.
+ */
+
+#include "host.h"
+#include "host_models.h"
+#include <string.h>
+#include <stdlib.h>
+
+#ifndef HOST_TEST_DATA
+#define HOST_TEST_DATA  "."
+#endif
+
+// -----------------------------------------------------------------------------
+// Состояние
+// -----------------------------------------------------------------------------
+
+#define ENTRY_AM    0x0008
+#define ENTRY_ID0   0x0010
+#define ENTRY_ID1   0x0020
+
+host_lcd_stats_t host_lcd;
+
+static uint16_t lcd_gram[LCD_HEIGHT][LCD_WIDTH];
+static uint16_t lcd_reg[256];
+static uint8_t  lcd_index;
+static uint16_t lcd_x;
+static uint16_t lcd_y;
+static uint8_t  lcd_half;        // 8-битный режим: принят старший байт
+static uint16_t lcd_high;
+
+void host_lcd_clear_stats(void) {
+    memset(&host_lcd, 0, sizeof(host_lcd));
+}
+
+/**
+ * @brief Регистры после аппаратного сброса (по документации)
+ */
+static void lcd_power_on(void) {
+    memset(lcd_reg, 0, sizeof(lcd_reg));
+    lcd_reg[ENTRY_MODE]              = 0x1030;
+    lcd_reg[HORIZONTAL_WINDOW_ADDR1] = LCD_WIDTH - 1;
+    lcd_reg[VERTICAL_WINDOW_ADDR1]   = LCD_HEIGHT - 1;
+    lcd_index = 0;
+    lcd_x = 0;
+    lcd_y = 0;
+    lcd_half = 0;
+}
+
+void host_lcd_reset(void) {
+    lcd_power_on();
+    host_lcd_fill(0);
+    host_lcd_clear_stats();
+}
+
+void host_lcd_fill(uint16_t color) {
+    for (uint16_t y = 0; y < LCD_HEIGHT; y++) {
+        for (uint16_t x = 0; x < LCD_WIDTH; x++) lcd_gram[y][x] = color;
+    }
+}
+
+uint16_t host_lcd_pixel(uint16_t x, uint16_t y) {
+    if (x >= LCD_WIDTH || y >= LCD_HEIGHT) return 0;
+    return lcd_gram[y][x];
+}
+
+uint16_t host_lcd_reg(uint8_t reg) {
+    return lcd_reg[reg];
+}
+
+uint16_t host_lcd_visible(uint16_t x, uint16_t y) {
+    uint16_t sea = lcd_reg[VERTICAL_SCROLL_CTRL1];
+    uint16_t ssa = lcd_reg[VERTICAL_SCROLL_CTRL2];
+    uint16_t sst = lcd_reg[VERTICAL_SCROLL_CTRL3];
+
+    // Строка затвора y в области прокрутки показывает строку GRAM на sst дальше
+    if (ssa <= sea && sea < LCD_HEIGHT && y >= ssa && y <= sea) {
+        y = ssa + (y - ssa + sst) % (sea - ssa + 1);
+    }
+    return host_lcd_pixel(x, y);
+}
+
+uint32_t host_lcd_window_writes(void) {
+    return host_lcd.reg_writes[HORIZONTAL_WINDOW_ADDR1] + host_lcd.reg_writes[HORIZONTAL_WINDOW_ADDR2] +
+           host_lcd.reg_writes[VERTICAL_WINDOW_ADDR1] + host_lcd.reg_writes[VERTICAL_WINDOW_ADDR2];
+}
+
+// -----------------------------------------------------------------------------
+// Шина
+// -----------------------------------------------------------------------------
+
+void host_lcd_line(uint8_t line, uint8_t active) {
+    if (line == HOST_LINE_LCD_RST) {
+        if (active) lcd_power_on();
+    } else if (line == HOST_LINE_LCD_CS && !active) {
+        if (lcd_half) host_error("LCD: CS снят посреди 16-битного слова");
+        lcd_half = 0;
+    }
+}
+
+/**
+ * @brief Шаг счётчика адреса вдоль одной оси с переносом на границе окна
+ * @return 1 если был перенос
+ */
+static uint8_t lcd_step(uint16_t *pos, uint8_t inc, uint16_t start, uint16_t end) {
+    if (inc) {
+        if (*pos >= end) { *pos = start; return 1; }
+        (*pos)++;
+    } else {
+        if (*pos <= start) { *pos = end; return 1; }
+        (*pos)--;
+    }
+    return 0;
+}
+
+static void lcd_gram_write(uint16_t color) {
+    uint16_t mode = lcd_reg[ENTRY_MODE];
+    uint16_t hs = lcd_reg[HORIZONTAL_WINDOW_ADDR2], he = lcd_reg[HORIZONTAL_WINDOW_ADDR1];
+    uint16_t vs = lcd_reg[VERTICAL_WINDOW_ADDR2],   ve = lcd_reg[VERTICAL_WINDOW_ADDR1];
+
+    host_lcd.pixels++;
+    if (lcd_x < hs || lcd_x > he || lcd_y < vs || lcd_y > ve || lcd_x >= LCD_WIDTH || lcd_y >= LCD_HEIGHT) {
+        host_lcd.outside++;
+    } else {
+        lcd_gram[lcd_y][lcd_x] = color;
+    }
+
+    uint8_t xi = (mode & ENTRY_ID0) != 0;
+    uint8_t yi = (mode & ENTRY_ID1) != 0;
+    if (mode & ENTRY_AM) {
+        if (lcd_step(&lcd_y, yi, vs, ve)) lcd_step(&lcd_x, xi, hs, he);
+    } else {
+        if (lcd_step(&lcd_x, xi, hs, he)) lcd_step(&lcd_y, yi, vs, ve);
+    }
+}
+
+void host_lcd_word(uint16_t word) {
+    if (!host_line[HOST_LINE_LCD_CS]) {
+        host_error("LCD: слово 0x%04X без CS", word);
+        return;
+    }
+    if (host_line[HOST_LINE_LCD_RST]) {
+        host_error("LCD: слово 0x%04X во время сброса", word);
+        return;
+    }
+
+    if (host_line[HOST_LINE_LCD_RS]) {
+        lcd_index = (uint8_t)word;
+        host_lcd.index_writes++;
+        return;
+    }
+
+    if (lcd_index == GRAM_DATA_REG) {
+        lcd_gram_write(word);
+        return;
+    }
+
+    lcd_reg[lcd_index] = word;
+    host_lcd.reg_writes[lcd_index]++;
+    if (lcd_index == RAM_ADDR_SET1) lcd_x = word & 0xFF;
+    if (lcd_index == RAM_ADDR_SET2) lcd_y = word & 0xFF;
+}
+
+void host_lcd_byte(uint8_t byte) {
+    if (!lcd_half) {
+        lcd_high = byte;
+        lcd_half = 1;
+        return;
+    }
+    lcd_half = 0;
+    host_lcd_word((uint16_t)((lcd_high << 8) | byte));
+}
+
+// -----------------------------------------------------------------------------
+// Картинки
+// -----------------------------------------------------------------------------
+
+static void ppm_put(FILE *f, uint16_t c) {
+    uint8_t rgb[3] = {
+        (uint8_t)(((c >> 11) & 0x1F) * 255 / 31),
+        (uint8_t)(((c >> 5) & 0x3F) * 255 / 63),
+        (uint8_t)((c & 0x1F) * 255 / 31),
+    };
+    fwrite(rgb, 1, 3, f);
+}
+
+int host_ppm_write(const char *path, const uint16_t *src, uint16_t w, uint16_t h) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return 0;
+    fprintf(f, "P6\n%u %u\n255\n", w, h);
+    for (uint32_t i = 0; i < (uint32_t)w * h; i++) ppm_put(f, src[i]);
+    fclose(f);
+    return 1;
+}
+
+int host_lcd_write_ppm(const char *path, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return 0;
+    fprintf(f, "P6\n%u %u\n255\n", w, h);
+    for (uint16_t j = 0; j < h; j++) {
+        for (uint16_t i = 0; i < w; i++) ppm_put(f, host_lcd_pixel(x + i, y + j));
+    }
+    fclose(f);
+    return 1;
+}
+
+/**
+ * @brief Число из заголовка PPM, комментарии '#' пропускаются
+ */
+static int ppm_number(FILE *f, unsigned *v) {
+    int c;
+    while ((c = fgetc(f)) != EOF) {
+        if (c == '#') {
+            while ((c = fgetc(f)) != EOF && c != '\n') {}
+        } else if (c > ' ') {
+            ungetc(c, f);
+            return fscanf(f, "%u", v) == 1;
+        }
+    }
+    return 0;
+}
+
+int host_ppm_load(const char *path, uint16_t *dst, uint16_t w, uint16_t h) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return 0;
+
+    char magic[3] = {0};
+    unsigned fw, fh, max;
+    int ok = fread(magic, 1, 2, f) == 2 && magic[0] == 'P' && (magic[1] == '3' || magic[1] == '6') &&
+             ppm_number(f, &fw) && ppm_number(f, &fh) && ppm_number(f, &max) &&
+             fw == w && fh == h && max == 255;
+    if (ok && magic[1] == '6') fgetc(f);
+
+    for (uint32_t i = 0; ok && i < (uint32_t)w * h; i++) {
+        unsigned rgb[3];
+        for (uint8_t k = 0; ok && k < 3; k++) {
+            if (magic[1] == '3') {
+                ok = ppm_number(f, &rgb[k]);
+            } else {
+                int c = fgetc(f);
+                ok = c != EOF;
+                rgb[k] = (unsigned)c;
+            }
+        }
+        if (ok) dst[i] = host_rgb565((uint8_t)rgb[0], (uint8_t)rgb[1], (uint8_t)rgb[2]);
+    }
+    fclose(f);
+    return ok;
+}
+
+uint32_t host_lcd_expect(const uint16_t *ref, uint16_t x, uint16_t y,
+                         uint16_t w, uint16_t h, const char *name) {
+    uint32_t bad = 0;
+    for (uint16_t j = 0; j < h; j++) {
+        for (uint16_t i = 0; i < w; i++) {
+            if (host_lcd_pixel(x + i, y + j) != ref[(uint32_t)j * w + i]) bad++;
+        }
+    }
+    if (bad) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s.ppm", name);
+        host_lcd_write_ppm(path, x, y, w, h);
+        snprintf(path, sizeof(path), "%s_ref.ppm", name);
+        host_ppm_write(path, ref, w, h);
+        printf("%s: %u пикселей не совпало, см. %s.ppm и %s_ref.ppm\n", name, (unsigned)bad, name, name);
+    }
+    return bad;
+}
+
+uint32_t host_lcd_golden(const char *name, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.ppm", HOST_TEST_DATA, name);
+
+    if (getenv("HOST_GOLDEN_UPDATE")) {
+        printf("%s: эталон перезаписан\n", path);
+        return host_lcd_write_ppm(path, x, y, w, h) ? 0 : (uint32_t)w * h;
+    }
+
+    uint16_t *ref = malloc((size_t)w * h * sizeof(uint16_t));
+    if (!ref) return (uint32_t)w * h;
+    uint32_t bad = (uint32_t)w * h;
+    if (host_ppm_load(path, ref, w, h)) {
+        bad = host_lcd_expect(ref, x, y, w, h, name);
+    } else {
+        printf("%s: нет эталона %ux%u\n", path, w, h);
+    }
+    free(ref);
+    return bad;
+}
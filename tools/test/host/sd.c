@@ -0,0 +1,427 @@
+/**
+ * @file sd.c
+ * @brief Модель SD-карты в SPI-режиме: SDv1, SDv2 SDSC, SDHC
+ *
+ * Карта отвечает только при активном CS. Ответы на команды кладутся в
+ * очередь вывода и отдаются по одному байту на каждый принятый. Чтение
+ * CMD18 подкладывает следующий блок, пока не придёт CMD12. Запись идёт
+ * по состояниям: токен, 512 байт и CRC, ответ 0x05, занятость (0x00).
+ */
+
+#include "host.h"
+#include "host_models.h"
+#include <stdlib.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+// Состояние
+// -----------------------------------------------------------------------------
+
+#define SD_OUT_MAX      600         // блок 512 с токеном и CRC плюс ответ
+#define SD_READY_POLLS  3           // ACMD41 по умолчанию до выхода из IDLE
+
+typedef enum {
+    WR_NONE,        // запись не идёт
+    WR_TOKEN,       // ждём токен блока (или Stop Tran для CMD25)
+    WR_DATA,        // 512 байт и CRC
+    WR_RESPONSE,    // ответ на блок
+    WR_BUSY,        // занятость после блока
+    WR_STUFF,       // байт после Stop Tran, потом занятость
+} sd_wr_state_t;
+
+host_sd_stats_t host_sd;
+
+static uint8_t  *sd_mem;
+static uint32_t  sd_sectors;
+static uint8_t   sd_gen;
+static uint8_t   sd_cs;
+static uint8_t   sd_idle;
+static uint8_t   sd_app;
+static uint8_t   sd_hcs;            // ACMD41 пришла с HCS
+static int32_t   sd_polls;          // ACMD41 с момента CMD0
+static int32_t   sd_ready_polls = SD_READY_POLLS;
+static int8_t    sd_au = -1;        // AU_SIZE в SD Status, -1 — по ёмкости
+static int32_t   sd_bad = -1;       // нечитаемый сектор, -1 — таких нет
+
+static uint8_t   sd_out[SD_OUT_MAX];
+static uint16_t  sd_out_len;
+static uint16_t  sd_out_pos;
+static uint8_t   sd_out_data;       // в очереди блок чтения
+static uint8_t   sd_cmd[6];
+static uint8_t   sd_cmd_len;
+
+static uint8_t   sd_rd_multi;
+static uint32_t  sd_rd_sector;
+
+static sd_wr_state_t sd_wr;
+static uint8_t   sd_wr_multi;
+static uint32_t  sd_wr_sector;
+static uint16_t  sd_wr_count;
+static uint8_t   sd_wr_buf[514];
+static int32_t   sd_busy_bytes;
+static int32_t   sd_busy_left;
+
+// -----------------------------------------------------------------------------
+// Управление моделью
+// -----------------------------------------------------------------------------
+
+void host_sd_clear_stats(void) {
+    memset(&host_sd, 0, sizeof(host_sd));
+}
+
+void host_sd_insert(uint8_t gen, uint32_t sectors) {
+    free(sd_mem);
+    sd_mem = sectors ? calloc(sectors, 512) : NULL;
+    sd_sectors = sd_mem ? sectors : 0;
+    sd_gen = gen;
+    sd_idle = 0;
+    sd_app = 0;
+    sd_hcs = 0;
+    sd_polls = 0;
+    sd_ready_polls = SD_READY_POLLS;
+    sd_au = -1;
+    sd_bad = -1;
+    sd_out_len = sd_out_pos = 0;
+    sd_out_data = 0;
+    sd_cmd_len = 0;
+    sd_rd_multi = 0;
+    sd_wr = WR_NONE;
+    sd_busy_bytes = 0;
+    host_sd_clear_stats();
+}
+
+uint8_t *host_sd_sector(uint32_t sector) {
+    if (sector >= sd_sectors) {
+        host_error("SD: сектор %u за концом карты", (unsigned)sector);
+        return NULL;
+    }
+    return sd_mem + (size_t)sector * 512;
+}
+
+void host_sd_busy(int32_t bytes) {
+    sd_busy_bytes = bytes;
+}
+
+void host_sd_ready_after(int32_t polls) {
+    sd_ready_polls = polls;
+}
+
+void host_sd_au_size(int8_t au) {
+    sd_au = au;
+}
+
+void host_sd_bad_sector(int32_t sector) {
+    sd_bad = sector;
+}
+
+void host_sd_select(uint8_t active) {
+    sd_cs = active;
+    // Недопринятая команда теряется, начатые чтение и запись — нет
+    sd_cmd_len = 0;
+}
+
+// -----------------------------------------------------------------------------
+// Ответы
+// -----------------------------------------------------------------------------
+
+static void sd_put(uint8_t b) {
+    if (sd_out_len >= SD_OUT_MAX) {
+        host_error("SD: переполнение очереди ответа");
+        return;
+    }
+    sd_out[sd_out_len++] = b;
+}
+
+static void sd_put_block(const uint8_t *data, uint16_t len) {
+    sd_put(0xFF);
+    sd_put(0xFE);
+    for (uint16_t i = 0; i < len; i++) sd_put(data[i]);
+    sd_put(0x00);
+    sd_put(0x00);
+}
+
+/**
+ * @brief Аргумент команды в номер сектора; SDSC адресуется байтами
+ * @return 0 если адрес неверный (ошибка уже записана)
+ */
+static uint8_t sd_sector_of(uint32_t arg, uint32_t *sector) {
+    if (sd_gen != HOST_SD_V2HC) {
+        if (arg & 511) {
+            host_error("SD: адрес 0x%08X не кратен 512 (карта SDSC)", (unsigned)arg);
+            return 0;
+        }
+        arg >>= 9;
+    }
+    if (arg >= sd_sectors) {
+        host_error("SD: сектор %u за концом карты (%u)", (unsigned)arg, (unsigned)sd_sectors);
+        return 0;
+    }
+    *sector = arg;
+    return 1;
+}
+
+static void sd_make_csd(uint8_t *c) {
+    memset(c, 0, 16);
+    if (sd_gen == HOST_SD_V2HC) {
+        // CSD 2.0: (C_SIZE + 1) * 512 КБ
+        uint32_t c_size = sd_sectors / 1024 - 1;
+        c[0] = 0x40;
+        c[5] = 0x59;
+        c[7] = (uint8_t)(c_size >> 16);
+        c[8] = (uint8_t)(c_size >> 8);
+        c[9] = (uint8_t)c_size;
+        c[10] = 0x7F;
+        c[11] = 0x80;
+        c[12] = 0x0A;
+        c[13] = 0x40;
+    } else {
+        // CSD 1.0: READ_BL_LEN 9, C_SIZE_MULT 7 — (C_SIZE + 1) * 512 секторов
+        uint32_t c_size = sd_sectors / 512 - 1;
+        c[5] = 0x59;
+        c[6] = (uint8_t)((c_size >> 10) & 0x03);
+        c[7] = (uint8_t)(c_size >> 2);
+        c[8] = (uint8_t)((c_size & 0x03) << 6);
+        c[9] = 0x03;
+        c[10] = 0x80 | 0x3F;
+        c[11] = 0x80;
+        c[12] = 0x02;
+        c[13] = 0x40;
+    }
+}
+
+static void sd_app_command(uint8_t cmd, uint32_t arg, uint8_t r1) {
+    host_sd.acmd[cmd]++;
+    switch (cmd) {
+    case 41:
+        if (arg & 0x40000000) sd_hcs = 1;
+        // SDHC без HCS из IDLE не выходит
+        if (sd_gen == HOST_SD_V2HC && !(arg & 0x40000000)) {
+            sd_put(0x01);
+            return;
+        }
+        if (sd_ready_polls >= 0 && ++sd_polls >= sd_ready_polls) sd_idle = 0;
+        sd_put(sd_idle);
+        return;
+    case 13: {
+        // AU_SIZE не больше допустимого для ёмкости: до 64 МБ — 512 КБ,
+        // до 256 МБ — 1 МБ, до 512 МБ — 2 МБ, больше — 4 МБ
+        uint8_t au = (sd_sectors <= 131072) ? 6 : (sd_sectors <= 524288) ? 7 :
+                     (sd_sectors <= 1048576) ? 8 : 9;
+        if (sd_au >= 0) au = (uint8_t)sd_au;
+        uint8_t st[64] = {0};
+        st[10] = (uint8_t)(au << 4);
+        sd_put(r1);
+        sd_put(0x00);
+        sd_put_block(st, sizeof(st));
+        return;
+    }
+    case 23:
+        host_sd.acmd23_arg = arg;
+        sd_put(r1);
+        return;
+    }
+    sd_put(0x04 | r1);
+}
+
+static void sd_command(void) {
+    uint8_t cmd = sd_cmd[0] & 0x3F;
+    uint32_t arg = ((uint32_t)sd_cmd[1] << 24) | ((uint32_t)sd_cmd[2] << 16) | ((uint32_t)sd_cmd[3] << 8) | sd_cmd[4];
+    uint8_t was_app = sd_app;
+    uint8_t r1 = sd_idle ? 0x01 : 0x00;
+    uint32_t sector;
+
+    sd_app = 0;
+    sd_out_len = sd_out_pos = 0;
+    sd_out_data = 0;
+    sd_put(0xFF);   // Ncr
+
+    if (was_app) {
+        sd_app_command(cmd, arg, r1);
+        return;
+    }
+
+    host_sd.cmd[cmd]++;
+    if (cmd != 12) sd_rd_multi = 0;
+
+    switch (cmd) {
+    case 0:
+        if (sd_cmd[5] != 0x95) host_error("SD: CMD0 с неверным CRC");
+        sd_idle = 1;
+        sd_polls = 0;
+        sd_hcs = 0;
+        sd_put(0x01);
+        return;
+    case 8:
+        if (sd_gen == HOST_SD_V1) {
+            sd_put(0x05);
+            return;
+        }
+        if (sd_cmd[5] != 0x87) host_error("SD: CMD8 с неверным CRC");
+        sd_put(r1);
+        sd_put(0x00);
+        sd_put(0x00);
+        sd_put(sd_cmd[3]);
+        sd_put(sd_cmd[4]);
+        return;
+    case 55:
+        sd_app = 1;
+        sd_put(r1);
+        return;
+    case 58:
+        sd_put(r1);
+        sd_put((sd_idle ? 0x00 : 0x80) | (sd_gen == HOST_SD_V2HC && sd_hcs && !sd_idle ? 0x40 : 0x00));
+        sd_put(0xFF);
+        sd_put(0x80);
+        sd_put(0x00);
+        return;
+    case 9: {
+        uint8_t csd[16];
+        sd_make_csd(csd);
+        sd_put(r1);
+        sd_put_block(csd, sizeof(csd));
+        return;
+    }
+    case 10: {
+        static const uint8_t cid[16] = "HOST MODEL CID 1";
+        sd_put(r1);
+        sd_put_block(cid, sizeof(cid));
+        return;
+    }
+    case 12:
+        // Байт-заглушка, R1, занятость
+        sd_rd_multi = 0;
+        sd_put(r1);
+        for (uint8_t i = 0; i < 4; i++) sd_put(0x00);
+        return;
+    case 16:
+        sd_put(arg == 512 ? r1 : 0x40 | r1);
+        return;
+    case 17:
+    case 18:
+        if (sd_idle || !sd_sector_of(arg, &sector)) {
+            sd_put(0x40 | r1);
+            return;
+        }
+        sd_put(0x00);
+        if ((int32_t)sector == sd_bad) {
+            // Data Error Token: Card ECC failed
+            sd_put(0xFF);
+            sd_put(0x04);
+            return;
+        }
+        sd_put_block(host_sd_sector(sector), 512);
+        sd_out_data = 1;
+        sd_rd_multi = (cmd == 18);
+        sd_rd_sector = sector + 1;
+        return;
+    case 24:
+    case 25:
+        if (sd_idle || !sd_sector_of(arg, &sector)) {
+            sd_put(0x40 | r1);
+            return;
+        }
+        sd_put(0x00);
+        sd_wr = WR_TOKEN;
+        sd_wr_multi = (cmd == 25);
+        sd_wr_sector = sector;
+        return;
+    }
+    sd_put(0x04 | r1);
+}
+
+// -----------------------------------------------------------------------------
+// Шина
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Байт записи: фазы WR_*
+ */
+static uint8_t sd_write_byte(uint8_t data) {
+    switch (sd_wr) {
+    case WR_TOKEN:
+        if (data == 0xFE || data == 0xFC) {
+            if ((data == 0xFC) != sd_wr_multi) host_error("SD: токен 0x%02X не той записи", data);
+            sd_wr = WR_DATA;
+            sd_wr_count = 0;
+        } else if (data == 0xFD && sd_wr_multi) {
+            sd_wr = WR_STUFF;
+        } else if (data != 0xFF) {
+            host_error("SD: ожидался токен записи, пришло 0x%02X", data);
+        }
+        return 0xFF;
+
+    case WR_DATA:
+        sd_wr_buf[sd_wr_count++] = data;
+        if (sd_wr_count == sizeof(sd_wr_buf)) {
+            if (sd_wr_sector >= sd_sectors) {
+                host_error("SD: запись за концом карты");
+            } else {
+                memcpy(host_sd_sector(sd_wr_sector), sd_wr_buf, 512);
+                host_sd.blocks_written++;
+            }
+            sd_wr_sector++;
+            sd_wr = WR_RESPONSE;
+        }
+        return 0xFF;
+
+    case WR_RESPONSE:
+        sd_wr = WR_BUSY;
+        sd_busy_left = sd_busy_bytes;
+        return 0x05;
+
+    case WR_STUFF:
+        sd_wr = WR_BUSY;
+        sd_wr_multi = 0;
+        sd_busy_left = sd_busy_bytes;
+        return 0xFF;
+
+    case WR_BUSY:
+        if (sd_busy_left < 0 || sd_busy_left-- > 0) return 0x00;
+        sd_wr = sd_wr_multi ? WR_TOKEN : WR_NONE;
+        return 0xFF;
+
+    default:
+        return 0xFF;
+    }
+}
+
+/**
+ * @brief Ответ отдан целиком: при CMD18 следом идёт следующий блок
+ */
+static void sd_out_drained(void) {
+    sd_out_len = sd_out_pos = 0;
+    if (sd_out_data) host_sd.blocks_read++;
+    sd_out_data = 0;
+    if (sd_rd_multi && sd_rd_sector < sd_sectors) {
+        sd_put_block(host_sd_sector(sd_rd_sector++), 512);
+        sd_out_data = 1;
+    }
+}
+
+/**
+ * @brief Приём команды: 0x40 | cmd, 4 байта аргумента, CRC
+ */
+static void sd_command_byte(uint8_t data) {
+    if (sd_cmd_len == 0 && (data & 0xC0) != 0x40) return;
+    sd_cmd[sd_cmd_len++] = data;
+    if (sd_cmd_len == sizeof(sd_cmd)) {
+        sd_cmd_len = 0;
+        sd_command();
+    }
+}
+
+uint8_t host_sd_xfer(uint8_t data) {
+    if (!sd_cs || !sd_mem) return 0xFF;
+
+    // Ответ ещё не отдан; команду (например, CMD12) карта слушает и сейчас
+    if (sd_out_pos < sd_out_len) {
+        uint8_t r = sd_out[sd_out_pos++];
+        if (sd_out_pos == sd_out_len) sd_out_drained();
+        if (sd_wr == WR_NONE) sd_command_byte(data);
+        return r;
+    }
+
+    if (sd_wr != WR_NONE) return sd_write_byte(data);
+    sd_command_byte(data);
+    return 0xFF;
+}
@@ -0,0 +1,63 @@
+#ifndef HOST_STM32F1XX_H
+#define HOST_STM32F1XX_H
+
+/**
+ * @file stm32f1xx.h
+ * @brief stm32f1xx.h для сборки прошивки на ПК (tools/test)
+ *
+ * Типы и биты регистров берутся из настоящего CMSIS, а периферия вместо
+ * адресов 0x4000xxxx — переменные в памяти ПК. Их обслуживает модель
+ * платы (board.c): DMA, SPI-устройства, NVIC, SysTick. Функции NVIC_* подменяются
+ * штатным для CMSIS способом — через cmsis_nvic_virtual.h.
+ */
+
+#include_next "stm32f1xx.h"
+
+// -----------------------------------------------------------------------------
+// Периферия модели
+// -----------------------------------------------------------------------------
+
+extern SPI_TypeDef          host_spi1;
+extern SPI_TypeDef          host_spi2;
+extern DMA_TypeDef          host_dma1;
+extern DMA_Channel_TypeDef  host_dma1_channel[8];   // [1..7], как каналы DMA1
+extern RCC_TypeDef          host_rcc;
+extern SysTick_Type         host_systick;
+
+#undef SPI1
+#undef SPI2
+#undef DMA1
+#undef DMA1_Channel1
+#undef DMA1_Channel2
+#undef DMA1_Channel3
+#undef DMA1_Channel4
+#undef DMA1_Channel5
+#undef DMA1_Channel6
+#undef DMA1_Channel7
+#undef RCC
+#undef SysTick
+
+#define SPI1            (&host_spi1)
+#define SPI2            (&host_spi2)
+#define DMA1            (&host_dma1)
+#define DMA1_Channel1   (&host_dma1_channel[1])
+#define DMA1_Channel2   (&host_dma1_channel[2])
+#define DMA1_Channel3   (&host_dma1_channel[3])
+#define DMA1_Channel4   (&host_dma1_channel[4])
+#define DMA1_Channel5   (&host_dma1_channel[5])
+#define DMA1_Channel6   (&host_dma1_channel[6])
+#define DMA1_Channel7   (&host_dma1_channel[7])
+#define RCC             (&host_rcc)
+#define SysTick         (&host_systick)
+
+// -----------------------------------------------------------------------------
+// BASEPRI: у CMSIS это MRS/MSR, здесь — регистр модели
+// -----------------------------------------------------------------------------
+
+uint32_t host_get_basepri(void);
+void     host_set_basepri(uint32_t value);
+
+#define __get_BASEPRI   host_get_basepri
+#define __set_BASEPRI   host_set_basepri
+
+#endif /* HOST_STM32F1XX_H */
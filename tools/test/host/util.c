@@ -0,0 +1,25 @@
+/**
+ * @file util.c
+ * @brief Подготовка файлов на модельной карте через FatFS прошивки
+ */
+
+#include "host.h"
+#include "file_work.h"
+
+int host_fs_format(uint8_t gen, uint32_t sectors) {
+    host_sd_insert(gen, sectors);
+    return filesystem_init();
+}
+
+int host_fs_write(const char *name, const void *data, uint32_t len) {
+    FIL file;
+    UINT written = 0;
+
+    FRESULT res = f_open(&file, name, FA_WRITE | FA_CREATE_ALWAYS);
+    if (res != FR_OK) return res;
+
+    res = f_write(&file, data, len, &written);
+    FRESULT close = f_close(&file);
+    if (res == FR_OK && written != len) res = FR_DENIED;
+    return (res != FR_OK) ? res : close;
+}
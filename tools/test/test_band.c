@@ -0,0 +1,101 @@
+/**
+ * @file test_band.c
+ * @brief Полосовой рендер: составная картинка против эталона
+ *
+ * Прямоугольники, прозрачный текст и картинка, в том числе за краями
+ * окна, собираются band_* и сравниваются с эталоном, посчитанным тут же
+ * по точке, и с golden/band.ppm. DMA начинает работу с задержкой: если
+ * процессор рисует в буфер, который ещё передаётся, картинка разойдётся.
+ */
+
+#include "host.h"
+#include "band.h"
+
+#define WIN_X   24
+#define WIN_Y   40
+#define WIN_W   128
+#define WIN_H   80
+
+static uint16_t ref[WIN_H][WIN_W];
+static uint16_t bitmap[32 * 48];
+
+static void ref_pixel(int32_t x, int32_t y, uint16_t color) {
+    x -= WIN_X;
+    y -= WIN_Y;
+    if (x >= 0 && y >= 0 && x < WIN_W && y < WIN_H) ref[y][x] = color;
+}
+
+static void ref_rect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+    for (int32_t j = 0; j < h; j++) {
+        for (int32_t i = 0; i < w; i++) ref_pixel(x + i, y + j, color);
+    }
+}
+
+static void ref_text(int32_t x, int32_t y, const char *s, uint16_t color) {
+    for (; *s; s++, x += 8) {
+        for (int32_t col = 0; col < 8; col++) {
+            uint16_t bits = Font8x16[(unsigned char)*s][col];
+            for (int32_t row = 0; row < 16; row++) {
+                if (bits & (1u << (15 - row))) ref_pixel(x + col, y + row, color);
+            }
+        }
+    }
+}
+
+static void ref_bitmap(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *px) {
+    for (int32_t j = 0; j < h; j++) {
+        for (int32_t i = 0; i < w; i++) ref_pixel(x + i, y + j, px[j * w + i]);
+    }
+}
+
+static void test(void) {
+    const uint16_t bg = host_rgb565(0x10, 0x20, 0x60);
+    const uint16_t sentinel = host_rgb565(0xFF, 0x00, 0xFF);
+
+    ILI9225_init();
+    host_lcd_fill(sentinel);
+
+    for (uint16_t y = 0; y < 32; y++) {
+        for (uint16_t x = 0; x < 48; x++) bitmap[y * 48 + x] = host_rgb565(x * 5, y * 8, 0x80);
+    }
+
+    static const char title[] = "Band 005";
+    static const char edge[] = "XYZ";
+    host_dma_latency(3);
+    host_lcd_clear_stats();
+
+    band_begin(WIN_X, WIN_Y, WIN_W, WIN_H, bg);
+    band_fillRect(0, 30, 60, 200, COLOR_RED);               // выходит за окно слева и снизу
+    band_fillRect(100, 50, 40, 30, COLOR_GREEN);
+    band_drawBitmap(60, 70, 48, 32, bitmap);
+    band_drawString8x16(30, 44, title, COLOR_WHITE);       // поверх красного и фона
+    band_drawString8x16(140, 100, edge, COLOR_YELLOW);      // обрезается справа
+    band_fillRect(70, 90, 20, 20, COLOR_BLUE);              // поверх картинки
+    band_end();
+    ILI9225_DMA_wait();
+
+    for (uint16_t y = 0; y < WIN_H; y++) {
+        for (uint16_t x = 0; x < WIN_W; x++) ref[y][x] = bg;
+    }
+    ref_rect(0, 30, 60, 200, COLOR_RED);
+    ref_rect(100, 50, 40, 30, COLOR_GREEN);
+    ref_bitmap(60, 70, 48, 32, bitmap);
+    ref_text(30, 44, title, COLOR_WHITE);
+    ref_text(140, 100, edge, COLOR_YELLOW);
+    ref_rect(70, 90, 20, 20, COLOR_BLUE);
+
+    // Одно окно, каждый пиксель ровно один раз, вокруг окна ничего
+    CHECK_EQ(host_lcd.pixels, WIN_W * WIN_H);
+    CHECK_EQ(host_lcd.outside, 0);
+    CHECK(host_lcd_window_writes() <= 4);
+    CHECK_EQ(host_lcd_pixel(WIN_X - 1, WIN_Y), sentinel);
+    CHECK_EQ(host_lcd_pixel(WIN_X + WIN_W, WIN_Y + WIN_H - 1), sentinel);
+    CHECK_EQ(host_lcd_pixel(WIN_X, WIN_Y + WIN_H), sentinel);
+
+    CHECK_EQ(host_lcd_expect(&ref[0][0], WIN_X, WIN_Y, WIN_W, WIN_H, "band"), 0);
+    CHECK_EQ(host_lcd_golden("band", WIN_X, WIN_Y, WIN_W, WIN_H), 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
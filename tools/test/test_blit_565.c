@@ -0,0 +1,157 @@
+/**
+ * @file test_blit_565.c
+ * @brief Картинки .565: tools/bmp2565 на ПК -> карта -> file_blit_565()
+ *
+ * BMP собирается в тесте, конвертер запускается как в жизни (путь к нему
+ * приходит из CMake), результат кладётся на модельную карту через FatFS
+ * прошивки. GRAM сверяется с пикселями исходного BMP: так проверяется и
+ * порядок пикселей в .565, и то, что сектор уходит на дисплей как есть.
+ */
+
+#include "host.h"
+#include "file_work.h"
+#include "img565.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef BMP2565
+#error "BMP2565: путь к конвертеру задаёт tools/test/CMakeLists.txt"
+#endif
+
+#define MAX_W   64
+#define MAX_H   48
+
+static uint8_t bmp[54 + MAX_W * MAX_H * 4];
+static uint8_t img[IMG565_SECTOR + MAX_W * MAX_H * 2];
+static uint16_t ref[MAX_H][MAX_W];
+
+static void put16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static void put32(uint8_t *p, uint32_t v) { put16(p, v); put16(p + 2, v >> 16); }
+
+/**
+ * @brief BMP w x h с глубиной bpp в файл path и эталон RGB565
+ */
+static void make_bmp(const char *path, uint16_t w, uint16_t h, uint16_t bpp, uint8_t top_down) {
+    uint32_t bytes_pp = bpp / 8;
+    uint32_t stride = (w * bytes_pp + 3) & ~3u;
+    uint32_t size = 54 + stride * h;
+    memset(bmp, 0, size);
+    bmp[0] = 'B';
+    bmp[1] = 'M';
+    put32(bmp + 2, size);
+    put32(bmp + 10, 54);
+    put32(bmp + 14, 40);
+    put32(bmp + 18, w);
+    put32(bmp + 22, top_down ? (uint32_t)-h : h);
+    put16(bmp + 26, 1);
+    put16(bmp + 28, bpp);
+
+    for (uint16_t y = 0; y < h; y++) {
+        uint8_t *row = bmp + 54 + (uint32_t)(top_down ? y : h - 1 - y) * stride;
+        for (uint16_t x = 0; x < w; x++) {
+            uint8_t r = (uint8_t)(x * 4), g = (uint8_t)(y * 5), b = (uint8_t)((x ^ y) * 8);
+            row[x * bytes_pp + 0] = b;
+            row[x * bytes_pp + 1] = g;
+            row[x * bytes_pp + 2] = r;
+            ref[y][x] = host_rgb565(r, g, b);
+        }
+    }
+
+    FILE *f = fopen(path, "wb");
+    CHECK(f != NULL);
+    if (!f) return;
+    fwrite(bmp, 1, size, f);
+    fclose(f);
+}
+
+/**
+ * @brief Запуск конвертера и перенос результата на карту под именем name
+ * @return код выхода bmp2565
+ */
+static int convert(const char *args, const char *name) {
+    char cmd[256];
+    snprintf(cmd, sizeof(cmd), "%s %s t565.bmp t565.565", BMP2565, args);
+    int rc = system(cmd);
+    if (rc != 0) return rc;
+
+    FILE *f = fopen("t565.565", "rb");
+    CHECK(f != NULL);
+    if (!f) return -1;
+    size_t n = fread(img, 1, sizeof(img), f);
+    fclose(f);
+    CHECK_EQ(host_fs_write(name, img, (uint32_t)n), FR_OK);
+    return 0;
+}
+
+/**
+ * @brief Эталон в формате host_lcd_expect: строки w x h подряд
+ */
+static const uint16_t *packed_ref(uint16_t w, uint16_t h) {
+    static uint16_t out[MAX_W * MAX_H];
+    for (uint16_t y = 0; y < h; y++) memcpy(out + y * w, ref[y], w * 2);
+    return out;
+}
+
+static void test(void) {
+    ILI9225_init();
+    CHECK_EQ(host_fs_format(HOST_SD_V2HC, 65536), FR_OK);
+
+    // 24 бита снизу вверх, строки с выравниванием: заголовок и пиксели подряд
+    make_bmp("t565.bmp", 50, 37, 24, 0);
+    CHECK_EQ(convert("", "PLAIN.565"), 0);
+    img565_header_t hdr = {0};
+    CHECK(img565_parse(img, &hdr));
+    CHECK_EQ(hdr.width, 50);
+    CHECK_EQ(hdr.height, 37);
+    CHECK_EQ(hdr.data_offset, IMG565_HEADER_SIZE);
+    CHECK_EQ(hdr.orientation, IMG565_ANY_ORIENTATION);
+
+    host_lcd_fill(COLOR_BLACK);
+    host_lcd_clear_stats();
+    CHECK_EQ(file_blit_565("PLAIN.565", 13, 40), FR_OK);
+    CHECK_EQ(host_lcd.pixels, 50 * 37);
+    CHECK_EQ(host_lcd.outside, 0);
+    CHECK_EQ(host_lcd_expect(packed_ref(50, 37), 13, 40, 50, 37, "blit_plain"), 0);
+
+    // -a: пиксели с границы сектора, каждый сектор данных читается один раз
+    CHECK_EQ(convert("-a", "ALIGNED.565"), 0);
+    CHECK(img565_parse(img, &hdr));
+    CHECK_EQ(hdr.data_offset, IMG565_SECTOR);
+    CHECK(hdr.flags & IMG565_FLAG_ALIGNED);
+    host_lcd_fill(COLOR_BLACK);
+    host_lcd_clear_stats();
+    host_sd_clear_stats();
+    CHECK_EQ(file_blit_565("ALIGNED.565", 0, 0), FR_OK);
+    CHECK_EQ(host_lcd.pixels, 50 * 37);
+    CHECK_EQ(host_lcd_expect(packed_ref(50, 37), 0, 0, 50, 37, "blit_aligned"), 0);
+    uint32_t data_sectors = (50 * 37 * 2 + 511) / 512;
+    CHECK(host_sd.blocks_read >= data_sectors);
+    CHECK(host_sd.blocks_read <= data_sectors + 4);
+
+    // 32 бита сверху вниз, привязка к ориентации
+    make_bmp("t565.bmp", 20, 10, 32, 1);
+    CHECK_EQ(convert("-a -o 0", "O0.565"), 0);
+    CHECK_EQ(convert("-o 1", "O1.565"), 0);
+    host_lcd_clear_stats();
+    CHECK_EQ(file_blit_565("O0.565", 150, 200), FR_OK);
+    CHECK_EQ(host_lcd_expect(packed_ref(20, 10), 150, 200, 20, 10, "blit_o0"), 0);
+    CHECK_EQ(file_blit_565("O1.565", 0, 0), FR_INVALID_OBJECT);
+    CHECK_EQ(host_lcd.pixels, 20 * 10);
+
+    // Не влезает в экран, не .565, нет файла: на экран ничего
+    host_lcd_clear_stats();
+    CHECK_EQ(file_blit_565("O0.565", 160, 0), FR_INVALID_PARAMETER);
+    CHECK_EQ(host_fs_write("NOT565.BMP", bmp, 54), FR_OK);
+    CHECK_EQ(file_blit_565("NOT565.BMP", 0, 0), FR_INVALID_OBJECT);
+    CHECK(file_blit_565("NONE.565", 0, 0) != FR_OK);
+    CHECK_EQ(host_lcd.pixels, 0);
+
+    // Конвертер не берёт то, что не умеет
+    make_bmp("t565.bmp", 8, 8, 16, 0);
+    CHECK(convert("", "BPP16.565") != 0);
+    CHECK(convert("-o 4", "BAD.565") != 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
@@ -0,0 +1,168 @@
+/**
+ * @file test_bmp.c
+ * @brief Потоковый вывод BMP: форматы, порядок строк, выравнивание, отсечение
+ *
+ * Файлы 24, 16 (565 и 555, BI_RGB и BI_BITFIELDS) и 8 бит с палитрой
+ * собираются в тесте, ширина нечётная — строки с добивкой до 4 байт.
+ * Эталон рисуется по точке из исходных цветов с отсечением по экрану;
+ * верхняя часть экрана сверяется ещё и с golden/bmp.ppm.
+ */
+
+#include "host.h"
+#include "file_work.h"
+#include "bmp.h"
+#include <string.h>
+
+#define W       37
+#define H       23
+
+#define BI_RGB          0
+#define BI_BITFIELDS    3
+
+static uint8_t file[14 + 40 + 12 + 256 * 4 + H * (W * 3 + 3)];
+static uint16_t src[H][W];
+static uint16_t ref[LCD_HEIGHT][LCD_WIDTH];
+
+static void put16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static void put32(uint8_t *p, uint32_t v) { put16(p, v); put16(p + 2, v >> 16); }
+
+static void color(uint16_t x, uint16_t y, uint8_t seed, uint8_t *r, uint8_t *g, uint8_t *b) {
+    *r = (uint8_t)(x * 7 + seed);
+    *g = (uint8_t)(y * 11 + x);
+    *b = (uint8_t)((x ^ y) * 5 + seed * 3);
+}
+
+/**
+ * @brief BMP W x H; src — что должно оказаться на экране
+ * @param bpp 24, 16 или 8
+ * @param mask565 для 16 бит: 1 — BI_BITFIELDS 565, 0 — 555
+ * @param bitfields для 555: маски явно (BI_BITFIELDS) или BI_RGB
+ * @return длина файла
+ */
+static uint32_t make_bmp(uint16_t bpp, uint8_t mask565, uint8_t bitfields, uint8_t top_down, uint8_t seed) {
+    uint16_t colors = (bpp == 8) ? 16 : 0;
+    uint32_t masks = bitfields ? 12 : 0;
+    uint32_t offset = 14 + 40 + masks + colors * 4;
+    uint32_t stride = ((W * bpp + 31) / 32) * 4;
+    uint32_t size = offset + stride * H;
+
+    memset(file, 0xEE, sizeof(file));      // добивка строк — мусор
+    memset(file, 0, offset);
+    file[0] = 'B';
+    file[1] = 'M';
+    put32(file + 2, size);
+    put32(file + 10, offset);
+    put32(file + 14, 40);
+    put32(file + 18, W);
+    put32(file + 22, top_down ? (uint32_t)-H : H);
+    put16(file + 26, 1);
+    put16(file + 28, bpp);
+    put32(file + 30, bitfields ? BI_BITFIELDS : BI_RGB);
+    put32(file + 46, colors);
+    if (bitfields) {
+        put32(file + 54, mask565 ? 0xF800 : 0x7C00);
+        put32(file + 58, mask565 ? 0x07E0 : 0x03E0);
+        put32(file + 62, 0x001F);
+    }
+
+    uint8_t r, g, b;
+    for (uint16_t i = 0; i < colors; i++) {
+        color(i * 3, i * 2, seed, &r, &g, &b);
+        file[54 + i * 4 + 0] = b;
+        file[54 + i * 4 + 1] = g;
+        file[54 + i * 4 + 2] = r;
+        file[54 + i * 4 + 3] = 0;
+    }
+
+    for (uint16_t y = 0; y < H; y++) {
+        uint8_t *row = file + offset + (uint32_t)(top_down ? y : H - 1 - y) * stride;
+        for (uint16_t x = 0; x < W; x++) {
+            if (bpp == 8) {
+                uint8_t i = (uint8_t)((x + 2 * y) % colors);
+                row[x] = i;
+                color(i * 3, i * 2, seed, &r, &g, &b);
+                src[y][x] = host_rgb565(r, g, b);
+                continue;
+            }
+            color(x, y, seed, &r, &g, &b);
+            if (bpp == 24) {
+                row[x * 3 + 0] = b;
+                row[x * 3 + 1] = g;
+                row[x * 3 + 2] = r;
+                src[y][x] = host_rgb565(r, g, b);
+            } else if (mask565) {
+                put16(row + x * 2, host_rgb565(r, g, b));
+                src[y][x] = host_rgb565(r, g, b);
+            } else {
+                uint16_t r5 = r >> 3, g5 = g >> 3, b5 = b >> 3;
+                put16(row + x * 2, (uint16_t)(r5 << 10 | g5 << 5 | b5));
+                src[y][x] = (uint16_t)(r5 << 11 | ((g5 << 1) | (g5 >> 4)) << 5 | b5);
+            }
+        }
+    }
+    return size;
+}
+
+/**
+ * @brief Файл на карту, вывод в (x, y) и эталон; пикселей ровно видимая часть
+ */
+static void draw(const char *name, uint32_t len, int16_t x, int16_t y) {
+    uint32_t visible = 0;
+    for (int32_t j = 0; j < H; j++) {
+        for (int32_t i = 0; i < W; i++) {
+            if (x + i < 0 || y + j < 0 || x + i >= LCD_WIDTH || y + j >= LCD_HEIGHT) continue;
+            ref[y + j][x + i] = src[j][i];
+            visible++;
+        }
+    }
+
+    CHECK_EQ(host_fs_write(name, file, len), FR_OK);
+    host_lcd_clear_stats();
+    CHECK_EQ(bmp_draw(name, x, y), FR_OK);
+    CHECK_EQ(host_lcd.pixels, visible);
+    CHECK_EQ(host_lcd.outside, 0);
+}
+
+static void test(void) {
+    ILI9225_init();
+    uint16_t entry = host_lcd_reg(ENTRY_MODE);
+    CHECK_EQ(host_fs_format(HOST_SD_V2HC, 65536), FR_OK);
+
+    draw("RGB24UP.BMP",  make_bmp(24, 0, 0, 0, 1),  5,  5);
+    draw("RGB24DN.BMP",  make_bmp(24, 0, 0, 1, 2), 50,  5);
+    draw("RGB565.BMP",   make_bmp(16, 1, 1, 0, 3), 95,  5);
+    draw("RGB565DN.BMP", make_bmp(16, 1, 1, 1, 4), 135, 5);
+    draw("RGB555.BMP",   make_bmp(16, 0, 0, 1, 5),  5, 40);
+    draw("RGB555BF.BMP", make_bmp(16, 0, 1, 0, 6), 50, 40);
+    draw("PAL8UP.BMP",   make_bmp(8, 0, 0, 0, 7),  95, 40);
+    draw("PAL8DN.BMP",   make_bmp(8, 0, 0, 1, 8), 135, 40);
+    CHECK_EQ(host_lcd_reg(ENTRY_MODE), entry);
+
+    // Отсечение со всех сторон, для обоих порядков строк
+    draw("CLIPLB.BMP", make_bmp(8, 0, 0, 1, 9), -10, LCD_HEIGHT - 12);
+    draw("CLIPRT.BMP", make_bmp(24, 0, 0, 0, 10), LCD_WIDTH - 20, -7);
+    draw("CLIPRB.BMP", make_bmp(16, 1, 1, 0, 11), LCD_WIDTH - 9, LCD_HEIGHT - 5);
+    draw("CLIPLT.BMP", make_bmp(16, 0, 0, 1, 12), -30, -20);
+    draw("OFF.BMP", make_bmp(24, 0, 0, 0, 13), LCD_WIDTH + 5, 0);
+    draw("OFF2.BMP", make_bmp(24, 0, 0, 1, 14), 0, -H);
+    CHECK_EQ(host_lcd_reg(ENTRY_MODE), entry);
+
+    CHECK_EQ(host_lcd_expect(&ref[0][0], 0, 0, LCD_WIDTH, LCD_HEIGHT, "bmp"), 0);
+    CHECK_EQ(host_lcd_golden("bmp", 0, 0, LCD_WIDTH, 70), 0);
+
+    // Неподдерживаемые: 32 бита и чужие маски 16 бит
+    uint32_t len = make_bmp(24, 0, 0, 0, 15);
+    put16(file + 28, 32);
+    CHECK_EQ(host_fs_write("RGB32.BMP", file, len), FR_OK);
+    len = make_bmp(16, 1, 1, 0, 16);
+    put32(file + 54, 0x0F00);
+    CHECK_EQ(host_fs_write("MASK.BMP", file, len), FR_OK);
+    host_lcd_clear_stats();
+    CHECK_EQ(bmp_draw("RGB32.BMP", 0, 0), FR_INVALID_OBJECT);
+    CHECK_EQ(bmp_draw("MASK.BMP", 0, 0), FR_INVALID_OBJECT);
+    CHECK_EQ(host_lcd.pixels, 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
@@ -0,0 +1,188 @@
+/**
+ * @file test_bmp_scale.c
+ * @brief Уменьшение BMP на лету: ближайший сосед и усреднение блоков
+ *
+ * Эталон считается в тесте по тем же правилам, что и у движка: целый
+ * коэффициент k для усреднения по блоку k x k в RGB565, шаг 16.16 с
+ * выборкой из центра шага для ближайшего соседа, картинка по центру
+ * прямоугольника. Для ближайшего соседа считаются и блоки с карты:
+ * пропущенные строки читаться не должны.
+ */
+
+#include "host.h"
+#include "file_work.h"
+#include "bmp.h"
+#include <string.h>
+
+#define SRC_W   198         // строка 594 байта + 2 байта выравнивания
+#define SRC_H   160
+#define HDR     54
+#define STRIDE  ((SRC_W * 3 + 3) & ~3u)
+
+#define WIDE_W  6000        // выборки при уменьшении до 10 точек — через 1800 байт
+#define WIDE_H  2
+
+static uint8_t file[HDR + STRIDE * SRC_H];     // больше, чем WIDE_W x WIDE_H
+static uint16_t src[SRC_H][SRC_W];
+static uint16_t ref[SRC_H * SRC_W];
+
+static void put16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static void put32(uint8_t *p, uint32_t v) { put16(p, v); put16(p + 2, v >> 16); }
+
+/**
+ * @brief BMP 24 бита w x h; пиксели SRC_W x SRC_H заодно в src в RGB565
+ */
+static uint32_t make_bmp(uint16_t w, uint16_t h, uint8_t top_down) {
+    uint32_t stride = (w * 3u + 3) & ~3u;
+    uint32_t size = HDR + stride * h;
+    memset(file, 0, size);
+    file[0] = 'B';
+    file[1] = 'M';
+    put32(file + 2, size);
+    put32(file + 10, HDR);
+    put32(file + 14, 40);
+    put32(file + 18, w);
+    put32(file + 22, top_down ? (uint32_t)-h : h);
+    put16(file + 26, 1);
+    put16(file + 28, 24);
+
+    for (uint16_t y = 0; y < h; y++) {
+        uint8_t *row = file + HDR + (uint32_t)(top_down ? y : h - 1 - y) * stride;
+        for (uint16_t x = 0; x < w; x++) {
+            uint8_t r = (uint8_t)(x * 13 + y), g = (uint8_t)(y * 7 - x), b = (uint8_t)((x ^ y) * 3);
+            row[x * 3 + 0] = b;
+            row[x * 3 + 1] = g;
+            row[x * 3 + 2] = r;
+            if (x < SRC_W && y < SRC_H) src[y][x] = host_rgb565(r, g, b);
+        }
+    }
+    return size;
+}
+
+/**
+ * @brief Эталон усреднения: наименьший k, при котором картинка влезает в w x h
+ */
+static void ref_box(uint16_t w, uint16_t h, uint16_t *out_w, uint16_t *out_h) {
+    uint32_t k = 1;
+    while (SRC_W > w * k || SRC_H > h * k) k++;
+    *out_w = (uint16_t)(SRC_W / k);
+    *out_h = (uint16_t)(SRC_H / k);
+
+    for (uint32_t oy = 0; oy < *out_h; oy++) {
+        for (uint32_t ox = 0; ox < *out_w; ox++) {
+            uint32_t r = 0, g = 0, b = 0;
+            for (uint32_t j = 0; j < k; j++) {
+                for (uint32_t i = 0; i < k; i++) {
+                    uint16_t c = src[oy * k + j][ox * k + i];
+                    r += c >> 11;
+                    g += (c >> 5) & 0x3F;
+                    b += c & 0x1F;
+                }
+            }
+            ref[oy * *out_w + ox] = (uint16_t)(((r / (k * k)) << 11) | ((g / (k * k)) << 5) | (b / (k * k)));
+        }
+    }
+}
+
+static uint32_t scale_src(uint32_t out, uint32_t step) {
+    return (uint32_t)(((uint64_t)(2 * out + 1) * step) >> 17);
+}
+
+/**
+ * @brief Эталон ближайшего соседа: общий шаг 16.16 по большей стороне
+ */
+static void ref_nearest(uint16_t w, uint16_t h, uint16_t *out_w, uint16_t *out_h) {
+    uint32_t sw = (uint32_t)(((uint64_t)SRC_W << 16) / w);
+    uint32_t sh = (uint32_t)(((uint64_t)SRC_H << 16) / h);
+    uint32_t step = (sw > sh) ? sw : sh;
+    if (step < 0x10000) step = 0x10000;
+    *out_w = (uint16_t)(((uint64_t)SRC_W << 16) / step);
+    *out_h = (uint16_t)(((uint64_t)SRC_H << 16) / step);
+
+    for (uint32_t oy = 0; oy < *out_h; oy++) {
+        uint32_t sy = scale_src(oy, step);
+        for (uint32_t ox = 0; ox < *out_w; ox++) ref[oy * *out_w + ox] = src[sy][scale_src(ox, step)];
+    }
+}
+
+/**
+ * @brief Вывод в прямоугольник и сверка по центру прямоугольника
+ */
+static void check(const char *name, uint8_t mode, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    uint16_t out_w, out_h;
+    if (mode == BMP_SCALE_BOX) ref_box(w, h, &out_w, &out_h);
+    else ref_nearest(w, h, &out_w, &out_h);
+    uint16_t x0 = x + (w - out_w) / 2;
+    uint16_t y0 = y + (h - out_h) / 2;
+
+    host_lcd_fill(COLOR_BLACK);
+    host_lcd_clear_stats();
+    CHECK_EQ(bmp_draw_scaled(name, x, y, w, h, mode), FR_OK);
+    CHECK_EQ(host_lcd.pixels, (uint32_t)out_w * out_h);
+    CHECK_EQ(host_lcd.outside, 0);
+    CHECK_EQ(host_lcd_expect(ref, x0, y0, out_w, out_h, mode == BMP_SCALE_BOX ? "scale_box" : "scale_nearest"), 0);
+}
+
+static void test(void) {
+    ILI9225_init();
+    uint16_t entry = host_lcd_reg(ENTRY_MODE);
+    CHECK_EQ(host_fs_format(HOST_SD_V2HC, 65536), FR_OK);
+
+    CHECK_EQ(host_fs_write("WIDE.BMP", file, make_bmp(WIDE_W, WIDE_H, 0)), FR_OK);
+    uint32_t size = make_bmp(SRC_W, SRC_H, 0);
+    CHECK_EQ(host_fs_write("UP.BMP", file, size), FR_OK);
+    make_bmp(SRC_W, SRC_H, 1);
+    CHECK_EQ(host_fs_write("DOWN.BMP", file, size), FR_OK);
+
+    // Усреднение 4 x 4 (198 -> 49 по центру 50) и 2 x 2, оба порядка строк
+    check("UP.BMP", BMP_SCALE_BOX, 10, 20, 50, 40);
+    check("DOWN.BMP", BMP_SCALE_BOX, 10, 20, 50, 40);
+    check("DOWN.BMP", BMP_SCALE_BOX, 0, 0, 100, 100);
+
+    // Ближайший сосед с дробным шагом
+    check("UP.BMP", BMP_SCALE_NEAREST, 5, 7, 60, 60);
+    check("DOWN.BMP", BMP_SCALE_NEAREST, 40, 100, 130, 90);
+    CHECK_EQ(host_lcd_reg(ENTRY_MODE), entry);
+
+    // Сильное уменьшение: только нужные строки и куски строк. Каждая
+    // выбранная строка — не больше трёх секторов, файл — 187 секторов
+    uint16_t out_w, out_h;
+    ref_nearest(20, 16, &out_w, &out_h);
+    host_sd_clear_stats();
+    check("UP.BMP", BMP_SCALE_NEAREST, 0, 0, 20, 16);
+    uint32_t file_sectors = (size + 511) / 512;
+    printf("nearest %ux%u: %u of %u sectors\n", out_w, out_h,
+           (unsigned)host_sd.blocks_read, (unsigned)file_sectors);
+    CHECK(host_sd.blocks_read <= out_h * 3u + 4);
+    CHECK(host_sd.blocks_read * 3 < file_sectors);
+
+    // Усреднение читает всё
+    host_sd_clear_stats();
+    check("UP.BMP", BMP_SCALE_BOX, 0, 0, 20, 16);
+    CHECK(host_sd.blocks_read >= file_sectors - 1);
+
+    // Выборки дальше сектора друг от друга: промежутки перескакиваются,
+    // на каждую точку — один сектор, а не кусок строки в 220 точек
+    host_lcd_clear_stats();
+    host_sd_clear_stats();
+    CHECK_EQ(bmp_draw_scaled("WIDE.BMP", 0, 0, 10, 10, BMP_SCALE_NEAREST), FR_OK);
+    CHECK_EQ(host_lcd.pixels, 10);
+    uint32_t step = (uint32_t)(((uint64_t)WIDE_W << 16) / 10);
+    for (uint16_t ox = 0; ox < 10; ox++) {
+        uint32_t sx = scale_src(ox, step), sy = WIDE_H - 1;   // центр шага за краем
+        uint16_t want = host_rgb565((uint8_t)(sx * 13 + sy), (uint8_t)(sy * 7 - sx), (uint8_t)((sx ^ sy) * 3));
+        CHECK_EQ(host_lcd_pixel(ox, 4), want);
+    }
+    printf("nearest 10 of %u px: %u sectors\n", WIDE_W, (unsigned)host_sd.blocks_read);
+    CHECK(host_sd.blocks_read <= 10 + 4);
+
+    // Пустой прямоугольник и прямоугольник за экраном
+    host_lcd_clear_stats();
+    CHECK_EQ(bmp_draw_scaled("UP.BMP", 0, 0, 0, 10, BMP_SCALE_BOX), FR_INVALID_PARAMETER);
+    CHECK_EQ(bmp_draw_scaled("UP.BMP", ILI9225_maxX, 0, 10, 10, BMP_SCALE_NEAREST), FR_INVALID_PARAMETER);
+    CHECK_EQ(host_lcd.pixels, 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
@@ -0,0 +1,54 @@
+/**
+ * @file test_card_info.c
+ * @brief Геометрия карты из OCR, CSD, CID и SD Status
+ *
+ * Ёмкость по CSD 1.0 (SD 1.x, SDSC) и CSD 2.0 (SDHC), признак CCS из OCR,
+ * блок стирания из AU_SIZE (ACMD13) — степень двойки не больше 16 МБ, —
+ * а без AU_SIZE из поля SECTOR_SIZE в CSD.
+ */
+
+#include "host.h"
+#include "SD_card.h"
+#include <string.h>
+
+static const SD_CardInfo *card(uint8_t gen, uint32_t sectors, int8_t au) {
+    host_sd_insert(gen, sectors);
+    host_sd_au_size(au);
+    CHECK_EQ(sd_init(), SD_OK);
+
+    const SD_CardInfo *info = sd_card_info();
+    printf("gen %u, %u sectors, AU_SIZE %d: OCR 0x%08X, erase block %u\n", gen, (unsigned)sectors, au,
+           (unsigned)info->ocr, (unsigned)info->erase_block);
+    CHECK_EQ(info->sectors, sectors);
+    CHECK_EQ((info->type & SD_TYPE_BLOCK) != 0, gen == HOST_SD_V2HC);
+    CHECK_EQ(info->csd[0] >> 6, gen == HOST_SD_V2HC);
+    CHECK_EQ(memcmp(info->cid, "HOST MODEL CID 1", 16), 0);
+    return info;
+}
+
+static void test(void) {
+    // Ёмкость: CSD 1.0 и 2.0, AU по ёмкости (до 64 МБ — 512 КБ, ... 4 МБ)
+    CHECK_EQ(card(HOST_SD_V1, 32768, -1)->erase_block, 1024);
+    CHECK_EQ(card(HOST_SD_V2SC, 32768, -1)->erase_block, 1024);
+    CHECK_EQ(card(HOST_SD_V2SC, 262144, -1)->erase_block, 2048);
+    CHECK_EQ(card(HOST_SD_V2SC, 2097152, -1)->erase_block, 8192);
+    CHECK_EQ(card(HOST_SD_V2HC, 65536, -1)->erase_block, 1024);
+    CHECK_EQ(card(HOST_SD_V2HC, 1048576, -1)->erase_block, 4096);
+    CHECK_EQ(card(HOST_SD_V2HC, 4194304, -1)->erase_block, 8192);
+
+    // AU_SIZE от 16 КБ до 64 МБ: 12 МБ выравнивается до 4 МБ, 64 МБ — до 16 МБ
+    CHECK_EQ(card(HOST_SD_V2HC, 65536, 0x1)->erase_block, 32);
+    CHECK_EQ(card(HOST_SD_V2HC, 65536, 0xA)->erase_block, 16384);
+    CHECK_EQ(card(HOST_SD_V2HC, 65536, 0xB)->erase_block, 8192);
+    CHECK_EQ(card(HOST_SD_V2HC, 65536, 0xD)->erase_block, 16384);
+    CHECK_EQ(card(HOST_SD_V2HC, 65536, 0xF)->erase_block, 32768);
+
+    // AU_SIZE нет: (SECTOR_SIZE + 1) блоков записи из CSD, 128 x 512 байт
+    CHECK_EQ(card(HOST_SD_V1, 32768, 0)->erase_block, 128);
+    CHECK_EQ(card(HOST_SD_V2SC, 32768, 0)->erase_block, 128);
+    CHECK_EQ(card(HOST_SD_V2HC, 65536, 0)->erase_block, 128);
+}
+
+int main(void) {
+    return host_run(test);
+}
@@ -0,0 +1,99 @@
+/**
+ * @file test_dir_scan.c
+ * @brief Обход каталога и чтение файлов с кэшем секторов и без него
+ *
+ * Один и тот же сценарий собирается дважды: с кэшем по умолчанию и с
+ * DISK_CACHE_SETS = 0 (test_dir_scan_nocache). 30 файлов по 40 КБ,
+ * три обхода корня (scan_files, list_files, scan_files) после холодного
+ * монтирования, затем 20 файлов читаются и сверяются. Походы на карту
+ * видны по счётчикам модели карты.
+ */
+
+#include "host.h"
+#include "diskcache.h"
+#include "file_work.h"
+#include <stdio.h>
+#include <string.h>
+
+#define FILES       30
+#define FILE_SIZE   (40 * 1024)
+#define READ_FILES  20
+
+static uint8_t data[FILE_SIZE];
+static uint8_t buf[4096];
+
+static void pattern(uint8_t *p, uint32_t len, uint8_t n) {
+    for (uint32_t i = 0; i < len; i++) p[i] = (uint8_t)(i * 7 + (i >> 9) + n * 53);
+}
+
+static void name(char *s, uint8_t n) {
+    snprintf(s, 13, "F%02u.BMP", n);
+}
+
+static void test(void) {
+    char fname[13];
+
+    CHECK_EQ(host_fs_format(HOST_SD_V2HC, 65536), FR_OK);
+    for (uint8_t n = 0; n < FILES; n++) {
+        name(fname, n);
+        pattern(data, FILE_SIZE, n);
+        CHECK_EQ(host_fs_write(fname, data, FILE_SIZE), FR_OK);
+    }
+
+    // Холодное монтирование: disk_initialize() сбрасывает кэш
+    CHECK_EQ(filesystem_init(), FR_OK);
+
+    // Три обхода корня
+    uint32_t walk[3];
+    for (uint8_t i = 0; i < 3; i++) {
+        host_sd_clear_stats();
+        if (i == 1) list_files(".*");
+        else scan_files(".BMP");
+        walk[i] = host_sd.blocks_read;
+        CHECK_EQ(file_count, MAX_FILES);
+    }
+    CHECK(strstr(host_uart_log(), "F29.BMP") != NULL);
+    printf("walks: %u %u %u sectors read\n", (unsigned)walk[0], (unsigned)walk[1], (unsigned)walk[2]);
+
+    CHECK(walk[0] >= 2);            // 30 записей — два сектора каталога
+#if DISK_CACHE_SETS
+    // Каталог целиком в кэше: повторные обходы на карту не ходят
+    CHECK_EQ(walk[1] + walk[2], 0);
+#else
+    CHECK(walk[1] >= walk[0] - 1);
+    CHECK(walk[2] >= walk[0] - 1);
+#endif
+
+    // Чтение файлов: поиск записи в каталоге и цепочка кластеров по FAT
+    disk_cache_stats_t st;
+    host_sd_clear_stats();
+    disk_cache_clear_stats();
+    for (uint8_t n = 0; n < READ_FILES; n++) {
+        FIL file;
+        UINT got;
+        name(fname, n);
+        pattern(data, FILE_SIZE, n);
+        CHECK_EQ(f_open(&file, fname, FA_READ), FR_OK);
+        for (uint32_t pos = 0; pos < FILE_SIZE; pos += sizeof(buf)) {
+            CHECK_EQ(f_read(&file, buf, sizeof(buf), &got), FR_OK);
+            CHECK_EQ(got, sizeof(buf));
+            CHECK(memcmp(buf, data + pos, sizeof(buf)) == 0);
+        }
+        f_close(&file);
+    }
+    // Одиночные чтения по запросу FatFS: упреждающие CMD17 не в счёт
+    disk_cache_get_stats(&st);
+    uint32_t single = host_sd.cmd[17] - st.pf_issued;
+    printf("files: %u sectors, %u single-sector reads, %u read ahead\n",
+           (unsigned)host_sd.blocks_read, (unsigned)single, (unsigned)st.pf_issued);
+    CHECK(host_sd.blocks_read >= READ_FILES * FILE_SIZE / 512);
+#if DISK_CACHE_SETS
+    CHECK(single <= 4);
+#else
+    CHECK(single >= READ_FILES * 2);
+#endif
+}
+
+int main(void) {
+    return host_run(test);
+}
@@ -0,0 +1,176 @@
+/**
+ * @file test_disk_cache.c
+ * @brief Кэш секторов под diskio: попадания, LRU в наборе, отложенная
+ * запись через очередь SD, многосекторные обращения и закреплённый
+ * диапазон (FAT)
+ *
+ * Обращения идут напрямую в disk_cache_*, сектора не подряд — без
+ * упреждающего чтения (его проверяет test_prefetch). Походы на карту
+ * видны по счётчикам модели карты.
+ */
+
+#include "host.h"
+#include "diskcache.h"
+#include "SD_card.h"
+#include <string.h>
+
+static uint8_t buf[3 * 512];
+
+static void pattern(uint8_t *p, uint32_t sector, uint8_t gen) {
+    for (uint32_t i = 0; i < 512; i++) p[i] = (uint8_t)(sector * 31 + i + gen * 101);
+}
+
+/**
+ * @brief Чтение одного сектора через кэш
+ * @return 1 если пришлось идти на карту
+ */
+static uint32_t rd(uint32_t sector) {
+    uint32_t before = host_sd.blocks_read;
+    CHECK_EQ(disk_cache_read(buf, sector, 1), RES_OK);
+    return host_sd.blocks_read - before;
+}
+
+static void wr(uint32_t sector, uint8_t gen) {
+    pattern(buf, sector, gen);
+    CHECK_EQ(disk_cache_write(buf, sector, 1), RES_OK);
+}
+
+static uint8_t card_has(uint32_t sector, uint8_t gen) {
+    uint8_t p[512];
+    pattern(p, sector, gen);
+    return memcmp(host_sd_sector(sector), p, 512) == 0;
+}
+
+static uint8_t buf_has(const uint8_t *b, uint32_t sector, uint8_t gen) {
+    uint8_t p[512];
+    pattern(p, sector, gen);
+    return memcmp(b, p, 512) == 0;
+}
+
+static void test(void) {
+    disk_cache_stats_t st;
+
+    CHECK_EQ(DISK_CACHE_SETS, 2);
+    CHECK_EQ(DISK_CACHE_WAYS, 2);
+    CHECK_EQ(DISK_CACHE_PINNED, 1);
+
+    host_sd_insert(HOST_SD_V2HC, 8192);
+    for (uint32_t s = 0; s < 300; s++) pattern(host_sd_sector(s), s, 0);
+    CHECK_EQ(disk_initialize(0), 0);
+    disk_cache_pin(0, 0);
+    disk_cache_clear_stats();
+    host_sd_clear_stats();
+
+    // Промах, затем попадание без карты
+    CHECK_EQ(rd(10), 1);
+    CHECK_EQ(rd(10), 0);
+    CHECK(buf_has(buf, 10, 0));
+
+    // Набор чётных секторов: две строки, вытесняется давняя
+    CHECK_EQ(rd(20), 1);
+    CHECK_EQ(rd(10), 0);            // 10 свежее 20
+    CHECK_EQ(rd(30), 1);            // вытесняет 20
+    CHECK_EQ(rd(10), 0);
+    CHECK_EQ(rd(20), 1);            // вытесняет 30
+    // Нечётные сектора в своём наборе и чётные не трогают
+    CHECK_EQ(rd(11), 1);
+    CHECK_EQ(rd(13), 1);
+    CHECK_EQ(rd(10), 0);
+    CHECK_EQ(rd(20), 0);
+    CHECK(buf_has(buf, 20, 0));
+
+    disk_cache_get_stats(&st);
+    CHECK_EQ(st.hits, 5);
+    CHECK_EQ(st.misses, 6);
+    CHECK_EQ(st.pf_issued, 0);
+
+    // Отложенная запись: карта не меняется до вытеснения
+    host_sd_clear_stats();
+    wr(40, 1);
+    CHECK_EQ(host_sd.blocks_written, 0);
+    CHECK(card_has(40, 0));
+    CHECK_EQ(rd(40), 0);
+    CHECK(buf_has(buf, 40, 1));
+    CHECK_EQ(rd(42), 1);
+    CHECK_EQ(rd(44), 1);            // вытесняет 40: она уходит на карту
+    CHECK_EQ(host_sd.blocks_written, 1);
+    CHECK(card_has(40, 1));
+
+    // disk_cache_flush() ставит грязные строки в очередь SD, дописывает
+    // их главный цикл (SD_QueuePoll); каждая пишется один раз
+    wr(43, 1);
+    wr(44, 1);
+    CHECK_EQ(disk_cache_flush(), RES_OK);
+    CHECK_EQ(host_sd.blocks_written, 1);
+    CHECK(SD_QueueBusy());
+    while (SD_QueuePoll()) {}
+    CHECK_EQ(host_sd.blocks_written, 3);
+    CHECK(card_has(43, 1) && card_has(44, 1));
+    CHECK_EQ(disk_cache_flush(), RES_OK);
+    CHECK(!SD_QueueBusy());
+    CHECK_EQ(host_sd.blocks_written, 3);
+    disk_cache_get_stats(&st);
+    CHECK_EQ(st.writebacks, 3);
+
+    // Обращение к кэшу до главного цикла сначала дописывает очередь
+    wr(43, 2);
+    CHECK_EQ(disk_cache_flush(), RES_OK);
+    CHECK(card_has(43, 1));
+    CHECK_EQ(rd(43), 0);
+    CHECK(buf_has(buf, 43, 2));
+    CHECK(card_has(43, 2));
+    CHECK(!SD_QueueBusy());
+    CHECK_EQ(host_sd.blocks_written, 4);
+    disk_cache_get_stats(&st);
+    CHECK_EQ(st.writebacks, 4);
+
+    // Многосекторное чтение мимо кэша, поверх — грязная строка
+    wr(51, 2);
+    CHECK(card_has(51, 0));
+    CHECK_EQ(disk_cache_read(buf, 50, 3), RES_OK);
+    CHECK(buf_has(buf, 50, 0));
+    CHECK(buf_has(buf + 512, 51, 2));
+    CHECK(buf_has(buf + 1024, 52, 0));
+
+    // Многосекторная запись обновляет копию в кэше
+    CHECK_EQ(rd(61), 1);
+    for (uint8_t i = 0; i < 3; i++) pattern(buf + i * 512, 60 + i, 3);
+    CHECK_EQ(disk_cache_write(buf, 60, 3), RES_OK);
+    CHECK(card_has(60, 3) && card_has(61, 3) && card_has(62, 3));
+    CHECK_EQ(rd(61), 0);
+    CHECK(buf_has(buf, 61, 3));
+    disk_cache_get_stats(&st);
+    CHECK_EQ(st.bypass, 2);
+    CHECK_EQ(disk_cache_flush(), RES_OK);
+
+    // Закреплённый сектор поток данных не вытесняет
+    disk_cache_pin(100, 4);
+    CHECK_EQ(rd(101), 1);
+    for (uint32_t s = 110; s < 130; s += 3) rd(s);
+    CHECK_EQ(rd(101), 0);
+
+    // Новый диапазон: грязная строка набора с его сектором уходит на карту,
+    // вторая копия сектора не остаётся
+    uint32_t written = host_sd.blocks_written;
+    wr(202, 4);
+    CHECK_EQ(host_sd.blocks_written, written);
+    disk_cache_pin(200, 8);
+    CHECK_EQ(host_sd.blocks_written, written + 1);
+    CHECK(card_has(202, 4));
+    CHECK_EQ(rd(202), 1);
+    wr(202, 5);
+    CHECK_EQ(rd(202), 0);
+    CHECK(buf_has(buf, 202, 5));
+    CHECK_EQ(rd(204), 1);           // вытесняет 202 из закреплённой строки
+    CHECK(card_has(202, 5));
+    CHECK_EQ(rd(202), 1);
+    CHECK(buf_has(buf, 202, 5));
+
+    disk_cache_pin(0, 0);
+    CHECK_EQ(disk_cache_flush(), RES_OK);
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
@@ -0,0 +1,103 @@
+/**
+ * @file test_font_cache.c
+ * @brief Кэш развернутых символов: попадания, промахи, вытеснение LRU
+ *
+ * Ключ кэша — символ и пара цветов. Картинка из кэша сверяется с
+ * эталоном по точке, в том числе для строки длиннее кэша, где плитки
+ * вытесняются посреди строки, пока DMA ещё передаёт предыдущие.
+ */
+
+#include "host.h"
+
+#define ROW_Y   100
+
+static uint16_t ref[16][LCD_WIDTH];
+
+static void ref_text(int32_t x, const char *s, uint16_t color, uint16_t bg) {
+    for (; *s; s++, x += 8) {
+        for (int32_t col = 0; col < 8; col++) {
+            uint16_t bits = Font8x16[(unsigned char)*s][col];
+            for (int32_t row = 0; row < 16; row++) {
+                ref[row][x + col] = (bits & (1u << (15 - row))) ? color : bg;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Строка в ROW_Y; возвращает попадания и промахи за вызов
+ */
+static void draw(const char *s, uint16_t color, uint32_t *hits, uint32_t *misses) {
+    uint32_t h0, m0;
+    font_cache_stats(&h0, &m0);
+    drawString8x16(0, ROW_Y, s, color, COLOR_BLACK);
+    ILI9225_DMA_wait();
+    font_cache_stats(hits, misses);
+    *hits -= h0;
+    *misses -= m0;
+    ref_text(0, s, color, COLOR_BLACK);
+}
+
+static void test(void) {
+    uint32_t hits, misses;
+
+    CHECK_EQ(FONT_GLYPH_CACHE_SIZE, 8);
+    ILI9225_init();
+    font_cache_clear();
+
+    // Холодный кэш: все промахи, повтор — все попадания
+    draw("ABCDEFGH", COLOR_WHITE, &hits, &misses);
+    CHECK_EQ(hits, 0);
+    CHECK_EQ(misses, 8);
+    draw("HGFEDCBA", COLOR_WHITE, &hits, &misses);
+    CHECK_EQ(hits, 8);
+    CHECK_EQ(misses, 0);
+
+    // Повтор внутри строки тоже попадание
+    draw("AAAA", COLOR_WHITE, &hits, &misses);
+    CHECK_EQ(hits, 4);
+    CHECK_EQ(misses, 0);
+
+    // Девятый символ вытесняет самый давний (H), A и B остаются
+    draw("I", COLOR_WHITE, &hits, &misses);
+    CHECK_EQ(misses, 1);
+    draw("AB", COLOR_WHITE, &hits, &misses);
+    CHECK_EQ(hits, 2);
+    draw("H", COLOR_WHITE, &hits, &misses);
+    CHECK_EQ(misses, 1);
+
+    // Другой цвет — другой ключ
+    draw("A", COLOR_RED, &hits, &misses);
+    CHECK_EQ(misses, 1);
+    draw("A", COLOR_WHITE, &hits, &misses);
+    CHECK_EQ(hits, 1);
+
+    // Строка длиннее кэша: вытеснение посреди строки, DMA с задержкой
+    host_dma_latency(4);
+    font_cache_clear();
+    draw("0123456789abcdefghijk", COLOR_GREEN, &hits, &misses);
+    CHECK_EQ(misses, 21);
+    CHECK_EQ(host_lcd_expect(&ref[0][0], 0, ROW_Y, LCD_WIDTH, 16, "font_cache_evict"), 0);
+
+    // Пункт меню из шести разных символов: второй раз целиком из кэша
+    static const char line[] = "  Menu 1  ";
+    host_dma_latency(0);
+    font_cache_clear();
+    uint64_t t0 = host_time_us();
+    draw(line, COLOR_WHITE, &hits, &misses);
+    uint64_t cold = host_time_us() - t0;
+    uint32_t cold_misses = misses;
+    t0 = host_time_us();
+    draw(line, COLOR_WHITE, &hits, &misses);
+    uint64_t warm = host_time_us() - t0;
+    printf("\"%s\": cold %u misses / %u us, warm %u hits %u misses / %u us\n", line,
+           (unsigned)cold_misses, (unsigned)cold, (unsigned)hits, (unsigned)misses, (unsigned)warm);
+    CHECK_EQ(cold_misses, 6);
+    CHECK_EQ(misses, 0);
+    CHECK_EQ(host_lcd_expect(&ref[0][0], 0, ROW_Y, LCD_WIDTH, 16, "font_cache"), 0);
+    CHECK_EQ(host_lcd.outside, 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
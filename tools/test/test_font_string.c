@@ -0,0 +1,86 @@
+/**
+ * @file test_font_string.c
+ * @brief drawString8x16(): строка одним окном, картинка как у drawChar8x16()
+ *
+ * Эталон рисуется по точке прямо из Font8x16. Строки с латиницей,
+ * кириллицей (CP1251) и обрезанные правым краем экрана; итог сверяется
+ * ещё и с golden/font_string.ppm.
+ */
+
+#include "host.h"
+
+#define AREA_Y  24
+#define AREA_H  (5 * 20)
+
+static uint16_t ref[LCD_HEIGHT][LCD_WIDTH];
+
+static void ref_text(int32_t x, int32_t y, const char *s, uint16_t color, uint16_t bg) {
+    for (; *s && x + 8 <= LCD_WIDTH; s++, x += 8) {
+        for (int32_t col = 0; col < 8; col++) {
+            uint16_t bits = Font8x16[(unsigned char)*s][col];
+            for (int32_t row = 0; row < 16; row++) {
+                ref[y + row][x + col] = (bits & (1u << (15 - row))) ? color : bg;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Строка драйвером и эталоном; одно окно на строку
+ * @return пикселей, записанных в GRAM
+ */
+static uint32_t draw(uint16_t x, uint16_t y, const char *s, uint16_t color, uint16_t bg) {
+    ILI9225_DMA_wait();
+    ILI9225_invalidateShadow();
+    host_lcd_clear_stats();
+    drawString8x16(x, y, s, color, bg);
+    ILI9225_DMA_wait();
+    ref_text(x, y, s, color, bg);
+
+    CHECK_EQ(host_lcd_window_writes(), 4);
+    CHECK_EQ(host_lcd.outside, 0);
+    return host_lcd.pixels;
+}
+
+static void test(void) {
+    static const char latin[] = "Hello, 8x16!";
+    static const char cyrillic[] = "\xCF\xF3\xED\xEA\xF2 \xB8\xC6\xFF";   // "Пункт ёЖя"
+    static const char longer[] = "0123456789ABCDEFGHIJKLMN";            // 24 символа, влезает 22
+
+    ILI9225_init();
+    host_lcd_fill(COLOR_BLACK);
+    host_dma_latency(2);
+
+    CHECK_EQ(draw(0, AREA_Y, latin, COLOR_WHITE, COLOR_BLACK), 12 * 128);
+    CHECK_EQ(draw(13, AREA_Y + 20, cyrillic, COLOR_YELLOW, COLOR_BLUE), 9 * 128);
+    CHECK_EQ(draw(0, AREA_Y + 40, longer, COLOR_GREEN, COLOR_BLACK), 22 * 128);
+    CHECK_EQ(draw(150, AREA_Y + 60, "abcdef", COLOR_RED, COLOR_WHITE), 3 * 128);
+
+    // Пустая строка и строка за краем экрана ничего не пишут
+    host_lcd_clear_stats();
+    drawString8x16(0, AREA_Y, "", COLOR_RED, COLOR_RED);
+    drawString8x16(LCD_WIDTH, AREA_Y, "x", COLOR_RED, COLOR_RED);
+    drawString8x16(170, AREA_Y, "x", COLOR_RED, COLOR_RED);
+    ILI9225_DMA_wait();
+    CHECK_EQ(host_lcd.pixels, 0);
+
+    // Та же строка по символу: та же картинка, но окно на каждый символ
+    ILI9225_invalidateShadow();
+    host_lcd_clear_stats();
+    for (uint8_t i = 0; latin[i]; i++) {
+        drawChar8x16(i * 8, AREA_Y + 80, latin[i], COLOR_CYAN, COLOR_BLACK);
+    }
+    ILI9225_DMA_wait();
+    uint32_t per_char = host_lcd_window_writes();
+    ref_text(0, AREA_Y + 80, latin, COLOR_CYAN, COLOR_BLACK);
+    printf("window writes for %u glyphs: 4 as a string, %u char by char\n",
+           (unsigned)(sizeof(latin) - 1), (unsigned)per_char);
+    CHECK(per_char > 4 * 4);
+
+    CHECK_EQ(host_lcd_expect(&ref[AREA_Y][0], 0, AREA_Y, LCD_WIDTH, AREA_H, "font_string"), 0);
+    CHECK_EQ(host_lcd_golden("font_string", 0, AREA_Y, LCD_WIDTH, AREA_H), 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
@@ -0,0 +1,195 @@
+/**
+ * @file test_gallery.c
+ * @brief Галерея: ключ записи кэша миниатюр и перестройка по нему
+ *
+ * Картинки собраны так, что усреднение блоков k x k даёт точный эталон:
+ * пиксели одинаковы внутри каждого блока. Ключ записи — имя, размер и
+ * время изменения исходника; время ставится через f_utime(), потому что
+ * часы прошивки без RTC всегда отдают одно и то же.
+ */
+
+#include "host.h"
+#include "file_work.h"
+#include "gallery.h"
+#include "SD_card.h"
+#include <string.h>
+
+#define HDR     54
+#define CELL_W  (LCD_WIDTH / GALLERY_COLS)
+#define CELL_H  (LCD_HEIGHT / GALLERY_ROWS)
+
+enum { PAT_A, PAT_B, PAT_B2 };
+
+static uint8_t file[HDR + 160 * 160 * 3];
+static uint16_t ref[GALLERY_THUMB * GALLERY_THUMB];
+
+static void put16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static void put32(uint8_t *p, uint32_t v) { put16(p, v); put16(p + 2, v >> 16); }
+
+/**
+ * @brief Цвет блока (u, v) миниатюры для картинки pat
+ */
+static void pattern(uint8_t pat, uint16_t u, uint16_t v, uint8_t rgb[3]) {
+    switch (pat) {
+    case PAT_A:  rgb[0] = (uint8_t)(u * 6); rgb[1] = (uint8_t)(v * 6); rgb[2] = 100;              break;
+    case PAT_B:  rgb[0] = 200;              rgb[1] = (uint8_t)(u * 5); rgb[2] = (uint8_t)(v * 5); break;
+    default:     rgb[0] = (uint8_t)(u * 5); rgb[1] = 50;              rgb[2] = (uint8_t)(v * 6); break;
+    }
+}
+
+/**
+ * @brief BMP 24 бита w x h из блоков k x k и эталон миниатюры (w/k x h/k)
+ */
+static uint32_t make_bmp(uint8_t pat, uint16_t w, uint16_t h, uint16_t k, uint8_t top_down) {
+    uint32_t stride = (w * 3u + 3) & ~3u;
+    uint32_t size = HDR + stride * h;
+    memset(file, 0, size);
+    file[0] = 'B';
+    file[1] = 'M';
+    put32(file + 2, size);
+    put32(file + 10, HDR);
+    put32(file + 14, 40);
+    put32(file + 18, w);
+    put32(file + 22, top_down ? (uint32_t)-h : h);
+    put16(file + 26, 1);
+    put16(file + 28, 24);
+
+    for (uint16_t y = 0; y < h; y++) {
+        uint8_t *row = file + HDR + (uint32_t)(top_down ? y : h - 1 - y) * stride;
+        for (uint16_t x = 0; x < w; x++) {
+            uint8_t rgb[3];
+            pattern(pat, x / k, y / k, rgb);
+            row[x * 3 + 0] = rgb[2];
+            row[x * 3 + 1] = rgb[1];
+            row[x * 3 + 2] = rgb[0];
+            ref[(y / k) * (w / k) + x / k] = host_rgb565(rgb[0], rgb[1], rgb[2]);
+        }
+    }
+    return size;
+}
+
+/**
+ * @brief Время изменения файла: ключ записи кэша
+ */
+static void touch(const char *name, uint16_t ftime) {
+    FILINFO fno;
+    memset(&fno, 0, sizeof(fno));
+    fno.fdate = (uint16_t)(((2024 - 1980) << 9) | (1 << 5) | 1);
+    fno.ftime = ftime;
+    CHECK_EQ(f_utime(name, &fno), FR_OK);
+}
+
+/**
+ * @brief Миниатюра w x h в ячейке slot сверяется с ref
+ */
+static uint32_t expect_thumb(uint8_t slot, uint16_t w, uint16_t h, const char *name) {
+    uint16_t x0 = (slot % GALLERY_COLS) * CELL_W + (CELL_W - w) / 2;
+    uint16_t y0 = (slot / GALLERY_COLS) * CELL_H + (CELL_H - h) / 2;
+    return host_lcd_expect(ref, x0, y0, w, h, name);
+}
+
+/**
+ * @brief Главный цикл между нажатиями: дописывает очередь SD (CTRL_SYNC
+ * кэша секторов), чтобы счётчики карты видели только следующий вывод
+ */
+static void idle(void) {
+    while (SD_QueuePoll()) {}
+}
+
+static void test(void) {
+    ILI9225_init();
+    CHECK_EQ(host_fs_format(HOST_SD_V2HC, 65536), FR_OK);
+
+    // A: 160x160 -> 40x40 (k = 4), B: 120x120 -> 40x40 (k = 3),
+    // C: 16 бит с чужими масками — серая заглушка, текст — мимо галереи
+    uint32_t a_size = make_bmp(PAT_A, 160, 160, 4, 0);
+    CHECK_EQ(host_fs_write("A.BMP", file, a_size), FR_OK);
+    uint32_t b_size = make_bmp(PAT_B, 120, 120, 3, 1);
+    CHECK_EQ(host_fs_write("B.BMP", file, b_size), FR_OK);
+    make_bmp(PAT_A, 8, 8, 1, 0);
+    put16(file + 28, 16);
+    put32(file + 30, 3);
+    CHECK_EQ(host_fs_write("C.BMP", file, HDR + 16 + 8 * 16), FR_OK);
+    CHECK_EQ(host_fs_write("D.TXT", "not an image", 12), FR_OK);
+    touch("A.BMP", 0x1000);
+    touch("B.BMP", 0x2000);
+    touch("C.BMP", 0x3000);
+
+    // Первый вывод строит все записи
+    uint8_t count = 0;
+    idle();
+    host_sd_clear_stats();
+    CHECK_EQ(gallery_draw(0, &count), FR_OK);
+    CHECK_EQ(count, 3);
+    CHECK(host_sd.blocks_read >= (a_size + b_size) / 512);
+    CHECK(host_sd.blocks_written > 0);
+    CHECK(gallery_name(0) && strcmp(gallery_name(0), "A.BMP") == 0);
+    CHECK(gallery_name(1) && strcmp(gallery_name(1), "B.BMP") == 0);
+    CHECK(gallery_name(2) && strcmp(gallery_name(2), "C.BMP") == 0);
+    CHECK(gallery_name(3) == NULL);
+    FILINFO fno;
+    CHECK_EQ(f_stat(GALLERY_CACHE_NAME, &fno), FR_OK);
+    CHECK_EQ(fno.fattrib & (AM_HID | AM_SYS), AM_HID | AM_SYS);
+
+    make_bmp(PAT_A, 160, 160, 4, 0);
+    CHECK_EQ(expect_thumb(0, 40, 40, "gallery_a"), 0);
+    make_bmp(PAT_B, 120, 120, 3, 1);
+    CHECK_EQ(expect_thumb(1, 40, 40, "gallery_b"), 0);
+    for (uint32_t i = 0; i < GALLERY_THUMB * GALLERY_THUMB; i++) ref[i] = COLOR_GRAY;
+    CHECK_EQ(expect_thumb(2, GALLERY_THUMB, GALLERY_THUMB, "gallery_c"), 0);
+
+    // Ключи совпали: только кэш, исходники не читаются, запись не нужна
+    host_lcd_fill(COLOR_BLACK);
+    idle();
+    host_sd_clear_stats();
+    CHECK_EQ(gallery_draw(0, &count), FR_OK);
+    printf("cached page: %u sectors read\n", (unsigned)host_sd.blocks_read);
+    CHECK(host_sd.blocks_read < b_size / 512);
+    CHECK_EQ(host_sd.blocks_written, 0);
+    make_bmp(PAT_A, 160, 160, 4, 0);
+    CHECK_EQ(expect_thumb(0, 40, 40, "gallery_a_cached"), 0);
+
+    // Другое время у A: перестраивается только A
+    touch("A.BMP", 0x1001);
+    idle();
+    host_sd_clear_stats();
+    CHECK_EQ(gallery_draw(0, &count), FR_OK);
+    printf("touched A: %u read, %u written\n", (unsigned)host_sd.blocks_read, (unsigned)host_sd.blocks_written);
+    CHECK(host_sd.blocks_read >= a_size / 512);
+    CHECK(host_sd.blocks_read < (a_size + b_size) / 512);
+    // Пиксели и заголовок записи A (7 секторов), FAT и каталог
+    CHECK(host_sd.blocks_written > 0);
+    CHECK(host_sd.blocks_written <= 7 + 3);
+
+    // Другой размер у B при прежнем времени: новая миниатюра 40x39
+    uint32_t b2_size = make_bmp(PAT_B2, 120, 117, 3, 1);
+    CHECK(b2_size != b_size);
+    CHECK_EQ(host_fs_write("B.BMP", file, b2_size), FR_OK);
+    touch("B.BMP", 0x2000);
+    idle();
+    host_sd_clear_stats();
+    CHECK_EQ(gallery_draw(0, &count), FR_OK);
+    CHECK(host_sd.blocks_read >= b2_size / 512);
+    CHECK(host_sd.blocks_read < (a_size + b2_size) / 512);
+    CHECK_EQ(expect_thumb(1, 40, 39, "gallery_b2"), 0);
+
+    // Размер и время те же, содержимое другое: ключ совпал, запись старая
+    make_bmp(PAT_B, 120, 117, 3, 1);
+    CHECK_EQ(host_fs_write("B.BMP", file, b2_size), FR_OK);
+    touch("B.BMP", 0x2000);
+    idle();
+    host_sd_clear_stats();
+    CHECK_EQ(gallery_draw(0, &count), FR_OK);
+    CHECK_EQ(host_sd.blocks_written, 0);
+    make_bmp(PAT_B2, 120, 117, 3, 1);
+    CHECK_EQ(expect_thumb(1, 40, 39, "gallery_b2_stale"), 0);
+
+    // Страница за последней картинкой пустая
+    CHECK_EQ(gallery_draw(1, &count), FR_OK);
+    CHECK_EQ(count, 0);
+    CHECK(gallery_name(0) == NULL);
+}
+
+int main(void) {
+    return host_run(test);
+}
@@ -0,0 +1,97 @@
+/**
+ * @file test_lcd_dma.c
+ * @brief Потоковая передача пикселей в SPI2 через DMA1 канал 5
+ *
+ * Заливка больше 65535 пикселей (несколько порций CNDTR), передача
+ * массива, флаг занятости и callback, CS после окончания, время по шине.
+ */
+
+#include "host.h"
+
+static uint32_t callbacks;
+
+static void on_done(void) {
+    callbacks++;
+}
+
+/**
+ * @brief Вся GRAM одного цвета
+ */
+static uint32_t count_not(uint16_t color) {
+    uint32_t bad = 0;
+    for (uint16_t y = 0; y < LCD_HEIGHT; y++) {
+        for (uint16_t x = 0; x < LCD_WIDTH; x++) bad += host_lcd_pixel(x, y) != color;
+    }
+    return bad;
+}
+
+static void test(void) {
+    // Очистка при инициализации идёт через DMA
+    host_lcd_fill(0xFFFF);
+    ILI9225_init();
+    CHECK_EQ(count_not(COLOR_BLACK), 0);
+    CHECK(host_bus.spi2_dma_words >= (uint32_t)LCD_WIDTH * LCD_HEIGHT);
+    CHECK_EQ(host_bus.spi2_frames8, 0);
+
+    // Двойной экран одним вызовом: 77440 пикселей — две порции DMA,
+    // окно заворачивается, CPU за это время на шину не выходит
+    const uint32_t screen = (uint32_t)LCD_WIDTH * LCD_HEIGHT;
+    ILI9225_DMA_setCallback(on_done);
+    ILI9225_setWindow(0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1);
+    ILI9225_writeIndex(GRAM_DATA_REG);
+
+    host_bus_clear();
+    host_lcd_clear_stats();
+    uint64_t t0 = host_time_us();
+    ILI9225_DMA_fillColor(COLOR_RED, 2 * screen);
+    ILI9225_DMA_wait();
+    uint64_t dt = host_time_us() - t0;
+
+    CHECK_EQ(callbacks, 1);
+    CHECK_EQ(host_lcd.pixels, 2 * screen);
+    CHECK_EQ(host_lcd.outside, 0);
+    CHECK_EQ(host_bus.spi2_dma_words, 2 * screen);
+    CHECK_EQ(host_bus.spi2_frames16, 2 * screen);
+    CHECK_EQ(count_not(COLOR_RED), 0);
+    CHECK_EQ(host_line[HOST_LINE_LCD_CS], 0);
+    CHECK(!ILI9225_DMA_busy());
+
+    // Скорость линии: 16 бит на пиксель, SPI2 = 36 МГц / 4
+    uint64_t line_us = 2 * screen * 16 * 4 / 36;
+    CHECK(dt >= line_us && dt <= line_us + line_us / 50);
+
+    // Массив: окно 10 x 20, заполнение по столбцам (x снаружи, y внутри)
+    static uint16_t pixels[10 * 20];
+    for (uint16_t i = 0; i < 10 * 20; i++) pixels[i] = (uint16_t)(i * 331u + 7);
+
+    host_dma_latency(4);
+    ILI9225_setWindow(5, 7, 5 + 9, 7 + 19);
+    ILI9225_writeIndex(GRAM_DATA_REG);
+    ILI9225_DMA_sendPixels(pixels, 10 * 20);
+
+    // Возврат сразу: передача идёт, пока процессор свободен
+    CHECK(ILI9225_DMA_busy());
+    ILI9225_DMA_wait();
+    CHECK_EQ(callbacks, 2);
+
+    uint32_t bad = 0;
+    for (uint16_t x = 0; x < 10; x++) {
+        for (uint16_t y = 0; y < 20; y++) bad += host_lcd_pixel(5 + x, 7 + y) != pixels[x * 20 + y];
+    }
+    CHECK_EQ(bad, 0);
+    CHECK_EQ(host_lcd_pixel(4, 7), COLOR_RED);
+    CHECK_EQ(host_lcd_pixel(15, 7), COLOR_RED);
+
+    // Без callback тоже заканчивается
+    ILI9225_DMA_setCallback(0);
+    ILI9225_setWindow(0, 0, 0, 0);
+    ILI9225_writeIndex(GRAM_DATA_REG);
+    ILI9225_DMA_fillColor(COLOR_BLUE, 1);
+    ILI9225_DMA_wait();
+    CHECK_EQ(callbacks, 2);
+    CHECK_EQ(host_lcd_pixel(0, 0), COLOR_BLUE);
+}
+
+int main(void) {
+    return host_run(test);
+}
@@ -0,0 +1,65 @@
+/**
+ * @file test_lcd_frames.c
+ * @brief SPI2 в 16-битном режиме: одно слово — один кадр (одна запись DR)
+ *
+ * Весь вывод драйвера, включая индексы регистров, идёт 16-битными
+ * кадрами; профиль шины не переключается туда-обратно. Для сравнения тот
+ * же вывод при 8-битном профиле дисплея: вдвое больше записей DR при том
+ * же времени на линии.
+ */
+
+#include "host.h"
+
+/**
+ * @brief Команды и пиксели через CPU, без DMA
+ */
+static void cpu_workload(void) {
+    for (uint16_t i = 0; i < 64; i++) ILI9225_drawPixel(i, 100, COLOR_WHITE);
+    ILI9225_write(GATE_SCAN_CTRL, 0x0000);
+}
+
+static void test(void) {
+    ILI9225_init();
+    CHECK(SPI2->CR1 & SPI_CR1_DFF);
+
+    host_bus_clear();
+    ILI9225_fillRect(0, 0, 100, 50, COLOR_BLUE);
+    drawString8x16(0, 60, "16-bit frames", COLOR_WHITE, COLOR_BLACK);
+    ILI9225_drawLine(0, 219, 175, 120, COLOR_RED);
+    cpu_workload();
+    ILI9225_DMA_wait();
+    CHECK_EQ(host_bus.spi2_frames8, 0);
+    CHECK(host_bus.spi2_frames16 > 0);
+    CHECK_EQ(host_bus.profile_writes[1], 0);
+    CHECK_EQ(host_lcd.outside, 0);
+
+    // Профиль с 8-битным кадром: слово уходит двумя записями DR
+    SPI_set_profile(2, SPI_BaudRatePrescaler_4);
+    host_bus_clear();
+    host_lcd_clear_stats();
+    uint64_t t0 = host_time_us();
+    cpu_workload();
+    uint64_t t8 = host_time_us() - t0;
+    uint32_t dr8 = host_bus.spi2_frames8;
+    CHECK_EQ(host_bus.spi2_frames16, 0);
+    CHECK_EQ(host_lcd.pixels, 64);
+    CHECK_EQ(host_lcd_pixel(10, 100), COLOR_WHITE);
+
+    SPI_set_profile(2, SPI_CR1_DFF | SPI_BaudRatePrescaler_4);
+    host_bus_clear();
+    t0 = host_time_us();
+    cpu_workload();
+    uint64_t t16 = host_time_us() - t0;
+    uint32_t dr16 = host_bus.spi2_frames16;
+    CHECK_EQ(host_bus.spi2_frames8, 0);
+
+    printf("CPU path: %u DR writes / %u us in 8-bit mode, %u / %u us in 16-bit mode\n",
+           (unsigned)dr8, (unsigned)t8, (unsigned)dr16, (unsigned)t16);
+    CHECK_EQ(dr8, 2 * dr16);
+    CHECK(t8 <= t16 + 1 && t16 <= t8 + 1);   // те же биты на линии
+    CHECK(SPI2->CR1 & SPI_CR1_DFF);
+}
+
+int main(void) {
+    return host_run(test);
+}
@@ -0,0 +1,165 @@
+/**
+ * @file test_lcd_primitives.c
+ * @brief Примитивы ILI9225: картинка против эталонного растеризатора и
+ * кадры SPI2 против рисования по пикселю
+ *
+ * Эталон рисует по одной точке в буфер в памяти; драйвер — окнами.
+ * Каждый примитив должен закрасить ровно свои пиксели, по одному разу.
+ */
+
+#include "host.h"
+#include <stdlib.h>
+
+static uint16_t ref[LCD_HEIGHT][LCD_WIDTH];
+static uint32_t ref_plots;
+
+static void ref_pixel(int32_t x, int32_t y, uint16_t color) {
+    if (x < 0 || y < 0 || x >= LCD_WIDTH || y >= LCD_HEIGHT) return;
+    ref[y][x] = color;
+    ref_plots++;
+}
+
+static void ref_fill(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+    for (int32_t j = 0; j < h; j++) {
+        for (int32_t i = 0; i < w; i++) ref_pixel(x + i, y + j, color);
+    }
+}
+
+static void ref_rect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+    for (int32_t j = 0; j < h; j++) {
+        for (int32_t i = 0; i < w; i++) {
+            if (i == 0 || j == 0 || i == w - 1 || j == h - 1) ref_pixel(x + i, y + j, color);
+        }
+    }
+}
+
+/**
+ * @brief Брезенхем по точке: тот же выбор пикселей, что и у отрезков
+ */
+static void ref_line(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t color) {
+    int32_t t;
+    int steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep) { t = x0; x0 = y0; y0 = t; t = x1; x1 = y1; y1 = t; }
+    if (x0 > x1) { t = x0; x0 = x1; x1 = t; t = y0; y0 = y1; y1 = t; }
+
+    int32_t dx = x1 - x0, dy = abs(y1 - y0), err = dx / 2;
+    int32_t ystep = (y0 < y1) ? 1 : -1;
+    for (; x0 <= x1; x0++) {
+        if (steep) ref_pixel(y0, x0, color);
+        else       ref_pixel(x0, y0, color);
+        err -= dy;
+        if (err < 0) {
+            y0 += ystep;
+            err += dx;
+        }
+    }
+}
+
+static void ref_circle(int32_t x0, int32_t y0, int32_t r, uint16_t color) {
+    for (int32_t dy = -r; dy <= r; dy++) {
+        for (int32_t dx = -r; dx <= r; dx++) {
+            if (dx * dx + dy * dy <= r * r) ref_pixel(x0 + dx, y0 + dy, color);
+        }
+    }
+}
+
+/**
+ * @brief Кадры SPI2 и пиксели GRAM на один примитив
+ */
+typedef struct {
+    uint32_t frames;
+    uint32_t pixels;
+} cost_t;
+
+static void cost_begin(void) {
+    ILI9225_DMA_wait();
+    host_bus_clear();
+    host_lcd_clear_stats();
+    ref_plots = 0;
+}
+
+static cost_t cost_end(const char *name) {
+    ILI9225_DMA_wait();
+    cost_t c = {host_bus.spi2_frames16 + host_bus.spi2_frames8, host_lcd.pixels};
+    printf("%-12s %6u px %6u frames\n", name, (unsigned)c.pixels, (unsigned)c.frames);
+    CHECK_EQ(host_lcd.outside, 0);
+    return c;
+}
+
+static void test(void) {
+    ILI9225_init();
+
+    // Рисование по пикселю: базовая цена одной точки
+    cost_begin();
+    for (uint16_t i = 0; i < 100; i++) {
+        ILI9225_drawPixel(i, i * 2, COLOR_WHITE);
+        ref_pixel(i, i * 2, COLOR_WHITE);
+    }
+    cost_t px = cost_end("drawPixel");
+    CHECK_EQ(px.pixels, 100);
+    uint32_t per_pixel = px.frames / 100;
+
+    cost_begin();
+    ILI9225_fillRect(10, 20, 50, 40, COLOR_RED);
+    ref_fill(10, 20, 50, 40, COLOR_RED);
+    cost_t fr = cost_end("fillRect");
+    CHECK_EQ(fr.pixels, 50 * 40);
+    CHECK(fr.frames * 5 < fr.pixels * per_pixel);
+
+    cost_begin();
+    ILI9225_drawHLine(3, 100, 120, COLOR_GREEN);
+    ILI9225_drawVLine(150, 5, 200, COLOR_GREEN);
+    ref_fill(3, 100, 120, 1, COLOR_GREEN);
+    ref_fill(150, 5, 1, 200, COLOR_GREEN);
+    cost_t hv = cost_end("H/VLine");
+    CHECK_EQ(hv.pixels, 320);
+    CHECK(hv.frames * 5 < hv.pixels * per_pixel);
+
+    cost_begin();
+    ILI9225_drawRect(70, 10, 60, 30, COLOR_YELLOW);
+    ref_rect(70, 10, 60, 30, COLOR_YELLOW);
+    cost_t rc = cost_end("drawRect");
+    CHECK_EQ(rc.pixels, ref_plots);
+
+    // Линии во всех октантах, почти горизонтальные и крутые
+    static const uint16_t lines[][4] = {
+        {0, 0, 175, 219}, {175, 0, 0, 219}, {5, 150, 170, 160}, {170, 165, 5, 150},
+        {20, 60, 30, 210}, {40, 210, 45, 60}, {88, 110, 88, 110}, {0, 219, 175, 218},
+    };
+    cost_begin();
+    for (uint8_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++) {
+        ILI9225_drawLine(lines[i][0], lines[i][1], lines[i][2], lines[i][3], COLOR_CYAN);
+        ref_line(lines[i][0], lines[i][1], lines[i][2], lines[i][3], COLOR_CYAN);
+    }
+    cost_t ln = cost_end("drawLine");
+    CHECK_EQ(ln.pixels, ref_plots);
+    CHECK(ln.frames < ln.pixels * per_pixel);
+
+    // Круги: целиком на экране и обрезанные краем
+    cost_begin();
+    ILI9225_fillCircle(88, 160, 30, COLOR_MAGENTA);
+    ILI9225_fillCircle(5, 5, 12, COLOR_MAGENTA);
+    ILI9225_fillCircle(170, 215, 9, COLOR_MAGENTA);
+    ILI9225_fillCircle(120, 40, 0, COLOR_MAGENTA);
+    ref_circle(88, 160, 30, COLOR_MAGENTA);
+    ref_circle(5, 5, 12, COLOR_MAGENTA);
+    ref_circle(170, 215, 9, COLOR_MAGENTA);
+    ref_circle(120, 40, 0, COLOR_MAGENTA);
+    cost_t ci = cost_end("fillCircle");
+    CHECK_EQ(ci.pixels, ref_plots);
+    CHECK(ci.frames * 4 < ci.pixels * per_pixel);
+
+    // Прямоугольник за краем экрана обрезается
+    cost_begin();
+    ILI9225_fillRect(160, 200, 40, 40, COLOR_ORANGE);
+    ILI9225_fillRect(LCD_WIDTH, 0, 10, 10, COLOR_ORANGE);
+    ref_fill(160, 200, 40, 40, COLOR_ORANGE);
+    cost_t cl = cost_end("clipped");
+    CHECK_EQ(cl.pixels, 16 * 20);
+
+    CHECK_EQ(host_lcd_expect(&ref[0][0], 0, 0, LCD_WIDTH, LCD_HEIGHT, "lcd_primitives"), 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
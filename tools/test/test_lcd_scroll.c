@@ -0,0 +1,144 @@
+/**
+ * @file test_lcd_scroll.c
+ * @brief Аппаратная прокрутка в четырёх ориентациях
+ *
+ * Ось прокрутки — логическая y в 0/2 и x в 1/3, в 2/3 она развёрнута
+ * относительно строк затворов. Для каждой ориентации сверяются
+ * VERTICAL_SCROLL_CTRL1..3 и то, что видно на экране после сдвигов:
+ * строки, нарисованные по ILI9225_scrollLine(), должны оказаться на
+ * своих логических местах.
+ */
+
+#include "host.h"
+
+#define AREA_START  30
+#define AREA_END    199
+#define AREA_SIZE   (AREA_END - AREA_START + 1)
+#define STEP        7
+#define ACROSS      (LCD_WIDTH / 2 + 3)   // поперёк оси прокрутки
+
+static uint8_t orient;
+
+static uint16_t color(uint16_t line, uint8_t gen) {
+    return (uint16_t)(line * 293u + gen * 0x4A1u + 1);
+}
+
+/**
+ * @brief Строка вдоль оси прокрутки одним цветом (логические координаты)
+ */
+static void stripe(uint16_t line, uint16_t c) {
+    if (orient & 1) ILI9225_fillRect(line, 0, 1, LCD_WIDTH, c);
+    else ILI9225_fillRect(0, line, LCD_WIDTH, 1, c);
+    ILI9225_DMA_wait();
+}
+
+/**
+ * @brief Что видно на экране в логической строке line
+ */
+static uint16_t visible(uint16_t line) {
+    uint16_t x = (orient & 1) ? line : ACROSS;
+    uint16_t y = (orient & 1) ? ACROSS : line;
+    ILI9225_orientCoordinates(&x, &y);
+    return host_lcd_visible(x, y);
+}
+
+/**
+ * @brief Что лежит в GRAM в логической строке line (без прокрутки)
+ */
+static uint16_t stored(uint16_t line) {
+    uint16_t x = (orient & 1) ? line : ACROSS;
+    uint16_t y = (orient & 1) ? ACROSS : line;
+    ILI9225_orientCoordinates(&x, &y);
+    return host_lcd_pixel(x, y);
+}
+
+static void check_regs(uint16_t ssa, uint16_t sea, uint16_t sst) {
+    CHECK_EQ(host_lcd_reg(VERTICAL_SCROLL_CTRL2), ssa);
+    CHECK_EQ(host_lcd_reg(VERTICAL_SCROLL_CTRL1), sea);
+    CHECK_EQ(host_lcd_reg(VERTICAL_SCROLL_CTRL3), sst);
+}
+
+/**
+ * @brief Каждая видимая строка показывает то, что записано по scrollLine()
+ */
+static uint32_t check_mapping(void) {
+    uint32_t bad = 0;
+    for (uint16_t line = 0; line < LCD_HEIGHT; line++) {
+        bad += visible(line) != stored(ILI9225_scrollLine(line));
+    }
+    return bad;
+}
+
+static void run(uint8_t o) {
+    orient = o;
+    ILI9225_setOrientation(o);
+    check_regs(0, LCD_HEIGHT - 1, 0);
+    CHECK_EQ(ILI9225_scrollOffset(), 0);
+
+    // Область задаётся логически; в 2/3 она отражается на строки затворов
+    ILI9225_scrollSetArea(AREA_END, AREA_START);
+    uint8_t reversed = (o == 2 || o == 3);
+    uint16_t ssa = reversed ? LCD_HEIGHT - 1 - AREA_END : AREA_START;
+    uint16_t sea = reversed ? LCD_HEIGHT - 1 - AREA_START : AREA_END;
+    check_regs(ssa, sea, 0);
+
+    // Консоль: все строки на своих местах
+    for (uint16_t line = 0; line < LCD_HEIGHT; line++) stripe(ILI9225_scrollLine(line), color(line, 0));
+    uint32_t bad = 0;
+    for (uint16_t line = 0; line < LCD_HEIGHT; line++) bad += visible(line) != color(line, 0);
+    CHECK_EQ(bad, 0);
+
+    // Сдвиг к началу: старое поднялось на STEP, в конце дорисованы новые строки
+    host_lcd_clear_stats();
+    ILI9225_scrollBy(STEP);
+    CHECK_EQ(host_lcd.pixels, 0);
+    check_regs(ssa, sea, reversed ? AREA_SIZE - STEP : STEP);
+    for (uint16_t line = AREA_END - STEP + 1; line <= AREA_END; line++) {
+        stripe(ILI9225_scrollLine(line), color(line, 1));
+    }
+    CHECK_EQ(host_lcd.pixels, (uint32_t)STEP * LCD_WIDTH);
+
+    bad = 0;
+    for (uint16_t line = 0; line < LCD_HEIGHT; line++) {
+        uint16_t want;
+        if (line < AREA_START || line > AREA_END) want = color(line, 0);
+        else if (line <= AREA_END - STEP) want = color(line + STEP, 0);
+        else want = color(line, 1);
+        bad += visible(line) != want;
+    }
+    CHECK_EQ(bad, 0);
+
+    // Назад через ноль и прямая установка: отображение строк всегда сходится
+    ILI9225_scrollBy(-10);
+    CHECK_EQ(ILI9225_scrollOffset(), AREA_SIZE + STEP - 10);
+    CHECK_EQ(check_mapping(), 0);
+    ILI9225_scrollTo(AREA_SIZE + 5);
+    CHECK_EQ(ILI9225_scrollOffset(), 5);
+    check_regs(ssa, sea, reversed ? AREA_SIZE - 5 : 5);
+    CHECK_EQ(check_mapping(), 0);
+
+    // Вне области строки не переносятся
+    CHECK_EQ(ILI9225_scrollLine(AREA_START - 1), AREA_START - 1);
+    CHECK_EQ(ILI9225_scrollLine(AREA_END + 1), AREA_END + 1);
+
+    ILI9225_scrollReset();
+    check_regs(0, LCD_HEIGHT - 1, 0);
+    CHECK_EQ(check_mapping(), 0);
+    ILI9225_scrollBy(3);
+    CHECK_EQ(ILI9225_scrollOffset(), 3);
+}
+
+static void test(void) {
+    ILI9225_init();
+    for (uint8_t o = 0; o < 4; o++) run(o);
+    CHECK_EQ(host_lcd.outside, 0);
+
+    // Смена ориентации сбрасывает прокрутку
+    ILI9225_setOrientation(0);
+    check_regs(0, LCD_HEIGHT - 1, 0);
+    CHECK_EQ(ILI9225_scrollOffset(), 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
@@ -0,0 +1,127 @@
+/**
+ * @file test_lcd_shadow.c
+ * @brief Теневые копии регистров ILI9225: лишние записи окна и адреса
+ * не уходят на шину, а после сброса и смены ориентации — уходят
+ *
+ * По трассе записей в модели дисплея: сколько раз писался каждый регистр
+ * и какое значение в нём в итоге.
+ */
+
+#include "host.h"
+
+#define HWIN1   HORIZONTAL_WINDOW_ADDR1
+#define HWIN2   HORIZONTAL_WINDOW_ADDR2
+#define VWIN1   VERTICAL_WINDOW_ADDR1
+#define VWIN2   VERTICAL_WINDOW_ADDR2
+
+/**
+ * @brief Записи в регистры окна и адреса с последнего host_lcd_clear_stats()
+ */
+static uint32_t window_and_addr(void) {
+    return host_lcd_window_writes() + host_lcd.reg_writes[RAM_ADDR_SET1] + host_lcd.reg_writes[RAM_ADDR_SET2];
+}
+
+/**
+ * @brief Регистры окна в модели совпадают с заданным окном
+ */
+static void check_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+    CHECK_EQ(host_lcd_reg(HWIN2), x0);
+    CHECK_EQ(host_lcd_reg(HWIN1), x1);
+    CHECK_EQ(host_lcd_reg(VWIN2), y0);
+    CHECK_EQ(host_lcd_reg(VWIN1), y1);
+}
+
+static void fill(uint16_t color, uint32_t count) {
+    ILI9225_writeIndex(GRAM_DATA_REG);
+    ILI9225_DMA_fillColor(color, count);
+    ILI9225_DMA_wait();
+}
+
+/**
+ * @brief Строка по символу: окно на каждый, как в меню
+ */
+static uint32_t draw_line(uint8_t invalidate) {
+    static const char text[] = "Settings  Brightness";
+    host_lcd_clear_stats();
+    for (uint8_t i = 0; text[i]; i++) {
+        if (invalidate) ILI9225_invalidateShadow();
+        drawChar8x16(i * 8, 40, text[i], COLOR_WHITE, COLOR_BLACK);
+    }
+    ILI9225_DMA_wait();
+    return window_and_addr();
+}
+
+static void test(void) {
+    ILI9225_init();
+
+    // Одно и то же окно второй раз: ни одной записи
+    ILI9225_setWindow(10, 20, 49, 35);
+    host_lcd_clear_stats();
+    ILI9225_setWindow(10, 20, 49, 35);
+    CHECK_EQ(window_and_addr(), 0);
+    CHECK_EQ(host_lcd.index_writes, 0);
+
+    // Запись в GRAM сдвигает счётчик адреса: адрес пишется снова, окно — нет
+    fill(COLOR_RED, 40 * 16);
+    host_lcd_clear_stats();
+    ILI9225_setWindow(10, 20, 49, 35);
+    CHECK_EQ(host_lcd_window_writes(), 0);
+    CHECK_EQ(host_lcd.reg_writes[RAM_ADDR_SET1], 1);
+    CHECK_EQ(host_lcd.reg_writes[RAM_ADDR_SET2], 1);
+
+    // Сдвиг по x (следующий символ): вертикаль окна остаётся
+    fill(COLOR_RED, 40 * 16);
+    host_lcd_clear_stats();
+    ILI9225_setWindow(50, 20, 89, 35);
+    CHECK_EQ(host_lcd.reg_writes[HWIN1], 1);
+    CHECK_EQ(host_lcd.reg_writes[HWIN2], 1);
+    CHECK_EQ(host_lcd.reg_writes[VWIN1], 0);
+    CHECK_EQ(host_lcd.reg_writes[VWIN2], 0);
+    check_window(50, 20, 89, 35);
+    fill(COLOR_GREEN, 40 * 16);
+    CHECK_EQ(host_lcd.outside, 0);
+    CHECK_EQ(host_lcd_pixel(50, 20), COLOR_GREEN);
+    CHECK_EQ(host_lcd_pixel(89, 35), COLOR_GREEN);
+    CHECK_EQ(host_lcd_pixel(49, 35), COLOR_RED);
+
+    // Явный сброс копий: всё окно и адрес заново
+    ILI9225_invalidateShadow();
+    host_lcd_clear_stats();
+    ILI9225_setWindow(50, 20, 89, 35);
+    CHECK_EQ(host_lcd_window_writes(), 4);
+    CHECK_EQ(host_lcd.reg_writes[RAM_ADDR_SET1] + host_lcd.reg_writes[RAM_ADDR_SET2], 2);
+
+    // Аппаратный сброс возвращает регистры дисплея к исходным:
+    // копии сбрасываются, и то же окно снова доходит до дисплея
+    ILI9225_reset();
+    check_window(0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1);
+    host_lcd_clear_stats();
+    ILI9225_write(ENTRY_MODE, 0x1038);
+    ILI9225_setWindow(50, 20, 89, 35);
+    CHECK_EQ(host_lcd_window_writes(), 4);
+    check_window(50, 20, 89, 35);
+    CHECK_EQ(host_lcd_reg(ENTRY_MODE), 0x1038);
+
+    // Смена ориентации: ENTRY_MODE пишется, окно после неё — тоже
+    ILI9225_setOrientation(1);
+    CHECK_EQ(host_lcd_reg(ENTRY_MODE), 0x1030);
+    ILI9225_setOrientation(0);
+    CHECK_EQ(host_lcd_reg(ENTRY_MODE), 0x1038);
+    host_lcd_clear_stats();
+    ILI9225_setWindow(50, 20, 89, 35);
+    CHECK_EQ(host_lcd_window_writes(), 4);
+
+    // Строка текста по символу: с копиями и без них (сброс перед каждым)
+    uint32_t cached = draw_line(0);
+    uint16_t glyph = host_lcd_pixel(0, 40);
+    uint32_t uncached = draw_line(1);
+    printf("window/address writes for 20 glyphs: %u with shadow, %u without\n",
+           (unsigned)cached, (unsigned)uncached);
+    CHECK(cached * 4 < uncached * 3);
+    CHECK_EQ(host_lcd_pixel(0, 40), glyph);
+    CHECK_EQ(host_lcd.outside, 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
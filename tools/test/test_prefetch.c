@@ -0,0 +1,140 @@
+/**
+ * @file test_prefetch.c
+ * @brief Упреждающее чтение в diskcache: выдано, отдано, выброшено
+ *
+ * Последовательные чтения по сектору должны получать данные из кольца,
+ * разрыв потока и запись поверх кольца — выбрасывать его, а отданные
+ * данные всегда совпадать с картой. Упреждение не заходит за конец карты,
+ * а его сбой не сбрасывает скорость SPI1. В конце то же через f_read().
+ */
+
+#include "host.h"
+#include "diskcache.h"
+#include "file_work.h"
+#include <string.h>
+
+static uint8_t buf[2 * 512];
+static uint8_t data[24 * 512];
+
+static void pattern(uint8_t *p, uint32_t sector, uint8_t gen) {
+    for (uint32_t i = 0; i < 512; i++) p[i] = (uint8_t)(sector * 7 + i * 3 + gen * 59);
+}
+
+/**
+ * @brief Сектора подряд по одному, каждый сверяется с картой
+ */
+static void stream(uint32_t first, uint32_t count) {
+    for (uint32_t s = first; s < first + count; s++) {
+        CHECK_EQ(disk_cache_read(buf, s, 1), RES_OK);
+        CHECK_EQ(memcmp(buf, host_sd_sector(s), 512), 0);
+    }
+}
+
+static disk_cache_stats_t stats(void) {
+    disk_cache_stats_t st;
+    disk_cache_get_stats(&st);
+    return st;
+}
+
+static void test(void) {
+    host_sd_insert(HOST_SD_V2HC, 8192);
+    for (uint32_t s = 0; s < 2048; s++) pattern(host_sd_sector(s), s, 0);
+    CHECK_EQ(disk_initialize(0), 0);
+    disk_cache_pin(0, 0);
+    disk_cache_clear_stats();
+
+    // Поток из 32 секторов: первые два с карты, дальше из кольца
+    host_dma_latency(2);
+    stream(500, 32);
+    disk_cache_stats_t st = stats();
+    printf("32 sequential sectors: issued %u, hits %u, dropped %u, misses %u, stall %u us\n",
+           (unsigned)st.pf_issued, (unsigned)st.pf_hits, (unsigned)st.pf_dropped,
+           (unsigned)st.misses, (unsigned)st.pf_stall_us);
+    CHECK(st.pf_hits >= 28);
+    CHECK_EQ(st.pf_dropped, 0);
+    CHECK(st.pf_issued - st.pf_hits <= DISK_PREFETCH_DEPTH);
+
+    // Разрыв потока: кольцо выбрасывается, данные с нового места верные
+    uint32_t ahead = st.pf_issued - st.pf_hits;
+    stream(700, 1);
+    st = stats();
+    CHECK_EQ(st.pf_dropped, ahead);
+
+    // Многосекторная запись поверх кольца выбрасывает его: чтение не отдаёт старое
+    disk_cache_clear_stats();
+    stream(800, 6);
+    CHECK(stats().pf_issued > stats().pf_hits);
+    pattern(buf, 806, 1);
+    pattern(buf + 512, 807, 1);
+    CHECK_EQ(disk_cache_write(buf, 806, 2), RES_OK);
+    CHECK(stats().pf_dropped > 0);
+    stream(806, 2);
+    pattern(data, 807, 1);
+    CHECK_EQ(memcmp(buf, data, 512), 0);
+
+    // Запись мимо кольца его не трогает
+    stream(900, 6);
+    disk_cache_clear_stats();
+    CHECK_EQ(disk_cache_write(buf, 1500, 2), RES_OK);
+    stream(906, 4);
+    CHECK_EQ(stats().pf_dropped, 0);
+
+    // Чтение FAT (закреплённый диапазон) посреди потока его не рвёт
+    disk_cache_pin(50, 4);
+    stream(1000, 4);
+    disk_cache_clear_stats();
+    stream(51, 1);
+    stream(1004, 4);
+    st = stats();
+    CHECK_EQ(st.pf_dropped, 0);
+    CHECK_EQ(st.pf_hits, 4);
+    disk_cache_pin(0, 0);
+
+    // Поток до последнего сектора: за конец карты упреждение не читает
+    disk_cache_clear_stats();
+    stream(8192 - 8, 8);
+    CHECK_EQ(stats().pf_hits, 6);
+    CHECK_EQ(stats().pf_issued, 6);
+
+    // Сбой упреждающего чтения: сектор не в кольце, скорость SPI1 прежняя,
+    // а настоящее чтение после исправления сектора берёт его с карты
+    host_sd_bad_sector(1300);
+    disk_cache_clear_stats();
+    stream(1294, 6);
+    CHECK(sd_spi_is_high_speed());
+    CHECK_EQ(stats().pf_issued, stats().pf_hits);
+    host_sd_bad_sector(-1);
+    stream(1300, 2);
+    CHECK(sd_spi_is_high_speed());
+
+    // Остановка: чтение в пути дождано, SPI1 свободен для прямых SD_*
+    disk_prefetch_stop();
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 0);
+    CHECK_EQ(SD_ReadBlocks(1200, data, 2), SD_OK);
+    CHECK_EQ(memcmp(data + 512, host_sd_sector(1201), 512), 0);
+
+    // Файл через FatFS: f_read по сектору идёт потоком
+    host_dma_latency(0);
+    CHECK_EQ(host_fs_format(HOST_SD_V2HC, 65536), FR_OK);
+    for (uint32_t i = 0; i < sizeof(data) / 512; i++) pattern(data + i * 512, i, 2);
+    CHECK_EQ(host_fs_write("DATA.BIN", data, sizeof(data)), FR_OK);
+
+    FIL f;
+    UINT got;
+    CHECK_EQ(f_open(&f, "DATA.BIN", FA_READ), FR_OK);
+    disk_cache_clear_stats();
+    for (uint32_t i = 0; i < sizeof(data) / 512; i++) {
+        CHECK_EQ(f_read(&f, buf, 512, &got), FR_OK);
+        CHECK_EQ(got, 512);
+        CHECK_EQ(memcmp(buf, data + i * 512, 512), 0);
+    }
+    CHECK_EQ(f_close(&f), FR_OK);
+    st = stats();
+    printf("f_read of %u sectors: issued %u, hits %u, dropped %u\n", (unsigned)(sizeof(data) / 512),
+           (unsigned)st.pf_issued, (unsigned)st.pf_hits, (unsigned)st.pf_dropped);
+    CHECK(st.pf_hits >= sizeof(data) / 512 - 4);
+}
+
+int main(void) {
+    return host_run(test);
+}
@@ -0,0 +1,195 @@
+/**
+ * @file test_qoi.c
+ * @brief Потоковый декодер QOI: картинка со всеми кодами формата
+ *
+ * Файл собирает кодировщик по спецификации прямо в тесте, из картинки,
+ * где есть серии (в том числе через конец строки и длиннее 62), ссылки
+ * на таблицу, малые и средние разности, RGB и смена альфы. GRAM
+ * сверяется с исходными пикселями и с golden/qoi.ppm; испорченные файлы
+ * должны давать свои коды ошибок.
+ */
+
+#include "host.h"
+#include "file_work.h"
+#include "qoi.h"
+#include <string.h>
+
+#define W       60
+#define H       40
+#define POS_X   20
+#define POS_Y   30
+
+typedef struct {
+    uint8_t r, g, b, a;
+} rgba_t;
+
+static rgba_t img[H][W];
+static uint16_t ref[H][W];
+static uint8_t qoi[14 + W * H * 5 + 8];
+static uint32_t ops[6];     // INDEX, DIFF, LUMA, RUN, RGB, RGBA
+
+enum { OP_INDEX, OP_DIFF, OP_LUMA, OP_RUN, OP_RGB, OP_RGBA };
+
+static uint32_t rnd_state = 12345;
+
+static uint8_t rnd(void) {
+    rnd_state = rnd_state * 1103515245u + 12345u;
+    return (uint8_t)(rnd_state >> 16);
+}
+
+/**
+ * @brief Картинка по полосам строк, у каждой полосы свой характер
+ */
+static void make_image(void) {
+    static const rgba_t palette[3] = {{255, 0, 0, 255}, {0, 255, 0, 255}, {10, 20, 200, 255}};
+    for (uint16_t y = 0; y < H; y++) {
+        for (uint16_t x = 0; x < W; x++) {
+            rgba_t p;
+            if (y < 8) {                    // плавный градиент: DIFF и LUMA
+                p = (rgba_t){(uint8_t)(x + y), (uint8_t)(y * 9 + x / 2), (uint8_t)(200 - x), 255};
+            } else if (y < 16) {            // шум: RGB
+                p = (rgba_t){rnd(), rnd(), rnd(), 255};
+            } else if (y < 28) {            // заливка 8 строк и ещё: длинные серии
+                p = (y < 26 || x < 30) ? (rgba_t){40, 80, 120, 255} : (rgba_t){200, 180, 160, 255};
+            } else if (y < 34) {            // три цвета вперемешку: INDEX
+                p = palette[(x / 2 + y) % 3];
+            } else {                        // полупрозрачные точки: RGBA
+                p = (rgba_t){(uint8_t)(x * 4), 90, (uint8_t)(y * 6), (x % 5) ? 255 : (uint8_t)(x * 4)};
+            }
+            img[y][x] = p;
+            ref[y][x] = host_rgb565(p.r, p.g, p.b);
+        }
+    }
+}
+
+static uint8_t hash(rgba_t p) {
+    return (uint8_t)((p.r * 3 + p.g * 5 + p.b * 7 + p.a * 11) % 64);
+}
+
+static int eq(rgba_t a, rgba_t b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+/**
+ * @brief Кодировщик QOI по спецификации (qoiformat.org)
+ * @return длина файла
+ */
+static uint32_t encode(uint32_t w, uint32_t h) {
+    rgba_t index[64];
+    rgba_t prev = {0, 0, 0, 255};
+    uint32_t n = 0, run = 0;
+
+    memset(index, 0, sizeof(index));
+    memset(ops, 0, sizeof(ops));
+    memcpy(qoi, "qoif", 4);
+    n = 4;
+    for (int8_t s = 24; s >= 0; s -= 8) qoi[n++] = (uint8_t)(w >> s);
+    for (int8_t s = 24; s >= 0; s -= 8) qoi[n++] = (uint8_t)(h >> s);
+    qoi[n++] = 4;
+    qoi[n++] = 0;
+
+    for (uint32_t i = 0; i < w * h; i++) {
+        rgba_t p = img[i / w][i % w];
+        if (eq(p, prev)) {
+            run++;
+            if (run == 62 || i == w * h - 1) {
+                qoi[n++] = (uint8_t)(0xC0 | (run - 1));
+                ops[OP_RUN]++;
+                run = 0;
+            }
+            continue;
+        }
+        if (run) {
+            qoi[n++] = (uint8_t)(0xC0 | (run - 1));
+            ops[OP_RUN]++;
+            run = 0;
+        }
+
+        uint8_t hs = hash(p);
+        if (eq(index[hs], p)) {
+            qoi[n++] = hs;
+            ops[OP_INDEX]++;
+        } else {
+            index[hs] = p;
+            int8_t vr = (int8_t)(p.r - prev.r), vg = (int8_t)(p.g - prev.g), vb = (int8_t)(p.b - prev.b);
+            int8_t vg_r = (int8_t)(vr - vg), vg_b = (int8_t)(vb - vg);
+            if (p.a != prev.a) {
+                qoi[n++] = 0xFF;
+                qoi[n++] = p.r;
+                qoi[n++] = p.g;
+                qoi[n++] = p.b;
+                qoi[n++] = p.a;
+                ops[OP_RGBA]++;
+            } else if (vr >= -2 && vr <= 1 && vg >= -2 && vg <= 1 && vb >= -2 && vb <= 1) {
+                qoi[n++] = (uint8_t)(0x40 | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2));
+                ops[OP_DIFF]++;
+            } else if (vg >= -32 && vg <= 31 && vg_r >= -8 && vg_r <= 7 && vg_b >= -8 && vg_b <= 7) {
+                qoi[n++] = (uint8_t)(0x80 | (vg + 32));
+                qoi[n++] = (uint8_t)((vg_r + 8) << 4 | (vg_b + 8));
+                ops[OP_LUMA]++;
+            } else {
+                qoi[n++] = 0xFE;
+                qoi[n++] = p.r;
+                qoi[n++] = p.g;
+                qoi[n++] = p.b;
+                ops[OP_RGB]++;
+            }
+        }
+        prev = p;
+    }
+
+    memset(qoi + n, 0, 7);
+    n += 7;
+    qoi[n++] = 1;
+    return n;
+}
+
+static void test(void) {
+    ILI9225_init();
+    uint16_t entry = host_lcd_reg(ENTRY_MODE);
+    CHECK_EQ(host_fs_format(HOST_SD_V2HC, 65536), FR_OK);
+
+    make_image();
+    uint32_t len = encode(W, H);
+    printf("QOI %ux%u: %u bytes, index %u diff %u luma %u run %u rgb %u rgba %u\n", W, H, (unsigned)len,
+           (unsigned)ops[OP_INDEX], (unsigned)ops[OP_DIFF], (unsigned)ops[OP_LUMA],
+           (unsigned)ops[OP_RUN], (unsigned)ops[OP_RGB], (unsigned)ops[OP_RGBA]);
+    for (uint8_t i = 0; i < 6; i++) CHECK(ops[i] > 0);
+    CHECK(len > QOI_INPUT_WINDOW * 2);
+    CHECK_EQ(host_fs_write("IMG.QOI", qoi, len), FR_OK);
+    CHECK_EQ(host_fs_write("CUT.QOI", qoi, len / 2), FR_OK);
+
+    // Целиком: каждый пиксель один раз, окно картинки, порядок сканирования вернулся
+    host_lcd_fill(COLOR_BLACK);
+    host_lcd_clear_stats();
+    CHECK_EQ(qoi_draw("IMG.QOI", POS_X, POS_Y), FR_OK);
+    CHECK_EQ(host_lcd.pixels, W * H);
+    CHECK_EQ(host_lcd.outside, 0);
+    CHECK_EQ(host_lcd_reg(ENTRY_MODE), entry);
+    CHECK_EQ(host_lcd_pixel(POS_X - 1, POS_Y), COLOR_BLACK);
+    CHECK_EQ(host_lcd_pixel(POS_X + W, POS_Y + H - 1), COLOR_BLACK);
+    CHECK_EQ(host_lcd_expect(&ref[0][0], POS_X, POS_Y, W, H, "qoi"), 0);
+    CHECK_EQ(host_lcd_golden("qoi", POS_X, POS_Y, W, H), 0);
+
+    // Оборванный файл: только целые строки до обрыва
+    host_lcd_clear_stats();
+    CHECK_EQ(qoi_draw("CUT.QOI", POS_X, POS_Y), FR_INT_ERR);
+    CHECK(host_lcd.pixels < W * H);
+    CHECK_EQ(host_lcd.pixels % W, 0);
+    CHECK_EQ(host_lcd_reg(ENTRY_MODE), entry);
+
+    // Не влезает в экран и не QOI: на экран ничего
+    encode(W, H);
+    qoi[4 + 3] = LCD_WIDTH - 10;    // ширина больше места справа от x = 20
+    CHECK_EQ(host_fs_write("WIDE.QOI", qoi, len), FR_OK);
+    qoi[0] = 'Q';
+    CHECK_EQ(host_fs_write("BAD.QOI", qoi, len), FR_OK);
+    host_lcd_clear_stats();
+    CHECK_EQ(qoi_draw("WIDE.QOI", POS_X, POS_Y), FR_INVALID_PARAMETER);
+    CHECK_EQ(qoi_draw("BAD.QOI", POS_X, POS_Y), FR_INVALID_OBJECT);
+    CHECK_EQ(host_lcd.pixels, 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
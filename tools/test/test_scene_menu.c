@@ -0,0 +1,89 @@
+/**
+ * @file test_scene_menu.c
+ * @brief Меню на сцене: на дисплей уходят только изменившиеся области
+ *
+ * Переходы как в обработчиках кнопок (EXTI.c): вниз, вход в подменю 1,
+ * назад. Счётчик scene_get_pixels_sent() сверяется с пикселями, которые
+ * на самом деле получила модель дисплея, а итоговый экран — с полной
+ * перерисовкой всех виджетов.
+ */
+
+#include "host.h"
+#include "menu.h"
+#include "scene.h"
+#include <string.h>
+
+static uint16_t screen[LCD_HEIGHT][LCD_WIDTH];
+
+/**
+ * @brief Один шаг меню: пиксели по счётчику сцены и по модели совпадают
+ * @return пикселей отправлено за шаг
+ */
+static uint32_t step(const char *name, void (*draw)(void)) {
+    uint32_t before = scene_get_pixels_sent();
+    host_lcd_clear_stats();
+    draw();
+    ILI9225_DMA_wait();
+    uint32_t sent = scene_get_pixels_sent() - before;
+    printf("%-8s %6u px, %6u bytes\n", name, (unsigned)sent, (unsigned)sent * 2);
+    CHECK_EQ(sent, host_lcd.pixels);
+    CHECK_EQ(host_lcd.outside, 0);
+    return sent;
+}
+
+static void go_down(void) {
+    prev_selected = selected_item;
+    selected_item++;
+    menu_update_selection();
+}
+
+static void go_enter(void) {
+    current_menu = MENU_SUB1;
+    selected_item = 0;
+    prev_selected = 0;
+    menu_redraw_full();
+}
+
+static void go_back(void) {
+    current_menu = menus[current_menu].parent;
+    selected_item = 0;
+    prev_selected = 0;
+    menu_redraw_full();
+}
+
+static void test(void) {
+    const uint32_t widget = MENU_WIDTH * MENU_ITEM_HEIGHT_16;
+
+    ILI9225_init();
+    current_menu = MENU_MAIN;
+    selected_item = 0;
+    prev_selected = 0;
+
+    // Первая отрисовка: все девять виджетов целиком
+    uint32_t full = step("first", menu_redraw_full);
+    CHECK_EQ(full, 9 * widget);
+
+    // Смена выделения: два соседних пункта одним окном
+    uint32_t down = step("down", go_down);
+    CHECK_EQ(down, 2 * widget);
+
+    // Вход и выход: заголовок и пункты, подсказки не трогаются
+    uint32_t enter = step("enter", go_enter);
+    uint32_t back = step("back", go_back);
+    CHECK(enter < full / 2);
+    CHECK(back < full / 2);
+    CHECK(enter + back + down < full);
+
+    // Итог совпадает с полной перерисовкой на чистом экране
+    for (uint16_t y = 0; y < LCD_HEIGHT; y++) {
+        for (uint16_t x = 0; x < LCD_WIDTH; x++) screen[y][x] = host_lcd_pixel(x, y);
+    }
+    host_lcd_fill(COLOR_BLACK);
+    for (int8_t id = 0; id < SCENE_MAX_WIDGETS; id++) scene_invalidate(id);
+    CHECK_EQ(step("redraw", scene_flush), full);
+    CHECK_EQ(host_lcd_expect(&screen[0][0], 0, 0, LCD_WIDTH, LCD_HEIGHT, "scene_menu"), 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
@@ -0,0 +1,100 @@
+/**
+ * @file test_sd_dma.c
+ * @brief Фаза данных SD через DMA1 каналы 2/3: Start/Finish и callback
+ *
+ * Start возвращается, пока блок ещё идёт по шине; окончание видно по
+ * SD_DMA_busy() и по callback из прерывания канала 2. Finish дочитывает
+ * CRC или ответ карты и отпускает CS. Байты фазы данных должны идти
+ * только через DMA: модель ругается на байт от CPU во время передачи.
+ */
+
+#include "host.h"
+#include "SD_card.h"
+#include <string.h>
+
+#define SECTOR  40
+#define COUNT   4
+
+static uint8_t buf[COUNT * 512];
+static volatile uint32_t callbacks;
+static volatile uint8_t busy_in_callback;
+
+static void on_done(void) {
+    callbacks++;
+    busy_in_callback = SD_DMA_busy();
+}
+
+static void fill_card(void) {
+    for (uint32_t s = SECTOR; s < SECTOR + COUNT; s++) {
+        uint8_t *p = host_sd_sector(s);
+        for (uint32_t i = 0; i < 512; i++) p[i] = (uint8_t)(s * 11 + i * 5);
+    }
+}
+
+static void test(void) {
+    host_sd_insert(HOST_SD_V2HC, 8192);
+    CHECK_EQ(sd_init(), SD_OK);
+    fill_card();
+    SD_DMA_setCallback(on_done);
+    // Канал стартует не сразу: успеваем увидеть, что Start не ждёт
+    host_dma_latency(4);
+
+    // Чтение: Start отдаёт блок DMA, CS держится до Finish
+    host_bus_clear();
+    memset(buf, 0, sizeof(buf));
+    CHECK_EQ(SD_ReadBlockStart(SECTOR, buf), SD_OK);
+    CHECK(SD_DMA_busy());
+    CHECK_EQ(callbacks, 0);
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 1);
+
+    uint32_t overlap = 0;
+    while (SD_DMA_busy()) overlap++;
+    CHECK(overlap > 0);
+    CHECK_EQ(callbacks, 1);
+    CHECK_EQ(busy_in_callback, 0);
+    CHECK_EQ(host_bus.spi1_dma_bytes, 512);
+    CHECK_EQ(memcmp(buf, host_sd_sector(SECTOR), 512), 0);
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 1);
+
+    CHECK_EQ(SD_ReadBlockFinish(), SD_OK);
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 0);
+    // Второй Finish без Start — ошибка, а не чтение с шины
+    CHECK_EQ(SD_ReadBlockFinish(), SD_ERROR);
+
+    // Запись: буфер уходит через канал 3, ответ карты дочитывает Finish
+    for (uint32_t i = 0; i < 512; i++) buf[i] = (uint8_t)(i ^ 0x3C);
+    host_bus_clear();
+    host_sd_clear_stats();
+    callbacks = 0;
+    CHECK_EQ(SD_WriteBlockStart(SECTOR + 1, buf), SD_OK);
+    CHECK(SD_DMA_busy());
+    SD_DMA_wait();
+    CHECK_EQ(callbacks, 1);
+    CHECK_EQ(host_bus.spi1_dma_bytes, 512);
+    CHECK_EQ(SD_WriteBlockFinish(), SD_OK);
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 0);
+    CHECK_EQ(host_sd.blocks_written, 1);
+    CHECK_EQ(memcmp(host_sd_sector(SECTOR + 1), buf, 512), 0);
+    // Finish от другой операции не подходит
+    CHECK_EQ(SD_ReadBlockFinish(), SD_ERROR);
+
+    // Многоблочное чтение: по прерыванию на каждый блок
+    fill_card();
+    host_bus_clear();
+    callbacks = 0;
+    memset(buf, 0, sizeof(buf));
+    CHECK_EQ(SD_ReadBlocks(SECTOR, buf, COUNT), SD_OK);
+    CHECK_EQ(callbacks, COUNT);
+    CHECK_EQ(host_bus.spi1_dma_bytes, COUNT * 512);
+    for (uint32_t i = 0; i < COUNT; i++) {
+        CHECK_EQ(memcmp(buf + i * 512, host_sd_sector(SECTOR + i), 512), 0);
+    }
+    CHECK_EQ(SD_DMA_busy(), 0);
+
+    SD_DMA_setCallback(0);
+    CHECK_EQ(host_errors, 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
@@ -0,0 +1,83 @@
+/**
+ * @file test_sd_fallback.c
+ * @brief Повтор на низкой скорости SPI1 после сбоя обмена с картой
+ *
+ * Сбой на высокой скорости повторяется один раз на низкой, после повтора
+ * SPI1 возвращается на высокую — удачен он или нет. Проверяются прямые,
+ * асинхронные и очередные чтения нечитаемого сектора и зависшая запись.
+ */
+
+#include "host.h"
+#include "SD_card.h"
+#include <string.h>
+
+#define BAD     300
+
+static uint8_t buf[2 * 512];
+
+/**
+ * @brief После операции: было две попытки CMD17, SPI1 снова на высокой
+ */
+static void check_retried(const char *what) {
+    printf("%s: CMD17 x%u, CR1 rewrites %u\n", what, (unsigned)host_sd.cmd[SD_CMD17_READ_SINGLE_BLOCK],
+           (unsigned)host_bus.profile_writes[0]);
+    CHECK_EQ(host_sd.cmd[SD_CMD17_READ_SINGLE_BLOCK], 2);
+    CHECK_EQ(host_bus.profile_writes[0], 2);
+    CHECK(sd_spi_is_high_speed());
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 0);
+}
+
+static void clear(void) {
+    host_sd_clear_stats();
+    host_bus_clear();
+}
+
+static void test(void) {
+    host_sd_insert(HOST_SD_V2HC, 8192);
+    for (uint32_t i = 0; i < 512; i++) host_sd_sector(BAD + 1)[i] = (uint8_t)(i * 11);
+    CHECK_EQ(sd_init(), SD_OK);
+    CHECK(sd_spi_is_high_speed());
+    host_sd_bad_sector(BAD);
+
+    // Прямое чтение: ошибка после повтора, скорость вернулась
+    clear();
+    CHECK_EQ(SD_ReadBlock(BAD, buf), SD_ERROR);
+    check_retried("SD_ReadBlock");
+
+    // Следующий сектор читается сразу на высокой, без повторов
+    clear();
+    CHECK_EQ(SD_ReadBlock(BAD + 1, buf), SD_OK);
+    CHECK_EQ(memcmp(buf, host_sd_sector(BAD + 1), 512), 0);
+    CHECK_EQ(host_sd.cmd[SD_CMD17_READ_SINGLE_BLOCK], 1);
+    CHECK_EQ(host_bus.profile_writes[0], 0);
+
+    // Асинхронное чтение: неудачный повтор возвращает скорость в Start
+    clear();
+    CHECK_EQ(SD_ReadBlockStart(BAD, buf), SD_ERROR);
+    check_retried("SD_ReadBlockStart");
+    CHECK_EQ(SD_ReadBlockFinish(), SD_ERROR);
+
+    // Очередь: запрос повторяется на низкой и уходит с ошибкой
+    clear();
+    SD_Request req = { .type = SD_REQ_READ, .sector = BAD, .buffer = buf };
+    CHECK_EQ(SD_QueueSubmit(&req), SD_OK);
+    while (SD_QueuePoll()) {}
+    CHECK(req.done);
+    CHECK_EQ(req.status, SD_ERROR);
+    check_retried("queue");
+
+    // Карта зависла после блока: тайм-аут, повтор не проходит уже CMD24.
+    // Выйти из занятости такая карта уже не может, поэтому это последний шаг
+    host_sd_busy(-1);
+    clear();
+    memset(buf, 0x5A, 512);
+    CHECK(SD_WriteBlock(BAD + 2, buf) != SD_OK);
+    CHECK_EQ(host_sd.cmd[SD_CMD24_WRITE_SINGLE_BLOCK], 1);
+    CHECK_EQ(host_bus.profile_writes[0], 2);
+    CHECK(sd_spi_is_high_speed());
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
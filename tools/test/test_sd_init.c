@@ -0,0 +1,96 @@
+/**
+ * @file test_sd_init.c
+ * @brief sd_init() для SD 1.x, SDSC и SDHC: тип, ёмкость, адресация
+ *
+ * Для каждого поколения: опознание по CMD8/ACMD41/OCR, ёмкость из CSD,
+ * CMD16 только для байтовой адресации, запись и чтение по краям карты
+ * и файл через FatFS. Отказы: карта не выходит из IDLE и карты нет —
+ * ошибка, CS отпущен, SPI1 на низкой скорости.
+ */
+
+#include "host.h"
+#include "SD_card.h"
+#include "file_work.h"
+#include <string.h>
+
+static uint8_t buf[2 * 512];
+static uint8_t data[3000];
+
+static void pattern(uint8_t *p, uint32_t len, uint32_t seed) {
+    for (uint32_t i = 0; i < len; i++) p[i] = (uint8_t)(seed + i * 5 + (i >> 9));
+}
+
+static void card(const char *name, uint8_t gen, uint32_t sectors, uint8_t type) {
+    printf("%s: ", name);
+    host_sd_insert(gen, sectors);
+    host_sd_ready_after(3);
+    CHECK_EQ(sd_init(), SD_OK);
+
+    const SD_CardInfo *info = sd_card_info();
+    printf("type 0x%02X, %u sectors, erase block %u, ACMD41 x%u\n", info->type,
+           (unsigned)info->sectors, (unsigned)info->erase_block, (unsigned)host_sd.acmd[SD_CMD41_SD_SEND_OP_COND]);
+    CHECK_EQ(info->type, type);
+    CHECK_EQ(info->sectors, sectors);
+    CHECK(info->erase_block > 0 && (info->erase_block & (info->erase_block - 1)) == 0);
+    CHECK_EQ(host_sd.cmd[SD_CMD16_SET_BLOCKLEN], (type & SD_TYPE_BLOCK) ? 0 : 1);
+    CHECK(host_sd.acmd[SD_CMD41_SD_SEND_OP_COND] >= 3);
+    CHECK(sd_spi_is_high_speed());
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 0);
+
+    // Адресация: сектор 3 и два последних — ровно там, где ждём
+    pattern(buf, 512, 3);
+    CHECK_EQ(SD_WriteBlock(3, buf), SD_OK);
+    CHECK_EQ(memcmp(host_sd_sector(3), buf, 512), 0);
+    pattern(buf, sizeof(buf), sectors);
+    CHECK_EQ(SD_WriteBlocks(sectors - 2, buf, 2), SD_OK);
+    CHECK_EQ(memcmp(host_sd_sector(sectors - 1), buf + 512, 512), 0);
+    memset(buf, 0, sizeof(buf));
+    CHECK_EQ(SD_ReadBlocks(sectors - 2, buf, 2), SD_OK);
+    CHECK_EQ(memcmp(host_sd_sector(sectors - 2), buf, 512), 0);
+    CHECK_EQ(SD_ReadBlock(3, buf), SD_OK);
+    CHECK_EQ(memcmp(host_sd_sector(3), buf, 512), 0);
+
+    // Файловая система поверх
+    CHECK_EQ(host_fs_format(gen, sectors), FR_OK);
+    pattern(data, sizeof(data), gen);
+    CHECK_EQ(host_fs_write("CARD.BIN", data, sizeof(data)), FR_OK);
+    FIL f;
+    UINT got;
+    static uint8_t back[sizeof(data)];
+    CHECK_EQ(f_open(&f, "CARD.BIN", FA_READ), FR_OK);
+    CHECK_EQ(f_read(&f, back, sizeof(back), &got), FR_OK);
+    CHECK_EQ(got, sizeof(data));
+    CHECK_EQ(f_close(&f), FR_OK);
+    CHECK_EQ(memcmp(back, data, sizeof(data)), 0);
+}
+
+static void test(void) {
+    card("SD 1.x", HOST_SD_V1,   8192,  SD_TYPE_SD1);
+    card("SDSC",   HOST_SD_V2SC, 65536, SD_TYPE_SD2);
+    card("SDHC",   HOST_SD_V2HC, 65536, SD_TYPE_SD2 | SD_TYPE_BLOCK);
+
+    // Карта не выходит из IDLE: тайм-аут по ACMD41, карта отпущена
+    host_sd_insert(HOST_SD_V2HC, 8192);
+    host_sd_ready_after(-1);
+    uint64_t t0 = host_time_us();
+    CHECK_EQ(sd_init(), SD_TIMEOUT_ERROR);
+    CHECK(host_time_us() - t0 >= SD_INIT_TIMEOUT_MS * 1000);
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 0);
+    CHECK_EQ(sd_card_info()->sectors, 0);
+    CHECK(!sd_spi_is_high_speed());
+
+    // Карты нет: CMD0 без ответа
+    host_sd_insert(HOST_SD_V2HC, 0);
+    CHECK_EQ(sd_init(), SD_ERROR);
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 0);
+    CHECK_EQ(sd_card_info()->sectors, 0);
+
+    // После отказов нормальная карта снова опознаётся
+    host_sd_insert(HOST_SD_V2HC, 8192);
+    CHECK_EQ(sd_init(), SD_OK);
+    CHECK_EQ(sd_card_info()->sectors, 8192);
+}
+
+int main(void) {
+    return host_run(test);
+}
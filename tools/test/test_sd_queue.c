@@ -0,0 +1,186 @@
+/**
+ * @file test_sd_queue.c
+ * @brief Очередь запросов SD: порядок, обратные вызовы, переполнение,
+ * открытое упреждающее чтение и зависшая запись
+ *
+ * Запросы крутятся через SD_QueuePoll() до пустой очереди; данные
+ * сверяются с картой модели. Каждый шаг короткий (R1 тоже ждётся по
+ * шагам) и идёт под BASEPRI, закрывающим EXTI с FatFS. Зависшая запись
+ * и карта без ответа — последними.
+ */
+
+#include "host.h"
+#include "SD_card.h"
+#include "diskcache.h"
+#include <string.h>
+
+static uint8_t bufs[SD_QUEUE_LEN + 1][512];
+static SD_Request reqs[SD_QUEUE_LEN + 1];
+static SD_Request *order[2 * SD_QUEUE_LEN];
+static uint8_t finished;
+static uint32_t max_step;       // больше всего байт CPU по SPI1 за шаг
+
+static void pattern(uint8_t *p, uint32_t sector, uint8_t gen) {
+    for (uint32_t i = 0; i < 512; i++) p[i] = (uint8_t)(sector * 13 + i * 7 + gen * 37);
+}
+
+static void on_done(SD_Request *req) {
+    CHECK(req->done);
+    order[finished++] = req;
+}
+
+static void submit(uint8_t i, uint8_t type, uint32_t sector) {
+    reqs[i] = (SD_Request){type, sector, bufs[i], on_done, 0, SD_OK};
+    CHECK_EQ(SD_QueueSubmit(&reqs[i]), SD_OK);
+    CHECK_EQ(reqs[i].done, 0);
+}
+
+/**
+ * @brief Опрос до пустой очереди
+ * @return сколько раз пришлось вызвать SD_QueuePoll()
+ */
+static uint32_t run(void) {
+    uint32_t polls = 0;
+    uint8_t more;
+    do {
+        uint32_t before = host_bus.spi1_masked_bytes;
+        more = SD_QueuePoll();
+        uint32_t step = host_bus.spi1_masked_bytes - before;
+        if (step > max_step) max_step = step;
+        CHECK_EQ(host_get_basepri(), 0);
+        polls++;
+    } while (more);
+    CHECK(!SD_QueueBusy());
+    return polls;
+}
+
+static void test(void) {
+    host_sd_insert(HOST_SD_V2HC, 8192);
+    for (uint32_t s = 0; s < 1024; s++) pattern(host_sd_sector(s), s, 0);
+    CHECK_EQ(sd_init(), SD_OK);
+    CHECK(!SD_QueueBusy());
+    CHECK_EQ(SD_QueuePoll(), 0);
+
+    // Вперемешку чтения и записи: завершаются в порядке постановки
+    host_dma_latency(2);
+    host_sd_busy(40);
+    host_sd_clear_stats();
+    host_bus_clear();
+    finished = 0;
+    submit(0, SD_REQ_READ, 10);
+    pattern(bufs[1], 11, 1);
+    submit(1, SD_REQ_WRITE, 11);
+    submit(2, SD_REQ_READ, 11);
+    pattern(bufs[3], 900, 1);
+    submit(3, SD_REQ_WRITE, 900);
+    CHECK(SD_QueueBusy());
+
+    // Пятый не влезает, неизвестный тип не принимается
+    reqs[4] = (SD_Request){SD_REQ_READ, 12, bufs[4], on_done, 0, SD_OK};
+    CHECK_EQ(SD_QueueSubmit(&reqs[4]), SD_ERROR);
+    CHECK_EQ(host_sd.cmd[SD_CMD17_READ_SINGLE_BLOCK], 0);
+
+    uint32_t polls = run();
+    printf("4 requests: %u polls, %u us\n", (unsigned)polls, (unsigned)host_time_us());
+    CHECK(polls > 4);
+    CHECK_EQ(finished, 4);
+    for (uint8_t i = 0; i < 4; i++) {
+        CHECK(order[i] == &reqs[i]);
+        CHECK_EQ(reqs[i].status, SD_OK);
+    }
+    CHECK_EQ(host_sd.cmd[SD_CMD17_READ_SINGLE_BLOCK], 2);
+    CHECK_EQ(host_sd.cmd[SD_CMD24_WRITE_SINGLE_BLOCK], 2);
+    CHECK_EQ(memcmp(bufs[0], host_sd_sector(10), 512), 0);
+    CHECK_EQ(memcmp(bufs[2], bufs[1], 512), 0);
+    CHECK_EQ(memcmp(host_sd_sector(11), bufs[1], 512), 0);
+    CHECK_EQ(memcmp(host_sd_sector(900), bufs[3], 512), 0);
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 0);
+    CHECK(sd_spi_is_high_speed());
+
+    // Весь обмен CPU — под BASEPRI: EXTI с FatFS не вклинится в шаг.
+    // Шаг — кадр команды либо до 16 байт опроса и пара байт CRC/ответа
+    printf("longest step: %u bytes\n", (unsigned)max_step);
+    CHECK_EQ(host_bus.spi1_masked_bytes, host_bus.spi1_bytes - host_bus.spi1_dma_bytes);
+    CHECK(max_step <= 24);
+
+    // Без обратного вызова и после освобождения места
+    reqs[4].type = 7;
+    CHECK_EQ(SD_QueueSubmit(&reqs[4]), SD_ERROR);
+    reqs[4] = (SD_Request){SD_REQ_READ, 12, bufs[4], NULL, 0, SD_OK};
+    CHECK_EQ(SD_QueueSubmit(&reqs[4]), SD_OK);
+    run();
+    CHECK(reqs[4].done);
+    CHECK_EQ(reqs[4].status, SD_OK);
+    CHECK_EQ(memcmp(bufs[4], host_sd_sector(12), 512), 0);
+    CHECK_EQ(finished, 4);
+
+    // Открытое упреждающее чтение diskcache: очередь его забирает и идёт дальше,
+    // поток после этого отдаёт верные данные
+    CHECK_EQ(disk_initialize(0), 0);
+    disk_cache_pin(0, 0);
+    uint8_t sec[512];
+    for (uint32_t s = 300; s < 302; s++) CHECK_EQ(disk_cache_read(sec, s, 1), RES_OK);
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 1);
+    finished = 0;
+    submit(0, SD_REQ_READ, 500);
+    pattern(bufs[1], 501, 2);
+    submit(1, SD_REQ_WRITE, 501);
+    run();
+    CHECK_EQ(finished, 2);
+    CHECK_EQ(reqs[0].status, SD_OK);
+    CHECK_EQ(reqs[1].status, SD_OK);
+    CHECK_EQ(memcmp(bufs[0], host_sd_sector(500), 512), 0);
+    CHECK_EQ(memcmp(host_sd_sector(501), bufs[1], 512), 0);
+    for (uint32_t s = 302; s < 310; s++) {
+        CHECK_EQ(disk_cache_read(sec, s, 1), RES_OK);
+        CHECK_EQ(memcmp(sec, host_sd_sector(s), 512), 0);
+    }
+    disk_prefetch_stop();
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 0);
+
+    // Запись в очереди, затем прямой SD_*: очередь дорабатывается первой
+    finished = 0;
+    pattern(bufs[0], 600, 3);
+    submit(0, SD_REQ_WRITE, 600);
+    CHECK_EQ(SD_ReadBlock(600, sec), SD_OK);
+    CHECK(reqs[0].done);
+    CHECK_EQ(finished, 1);
+    CHECK_EQ(memcmp(sec, bufs[0], 512), 0);
+
+    // Карта зависла в занятости: тайм-аут на высокой скорости; повтор на низкой
+    // не проходит уже CMD24 — запрос уходит с ошибкой, CS отпущен, SPI1
+    // снова на высокой
+    host_sd_busy(-1);
+    finished = 0;
+    pattern(bufs[0], 700, 4);
+    submit(0, SD_REQ_WRITE, 700);
+    uint64_t t0 = host_time_us();
+    polls = run();
+    printf("hung write: %u polls, %u ms, status %u\n", (unsigned)polls,
+           (unsigned)((host_time_us() - t0) / 1000), (unsigned)reqs[0].status);
+    CHECK_EQ(finished, 1);
+    CHECK_EQ(reqs[0].status, SD_ERROR);
+    CHECK(host_time_us() - t0 >= SD_WRITE_TIMEOUT_MS * 1000);
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 0);
+    CHECK(sd_spi_is_high_speed());
+
+    // Карта не отвечает на команду: R1 ждётся по шагам до SD_CMD_TIMEOUT_MS
+    host_sd_insert(HOST_SD_V2HC, 0);
+    finished = 0;
+    max_step = 0;
+    submit(0, SD_REQ_READ, 10);
+    t0 = host_time_us();
+    polls = run();
+    printf("no R1: %u polls, %u ms, longest step %u bytes\n", (unsigned)polls,
+           (unsigned)((host_time_us() - t0) / 1000), (unsigned)max_step);
+    CHECK_EQ(finished, 1);
+    CHECK_EQ(reqs[0].status, SD_TIMEOUT_ERROR);
+    CHECK(host_time_us() - t0 >= SD_CMD_TIMEOUT_MS * 1000);
+    CHECK(polls > 10);
+    CHECK(max_step <= 24);
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
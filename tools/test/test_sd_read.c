@@ -0,0 +1,83 @@
+/**
+ * @file test_sd_read.c
+ * @brief Чтение подряд идущих секторов: CMD18, блоки через DMA, CMD12
+ *
+ * Данные сверяются с содержимым модели карты, счётчики команд — с тем,
+ * что ушло по шине. Для сравнения те же сектора читаются по одному (CMD17).
+ */
+
+#include "host.h"
+#include "SD_card.h"
+#include <string.h>
+
+#define FIRST   100
+#define COUNT   8
+
+static uint8_t buf[COUNT * 512];
+
+static void fill_card(void) {
+    for (uint32_t s = 0; s < FIRST + 2 * COUNT; s++) {
+        uint8_t *p = host_sd_sector(s);
+        for (uint32_t i = 0; i < 512; i++) p[i] = (uint8_t)(s * 7 + i * 13 + (i >> 8));
+    }
+}
+
+static void test(void) {
+    host_sd_insert(HOST_SD_V2HC, 8192);
+    CHECK_EQ(sd_init(), SD_OK);
+    fill_card();
+
+    // Восемь секторов одной командой
+    host_sd_clear_stats();
+    host_bus_clear();
+    uint64_t t0 = host_time_us();
+    CHECK_EQ(SD_ReadBlocks(FIRST, buf, COUNT), SD_OK);
+    uint64_t t_multi = host_time_us() - t0;
+    CHECK_EQ(host_sd.cmd[SD_CMD18_READ_MULTIPLE_BLOCK], 1);
+    CHECK_EQ(host_sd.cmd[SD_CMD12_STOP_TRANSMISSION], 1);
+    CHECK_EQ(host_sd.cmd[SD_CMD17_READ_SINGLE_BLOCK], 0);
+    CHECK_EQ(host_sd.blocks_read, COUNT);
+    CHECK(host_bus.spi1_dma_bytes >= COUNT * 512);
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 0);
+    for (uint32_t i = 0; i < COUNT; i++) {
+        CHECK_EQ(memcmp(buf + i * 512, host_sd_sector(FIRST + i), 512), 0);
+    }
+
+    // Один сектор — CMD17, без CMD12
+    host_sd_clear_stats();
+    memset(buf, 0, sizeof(buf));
+    CHECK_EQ(SD_ReadBlocks(FIRST + COUNT, buf, 1), SD_OK);
+    CHECK_EQ(host_sd.cmd[SD_CMD17_READ_SINGLE_BLOCK], 1);
+    CHECK_EQ(host_sd.cmd[SD_CMD18_READ_MULTIPLE_BLOCK], 0);
+    CHECK_EQ(host_sd.cmd[SD_CMD12_STOP_TRANSMISSION], 0);
+    CHECK_EQ(memcmp(buf, host_sd_sector(FIRST + COUNT), 512), 0);
+
+    // Ноль секторов — ни одной команды
+    host_sd_clear_stats();
+    CHECK_EQ(SD_ReadBlocks(FIRST, buf, 0), SD_OK);
+    CHECK_EQ(host_sd.cmd[SD_CMD18_READ_MULTIPLE_BLOCK] + host_sd.cmd[SD_CMD17_READ_SINGLE_BLOCK], 0);
+
+    // Те же восемь по одному: команда и ожидание токена на каждый
+    host_sd_clear_stats();
+    memset(buf, 0, sizeof(buf));
+    t0 = host_time_us();
+    for (uint32_t i = 0; i < COUNT; i++) {
+        CHECK_EQ(SD_ReadBlock(FIRST + i, buf + i * 512), SD_OK);
+    }
+    uint64_t t_single = host_time_us() - t0;
+    CHECK_EQ(host_sd.cmd[SD_CMD17_READ_SINGLE_BLOCK], COUNT);
+    CHECK_EQ(memcmp(buf, host_sd_sector(FIRST), 512), 0);
+    CHECK_EQ(memcmp(buf + (COUNT - 1) * 512, host_sd_sector(FIRST + COUNT - 1), 512), 0);
+
+    printf("%u sectors: CMD18 %u us, CMD17 x%u %u us\n", COUNT,
+           (unsigned)t_multi, COUNT, (unsigned)t_single);
+    CHECK(t_multi < t_single);
+
+    // Следующая команда после CMD12 проходит: карта вышла из потока
+    CHECK_EQ(SD_ReadBlocks(FIRST + 1, buf, 2), SD_OK);
+    CHECK_EQ(memcmp(buf + 512, host_sd_sector(FIRST + 2), 512), 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
@@ -0,0 +1,88 @@
+/**
+ * @file test_sd_write.c
+ * @brief Запись подряд идущих секторов: ACMD23, CMD25, Stop Tran
+ *
+ * Карта после каждого блока держит линию занятой; данные сверяются с
+ * содержимым модели карты, соседние сектора не должны меняться.
+ */
+
+#include "host.h"
+#include "SD_card.h"
+#include <string.h>
+
+#define FIRST   200
+#define COUNT   6
+
+static uint8_t buf[COUNT * 512];
+
+static void fill_buf(uint8_t seed) {
+    for (uint32_t i = 0; i < sizeof(buf); i++) buf[i] = (uint8_t)(seed + i * 3 + (i >> 9));
+}
+
+static void test(void) {
+    host_sd_insert(HOST_SD_V2HC, 8192);
+    CHECK_EQ(sd_init(), SD_OK);
+    memset(host_sd_sector(FIRST - 1), 0xA5, 512);
+    memset(host_sd_sector(FIRST + COUNT), 0x5A, 512);
+
+    // Шесть секторов одной командой, после каждого блока занятость
+    host_sd_busy(40);
+    fill_buf(1);
+    host_sd_clear_stats();
+    host_bus_clear();
+    uint64_t t0 = host_time_us();
+    CHECK_EQ(SD_WriteBlocks(FIRST, buf, COUNT), SD_OK);
+    uint64_t t_multi = host_time_us() - t0;
+    CHECK_EQ(host_sd.cmd[SD_CMD55_APP_CMD], 1);
+    CHECK_EQ(host_sd.acmd[SD_ACMD23_SET_WR_BLK_ERASE_COUNT], 1);
+    CHECK_EQ(host_sd.acmd23_arg, COUNT);
+    CHECK_EQ(host_sd.cmd[SD_CMD25_WRITE_MULTIPLE_BLOCK], 1);
+    CHECK_EQ(host_sd.cmd[SD_CMD24_WRITE_SINGLE_BLOCK], 0);
+    CHECK_EQ(host_sd.blocks_written, COUNT);
+    CHECK(host_bus.spi1_dma_bytes >= COUNT * 512);
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 0);
+    for (uint32_t i = 0; i < COUNT; i++) {
+        CHECK_EQ(memcmp(host_sd_sector(FIRST + i), buf + i * 512, 512), 0);
+    }
+    CHECK_EQ(host_sd_sector(FIRST - 1)[511], 0xA5);
+    CHECK_EQ(host_sd_sector(FIRST + COUNT)[0], 0x5A);
+
+    // Один сектор — CMD24 без ACMD23
+    fill_buf(77);
+    host_sd_clear_stats();
+    CHECK_EQ(SD_WriteBlocks(FIRST, buf, 1), SD_OK);
+    CHECK_EQ(host_sd.cmd[SD_CMD24_WRITE_SINGLE_BLOCK], 1);
+    CHECK_EQ(host_sd.cmd[SD_CMD25_WRITE_MULTIPLE_BLOCK], 0);
+    CHECK_EQ(host_sd.acmd[SD_ACMD23_SET_WR_BLK_ERASE_COUNT], 0);
+    CHECK_EQ(memcmp(host_sd_sector(FIRST), buf, 512), 0);
+
+    // Те же шесть по одному
+    fill_buf(9);
+    host_sd_clear_stats();
+    t0 = host_time_us();
+    for (uint32_t i = 0; i < COUNT; i++) {
+        CHECK_EQ(SD_WriteBlock(FIRST + i, buf + i * 512), SD_OK);
+    }
+    uint64_t t_single = host_time_us() - t0;
+    CHECK_EQ(host_sd.cmd[SD_CMD24_WRITE_SINGLE_BLOCK], COUNT);
+    CHECK_EQ(memcmp(host_sd_sector(FIRST + COUNT - 1), buf + (COUNT - 1) * 512, 512), 0);
+    // Внутреннего времени программирования у модели нет: выигрыш ACMD23
+    // тут не виден, время только для сравнения на плате
+    printf("%u sectors: CMD25 %u us, CMD24 x%u %u us\n", COUNT,
+           (unsigned)t_multi, COUNT, (unsigned)t_single);
+
+    // Карта висит после блока: тайм-аут и CS отпущен. Выйти из CMD25
+    // такая карта уже не может, поэтому это последний шаг
+    host_sd_busy(-1);
+    fill_buf(5);
+    host_sd_clear_stats();
+    t0 = host_time_us();
+    CHECK(SD_WriteBlocks(FIRST, buf, COUNT) != SD_OK);
+    CHECK(host_time_us() - t0 >= SD_WRITE_TIMEOUT_MS * 1000);
+    CHECK_EQ(host_line[HOST_LINE_SD_CS], 0);
+    CHECK_EQ(host_sd.blocks_written, 1);
+}
+
+int main(void) {
+    return host_run(test);
+}
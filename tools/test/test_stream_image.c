@@ -0,0 +1,98 @@
+/**
+ * @file test_stream_image.c
+ * @brief Конвейер SD -> LCD: BMP во весь экран из файла на модельной карте
+ *
+ * Картинка записывается на отформатированную карту через FatFS прошивки,
+ * file_stream_image() читает сектора напрямую с карты. GRAM сверяется с
+ * исходными пикселями, для строк снизу вверх и сверху вниз.
+ */
+
+#include "host.h"
+#include "file_work.h"
+#include <string.h>
+
+#define W       LCD_WIDTH
+#define H       LCD_HEIGHT
+#define HDR     54
+
+static uint8_t file[HDR + W * H * 3];
+static uint16_t ref[H][W];
+
+static void put16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static void put32(uint8_t *p, uint32_t v) { put16(p, v); put16(p + 2, v >> 16); }
+
+/**
+ * @brief BMP во весь экран с глубиной bpp (пиксели всегда по 3 байта) и эталон
+ */
+static uint32_t make_bmp(uint16_t bpp, uint8_t top_down) {
+    uint32_t size = HDR + W * H * 3;
+    memset(file, 0, HDR);
+    file[0] = 'B';
+    file[1] = 'M';
+    put32(file + 2, size);
+    put32(file + 10, HDR);
+    put32(file + 14, 40);
+    put32(file + 18, W);
+    put32(file + 22, top_down ? (uint32_t)-H : H);
+    put16(file + 26, 1);
+    put16(file + 28, bpp);
+
+    for (uint16_t y = 0; y < H; y++) {
+        uint8_t *row = file + HDR + (uint32_t)(top_down ? y : H - 1 - y) * W * 3;
+        for (uint16_t x = 0; x < W; x++) {
+            uint8_t r = x * 255 / (W - 1), g = y, b = (uint8_t)((x ^ y) * 4);
+            row[x * 3 + 0] = b;
+            row[x * 3 + 1] = g;
+            row[x * 3 + 2] = r;
+            ref[y][x] = host_rgb565(r, g, b);
+        }
+    }
+    return size;
+}
+
+static void test(void) {
+    ILI9225_init();
+    uint16_t entry = host_lcd_reg(ENTRY_MODE);
+    CHECK_EQ(host_fs_format(HOST_SD_V2HC, 65536), FR_OK);
+
+    CHECK_EQ(host_fs_write("UP.BMP", file, make_bmp(24, 0)), FR_OK);
+    CHECK_EQ(host_fs_write("DOWN.BMP", file, make_bmp(24, 1)), FR_OK);
+    CHECK_EQ(host_fs_write("BPP16.BMP", file, make_bmp(16, 1)), FR_OK);
+
+    // Строки снизу вверх: каждый пиксель ровно один раз
+    make_bmp(24, 0);
+    host_lcd_fill(COLOR_BLACK);
+    host_lcd_clear_stats();
+    host_sd_clear_stats();
+    uint64_t t0 = host_time_us();
+    CHECK_EQ(file_stream_image("UP.BMP"), FR_OK);
+    uint64_t t = host_time_us() - t0;
+    CHECK_EQ(host_lcd.pixels, W * H);
+    CHECK_EQ(host_lcd.outside, 0);
+    // Каждый сектор файла с карты один раз; сверху — каталог, заголовок
+    // и FAT для таблицы кластеров через FatFS
+    CHECK(host_sd.blocks_read >= (HDR + W * H * 3 + 511) / 512);
+    CHECK(host_sd.blocks_read <= (HDR + W * H * 3 + 511) / 512 + 3);
+    CHECK_EQ(host_lcd_expect(&ref[0][0], 0, 0, W, H, "stream_up"), 0);
+    CHECK_EQ(host_lcd_reg(ENTRY_MODE), entry);
+    printf("176x220 BMP streamed in %u us (%u sectors)\n", (unsigned)t, (unsigned)host_sd.blocks_read);
+
+    // Строки сверху вниз
+    make_bmp(24, 1);
+    host_lcd_fill(COLOR_BLACK);
+    host_lcd_clear_stats();
+    CHECK_EQ(file_stream_image("DOWN.BMP"), FR_OK);
+    CHECK_EQ(host_lcd.pixels, W * H);
+    CHECK_EQ(host_lcd_expect(&ref[0][0], 0, 0, W, H, "stream_down"), 0);
+    CHECK_EQ(host_lcd_reg(ENTRY_MODE), entry);
+
+    // Не 24 бита и нет файла: на экран ничего
+    host_lcd_clear_stats();
+    CHECK_EQ(file_stream_image("BPP16.BMP"), FR_INVALID_OBJECT);
+    CHECK(file_stream_image("NONE.BMP") != FR_OK);
+    CHECK_EQ(host_lcd.pixels, 0);
+}
+
+int main(void) {
+    return host_run(test);
+}
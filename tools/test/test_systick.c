@@ -0,0 +1,59 @@
+/**
+ * @file test_systick.c
+ * @brief SysTick из src/TIMER.c: тик 1 мс, get_us() и сроки по get_ms()
+ *
+ * Тест собирается с настоящим src/TIMER.c вместо таймера модели платы;
+ * SysTick считает такты, которые даёт host_systick_run().
+ */
+
+#include "host.h"
+#include "TIMER.h"
+#include "SD_card.h"
+
+#define HCLK_MHZ    72
+
+/**
+ * @brief Цикл ожидания, как в SD_card.c: сколько тактов до истечения срока
+ */
+static uint64_t deadline_cycles(uint32_t timeout_ms) {
+    uint64_t cycles = 0;
+    uint32_t start = get_ms();
+    while (get_ms() - start <= timeout_ms) {
+        host_systick_run(100);
+        cycles += 100;
+    }
+    return cycles;
+}
+
+static void test(void) {
+    SysTick_init();
+
+    // Тик — ровно 1 мс тактов ядра
+    uint32_t ms0 = get_ms();
+    host_systick_run(HCLK_MHZ * 1000 - 1);
+    CHECK_EQ(get_ms() - ms0, 0);
+    host_systick_run(1);
+    CHECK_EQ(get_ms() - ms0, 1);
+    host_systick_run(HCLK_MHZ * 1000 * 10);
+    CHECK_EQ(get_ms() - ms0, 11);
+
+    // Срок SD_WRITE_TIMEOUT_MS истекает через столько же миллисекунд
+    // тактов (плюс неполный тик в начале), а не в 8 раз раньше
+    uint64_t us = deadline_cycles(SD_WRITE_TIMEOUT_MS) / HCLK_MHZ;
+    printf("SD_WRITE_TIMEOUT_MS %u: expired after %u us of cycles\n", SD_WRITE_TIMEOUT_MS, (unsigned)us);
+    CHECK(us >= SD_WRITE_TIMEOUT_MS * 1000u);
+    CHECK(us <= (SD_WRITE_TIMEOUT_MS + 1) * 1000u + 2);
+
+    // get_us() идёт вместе с тактами, в том числе через перезагрузку
+    // счётчика: шаг 7 мкс не кратен периоду тика
+    uint32_t us0 = get_us();
+    for (uint32_t i = 1; i <= 3000; i++) {
+        host_systick_run(7 * HCLK_MHZ);
+        if (!CHECK_EQ(get_us() - us0, 7 * i)) break;
+    }
+    printf("21 ms of cycles: get_us() +%u\n", (unsigned)(get_us() - us0));
+}
+
+int main(void) {
+    return host_run(test);
+}